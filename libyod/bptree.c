@@ -0,0 +1,1271 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "stdlog.h"
+#include "bptree.h"
+
+
+#ifndef _YOD_BPTREE_DEBUG
+#define _YOD_BPTREE_DEBUG 										0
+#endif
+
+#ifndef _YOD_BPTREE_SIMD
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+#define _YOD_BPTREE_SIMD 										1
+#else
+#define _YOD_BPTREE_SIMD 										0
+#endif
+#endif
+
+#if (_YOD_BPTREE_SIMD)
+#include <immintrin.h>
+#endif
+
+#define YOD_BPTREE_ORDER 										15
+#define YOD_BPTREE_MIN 											(YOD_BPTREE_ORDER >> 1)
+#define YOD_BPTREE_DEPTH 										32
+#define YOD_BPTREE_LINE 										64
+
+
+/* yod_bptree_v, line aligned, the count and keys fill the first two lines */
+typedef struct _yod_bptree_v
+{
+	ulong count;
+	uint64_t keys[YOD_BPTREE_ORDER];
+
+	/* values in leaves, children in inner nodes */
+	void *slot[YOD_BPTREE_ORDER + 1];
+
+	/* leaves only */
+	struct _yod_bptree_v *next;
+	struct _yod_bptree_v *prev;
+
+	/* as returned by malloc */
+	void *base;
+} yod_bptree_v;
+
+
+/* yod_bptree_s, one step of a path from the root */
+typedef struct _yod_bptree_s
+{
+	yod_bptree_v *node;
+	ulong pos;
+} yod_bptree_s;
+
+
+/* yod_bptree_t */
+struct _yod_bptree_t
+{
+	pthread_mutex_t lock;
+
+	ulong count;
+	ulong stamp;
+	ulong height;
+
+	yod_bptree_v *root;
+	yod_bptree_v *head;
+	yod_bptree_v *tail;
+	yod_bptree_i curr;
+
+	void (*vfree) (void * __ENV_CPARM);
+};
+
+
+static void _yod_bptree_rank_init(void);
+static ulong _yod_bptree_rank(const uint64_t *keys, ulong count, uint64_t key, int upper);
+#if (_YOD_BPTREE_SIMD)
+static ulong _yod_bptree_rank_sse42(const uint64_t *keys, ulong count, uint64_t key, int upper);
+static ulong _yod_bptree_rank_avx2(const uint64_t *keys, ulong count, uint64_t key, int upper);
+#endif
+static yod_bptree_v *_yod_bptree_node(__ENV_PARM);
+static void _yod_bptree_release(yod_bptree_v *node __ENV_CPARM);
+static void _yod_bptree_destroy(yod_bptree_t *self, yod_bptree_v *node, ulong level __ENV_CPARM);
+static void _yod_bptree_locate(yod_bptree_t *self, uint64_t key, int upper, yod_bptree_s *path);
+static int _yod_bptree_step(yod_bptree_t *self, yod_bptree_s *path);
+static yod_bptree_v *_yod_bptree_search(yod_bptree_t *self, uint64_t key, int mode, ulong *pos);
+static int _yod_bptree_insert(yod_bptree_t *self, yod_bptree_s *path, uint64_t key, void *value __ENV_CPARM);
+static void _yod_bptree_remove(yod_bptree_t *self, yod_bptree_s *path __ENV_CPARM);
+static void *_yod_bptree_iter(yod_bptree_i *iter, int forward, uint64_t *key);
+
+
+/* key search picked for this cpu by _yod_bptree_rank_init */
+static ulong (*yod_bptree_rank__) (const uint64_t *keys, ulong count, uint64_t key, int upper) = NULL;
+
+
+/** {{{ yod_bptree_t *_yod_bptree_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM)
+*/
+yod_bptree_t *_yod_bptree_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM)
+{
+	yod_bptree_t *self = NULL;
+
+	self = (yod_bptree_t *) malloc(sizeof(yod_bptree_t));
+	if (!self) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
+	}
+
+	if (pthread_mutex_init(&self->lock, NULL) != 0) {
+		free(self);
+
+		YOD_STDLOG_ERROR("pthread_mutex_init failed");
+		return NULL;
+	}
+
+	self->count = 0;
+	self->stamp = 0;
+	self->height = 0;
+
+	self->root = NULL;
+	self->head = NULL;
+	self->tail = NULL;
+	self->curr.tree = self;
+	self->curr.node = NULL;
+
+	self->vfree = vfree;
+
+	if (!yod_bptree_rank__) {
+		_yod_bptree_rank_init();
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_BPTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p): %p in %s:%d %s",
+		__FUNCTION__, vfree, self, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return self;
+}
+/* }}} */
+
+
+/** {{{ void _yod_bptree_free(yod_bptree_t *self __ENV_CPARM)
+*/
+void _yod_bptree_free(yod_bptree_t *self __ENV_CPARM)
+{
+	if (!self) {
+		return;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_BPTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p) in %s:%d %s",
+		__FUNCTION__, self, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	pthread_mutex_lock(&self->lock);
+	if (self->root) {
+		_yod_bptree_destroy(self, self->root, 0 __ENV_CARGS);
+	}
+	pthread_mutex_unlock(&self->lock);
+	pthread_mutex_destroy(&self->lock);
+	free(self);
+}
+/* }}} */
+
+
+/** {{{ int _yod_bptree_add(yod_bptree_t *self, uint64_t key, void *value, int force __ENV_CPARM)
+*/
+int _yod_bptree_add(yod_bptree_t *self, uint64_t key, void *value, int force __ENV_CPARM)
+{
+	yod_bptree_s path[YOD_BPTREE_DEPTH + 1];
+	yod_bptree_v *node = NULL;
+	ulong pos = 0;
+	int ret = 0;
+
+	if (!self) {
+		return (-1);
+	}
+
+	pthread_mutex_lock(&self->lock);
+
+	if (!self->root) {
+		node = _yod_bptree_node(__ENV_ARGS);
+		if (!node) {
+			ret = -1;
+			goto e_return;
+		}
+		self->root = node;
+		self->head = node;
+		self->tail = node;
+	}
+
+	if (force) {
+		node = _yod_bptree_search(self, key, YOD_BPTREE_LOWER, &pos);
+		if (node && node->keys[pos] == key) {
+			if (self->vfree) {
+				self->vfree(node->slot[pos] __ENV_CARGS);
+			}
+			node->slot[pos] = value;
+			goto e_return;
+		}
+	}
+
+	/* equal keys are kept in insertion order */
+	_yod_bptree_locate(self, key, 1, path);
+	ret = _yod_bptree_insert(self, path, key, value __ENV_CARGS);
+	if (ret == 0) {
+		++ self->count;
+		++ self->stamp;
+	}
+	else if (self->count == 0) {
+		_yod_bptree_release(self->root __ENV_CARGS);
+		self->root = NULL;
+		self->head = NULL;
+		self->tail = NULL;
+	}
+
+e_return:
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_BPTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu): %d in %s:%d %s",
+		__FUNCTION__, self, (ulong) key, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ int _yod_bptree_del(yod_bptree_t *self, uint64_t key __ENV_CPARM)
+*/
+int _yod_bptree_del(yod_bptree_t *self, uint64_t key __ENV_CPARM)
+{
+	yod_bptree_s path[YOD_BPTREE_DEPTH + 1];
+	yod_bptree_s *leaf = NULL;
+	int ret = 0;
+
+	if (!self) {
+		return (-1);
+	}
+
+	pthread_mutex_lock(&self->lock);
+
+	if (!self->root) {
+		ret = -1;
+		goto e_return;
+	}
+
+	/* the first equal key may start the next leaf */
+	_yod_bptree_locate(self, key, 0, path);
+	leaf = &path[self->height];
+	if (leaf->pos == leaf->node->count && _yod_bptree_step(self, path) != 0) {
+		ret = -1;
+		goto e_return;
+	}
+	if (leaf->node->keys[leaf->pos] != key) {
+		ret = -1;
+		goto e_return;
+	}
+
+	if (self->vfree) {
+		self->vfree(leaf->node->slot[leaf->pos] __ENV_CARGS);
+	}
+	_yod_bptree_remove(self, path __ENV_CARGS);
+
+	-- self->count;
+	++ self->stamp;
+
+e_return:
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_BPTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu): %d in %s:%d %s",
+		__FUNCTION__, self, (ulong) key, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_bptree_find(yod_bptree_t *self, uint64_t key __ENV_CPARM)
+*/
+void *_yod_bptree_find(yod_bptree_t *self, uint64_t key __ENV_CPARM)
+{
+	yod_bptree_v *node = NULL;
+	void *value = NULL;
+	ulong pos = 0;
+
+	if (!self) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&self->lock);
+	node = _yod_bptree_search(self, key, YOD_BPTREE_LOWER, &pos);
+	if (node && node->keys[pos] == key) {
+		value = node->slot[pos];
+	}
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_BPTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu): %p in %s:%d %s",
+		__FUNCTION__, self, (ulong) key, value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ ulong _yod_bptree_count(yod_bptree_t *self __ENV_CPARM)
+*/
+ulong _yod_bptree_count(yod_bptree_t *self __ENV_CPARM)
+{
+	if (!self) {
+		return 0;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && (_YOD_BPTREE_DEBUG & 0x02))
+	yod_stdlog_debug(NULL, "%s(%p): %lu in %s:%d %s",
+		__FUNCTION__, self, self->count, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return self->count;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_bptree_head(yod_bptree_t *self, uint64_t *key __ENV_CPARM)
+*/
+void *_yod_bptree_head(yod_bptree_t *self, uint64_t *key __ENV_CPARM)
+{
+	void *value = NULL;
+
+	if (!self) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&self->lock);
+	self->curr.node = NULL;
+	value = _yod_bptree_iter(&self->curr, 1, key);
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_BPTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu): %p in %s:%d %s",
+		__FUNCTION__, self, (ulong) (key ? *key : 0), value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_bptree_tail(yod_bptree_t *self, uint64_t *key __ENV_CPARM)
+*/
+void *_yod_bptree_tail(yod_bptree_t *self, uint64_t *key __ENV_CPARM)
+{
+	void *value = NULL;
+
+	if (!self) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&self->lock);
+	self->curr.node = NULL;
+	value = _yod_bptree_iter(&self->curr, 0, key);
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_BPTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu): %p in %s:%d %s",
+		__FUNCTION__, self, (ulong) (key ? *key : 0), value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_bptree_next(yod_bptree_t *self, uint64_t *key __ENV_CPARM)
+*/
+void *_yod_bptree_next(yod_bptree_t *self, uint64_t *key __ENV_CPARM)
+{
+	void *value = NULL;
+
+	if (!self) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&self->lock);
+	if (self->curr.node) {
+		value = _yod_bptree_iter(&self->curr, 1, key);
+	}
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_BPTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu): %p in %s:%d %s",
+		__FUNCTION__, self, (ulong) (key ? *key : 0), value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_bptree_prev(yod_bptree_t *self, uint64_t *key __ENV_CPARM)
+*/
+void *_yod_bptree_prev(yod_bptree_t *self, uint64_t *key __ENV_CPARM)
+{
+	void *value = NULL;
+
+	if (!self) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&self->lock);
+	if (self->curr.node) {
+		value = _yod_bptree_iter(&self->curr, 0, key);
+	}
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_BPTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu): %p in %s:%d %s",
+		__FUNCTION__, self, (ulong) (key ? *key : 0), value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_bptree_iter_head(yod_bptree_t *self, yod_bptree_i *iter, uint64_t *key __ENV_CPARM)
+*/
+void *_yod_bptree_iter_head(yod_bptree_t *self, yod_bptree_i *iter, uint64_t *key __ENV_CPARM)
+{
+	void *value = NULL;
+
+	if (!self || !iter) {
+		return NULL;
+	}
+
+	iter->tree = self;
+	iter->node = NULL;
+
+	pthread_mutex_lock(&self->lock);
+	value = _yod_bptree_iter(iter, 1, key);
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_BPTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p, %lu): %p in %s:%d %s",
+		__FUNCTION__, self, iter, (ulong) (key ? *key : 0), value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_bptree_iter_tail(yod_bptree_t *self, yod_bptree_i *iter, uint64_t *key __ENV_CPARM)
+*/
+void *_yod_bptree_iter_tail(yod_bptree_t *self, yod_bptree_i *iter, uint64_t *key __ENV_CPARM)
+{
+	void *value = NULL;
+
+	if (!self || !iter) {
+		return NULL;
+	}
+
+	iter->tree = self;
+	iter->node = NULL;
+
+	pthread_mutex_lock(&self->lock);
+	value = _yod_bptree_iter(iter, 0, key);
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_BPTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p, %lu): %p in %s:%d %s",
+		__FUNCTION__, self, iter, (ulong) (key ? *key : 0), value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_bptree_iter_next(yod_bptree_i *iter, uint64_t *key __ENV_CPARM)
+*/
+void *_yod_bptree_iter_next(yod_bptree_i *iter, uint64_t *key __ENV_CPARM)
+{
+	void *value = NULL;
+
+	if (!iter || !iter->tree || !iter->node) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&iter->tree->lock);
+	value = _yod_bptree_iter(iter, 1, key);
+	pthread_mutex_unlock(&iter->tree->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_BPTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu): %p in %s:%d %s",
+		__FUNCTION__, iter, (ulong) (key ? *key : 0), value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_bptree_iter_prev(yod_bptree_i *iter, uint64_t *key __ENV_CPARM)
+*/
+void *_yod_bptree_iter_prev(yod_bptree_i *iter, uint64_t *key __ENV_CPARM)
+{
+	void *value = NULL;
+
+	if (!iter || !iter->tree || !iter->node) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&iter->tree->lock);
+	value = _yod_bptree_iter(iter, 0, key);
+	pthread_mutex_unlock(&iter->tree->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_BPTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu): %p in %s:%d %s",
+		__FUNCTION__, iter, (ulong) (key ? *key : 0), value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ int _yod_bptree_visit(yod_bptree_t *self, yod_bptree_fn func, void *arg __ENV_CPARM)
+*/
+int _yod_bptree_visit(yod_bptree_t *self, yod_bptree_fn func, void *arg __ENV_CPARM)
+{
+	yod_bptree_v *node = NULL;
+	ulong i = 0;
+	int ret = 0;
+
+	if (!self || !func) {
+		return (-1);
+	}
+
+	/* func must not call back into the tree */
+	pthread_mutex_lock(&self->lock);
+	for (node = self->head; ret == 0 && node != NULL; node = node->next) {
+		for (i = 0; ret == 0 && i < node->count; ++i) {
+			ret = func(node->keys[i], node->slot[i], arg __ENV_CARGS);
+		}
+	}
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_BPTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p, %p): %d in %s:%d %s",
+		__FUNCTION__, self, func, arg, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_bptree_bound(yod_bptree_t *self, uint64_t key, uint64_t *rkey, int mode __ENV_CPARM)
+*/
+void *_yod_bptree_bound(yod_bptree_t *self, uint64_t key, uint64_t *rkey, int mode __ENV_CPARM)
+{
+	yod_bptree_v *node = NULL;
+	void *value = NULL;
+	ulong pos = 0;
+
+	if (!self) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&self->lock);
+	node = _yod_bptree_search(self, key, mode, &pos);
+
+	/* next/prev continue from the entry found */
+	self->curr.node = node;
+	if (node) {
+		self->curr.pos = pos;
+		self->curr.key = node->keys[pos];
+		self->curr.stamp = self->stamp;
+		if (rkey) {
+			*rkey = node->keys[pos];
+		}
+		value = node->slot[pos];
+	}
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_BPTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu, %d): %p in %s:%d %s",
+		__FUNCTION__, self, (ulong) key, mode, value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ int _yod_bptree_range(yod_bptree_t *self, uint64_t lo, uint64_t hi, yod_bptree_fn func, void *arg __ENV_CPARM)
+*/
+int _yod_bptree_range(yod_bptree_t *self, uint64_t lo, uint64_t hi, yod_bptree_fn func, void *arg __ENV_CPARM)
+{
+	yod_bptree_v *node = NULL;
+	ulong pos = 0;
+	int ret = 0;
+
+	if (!self || !func) {
+		return (-1);
+	}
+
+	/* visits [lo, hi), func must not call back into the tree */
+	pthread_mutex_lock(&self->lock);
+	node = _yod_bptree_search(self, lo, YOD_BPTREE_LOWER, &pos);
+	for (; ret == 0 && node != NULL; node = node->next, pos = 0) {
+		for (; ret == 0 && pos < node->count && node->keys[pos] < hi; ++pos) {
+			ret = func(node->keys[pos], node->slot[pos], arg __ENV_CARGS);
+		}
+		if (pos < node->count) {
+			break;
+		}
+	}
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_BPTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu, %lu, %p, %p): %d in %s:%d %s",
+		__FUNCTION__, self, (ulong) lo, (ulong) hi, func, arg, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ static void _yod_bptree_rank_init(void)
+*/
+static void _yod_bptree_rank_init(void)
+{
+	ulong (*rank) (const uint64_t *, ulong, uint64_t, int) = _yod_bptree_rank;
+
+#if (_YOD_BPTREE_SIMD)
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx2")) {
+		rank = _yod_bptree_rank_avx2;
+	}
+	else if (__builtin_cpu_supports("sse4.2")) {
+		rank = _yod_bptree_rank_sse42;
+	}
+#endif
+
+	/* racing callers store the same pointer */
+	yod_bptree_rank__ = rank;
+}
+/* }}} */
+
+
+/** {{{ static ulong _yod_bptree_rank(const uint64_t *keys, ulong count, uint64_t key, int upper)
+*/
+static ulong _yod_bptree_rank(const uint64_t *keys, ulong count, uint64_t key, int upper)
+{
+	ulong n = 0;
+	ulong i = 0;
+
+	/* number of keys < key, or <= key when upper, branch free */
+	if (upper) {
+		for (; i < count; ++i) {
+			n += (keys[i] <= key);
+		}
+	} else {
+		for (; i < count; ++i) {
+			n += (keys[i] < key);
+		}
+	}
+
+	return n;
+}
+/* }}} */
+
+
+#if (_YOD_BPTREE_SIMD)
+/** {{{ static ulong _yod_bptree_rank_sse42(const uint64_t *keys, ulong count, uint64_t key, int upper)
+*/
+__attribute__((target("sse4.2")))
+static ulong _yod_bptree_rank_sse42(const uint64_t *keys, ulong count, uint64_t key, int upper)
+{
+	/* the compare is signed, flip the sign bits to order unsigned keys */
+	__m128i s = _mm_set1_epi64x((long long) 0x8000000000000000ULL);
+	__m128i k = _mm_xor_si128(_mm_set1_epi64x((long long) key), s);
+	__m128i v, m;
+	ulong n = 0;
+	ulong i = 0;
+	int b = 0;
+
+	for (; i + 2 <= count; i += 2) {
+		v = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (keys + i)), s);
+		m = upper ? _mm_cmpgt_epi64(v, k) : _mm_cmpgt_epi64(k, v);
+		b = __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(m)));
+		b = upper ? (2 - b) : b;
+		n += b;
+		if (b < 2) {
+			return n;
+		}
+	}
+
+	return n + _yod_bptree_rank(keys + i, count - i, key, upper);
+}
+/* }}} */
+
+
+/** {{{ static ulong _yod_bptree_rank_avx2(const uint64_t *keys, ulong count, uint64_t key, int upper)
+*/
+__attribute__((target("avx2")))
+static ulong _yod_bptree_rank_avx2(const uint64_t *keys, ulong count, uint64_t key, int upper)
+{
+	__m256i s = _mm256_set1_epi64x((long long) 0x8000000000000000ULL);
+	__m256i k = _mm256_xor_si256(_mm256_set1_epi64x((long long) key), s);
+	__m256i v, m;
+	ulong n = 0;
+	ulong i = 0;
+	int b = 0;
+
+	for (; i + 4 <= count; i += 4) {
+		v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) (keys + i)), s);
+		m = upper ? _mm256_cmpgt_epi64(v, k) : _mm256_cmpgt_epi64(k, v);
+		b = __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(m)));
+		b = upper ? (4 - b) : b;
+		n += b;
+		if (b < 4) {
+			return n;
+		}
+	}
+
+	return n + _yod_bptree_rank(keys + i, count - i, key, upper);
+}
+/* }}} */
+#endif
+
+
+/** {{{ static yod_bptree_v *_yod_bptree_node(__ENV_PARM)
+*/
+static yod_bptree_v *_yod_bptree_node(__ENV_PARM)
+{
+	yod_bptree_v *node = NULL;
+	void *base = NULL;
+
+	base = malloc(sizeof(yod_bptree_v) + YOD_BPTREE_LINE - 1);
+	if (!base) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
+	}
+
+	node = (yod_bptree_v *) (((uintptr_t) base + YOD_BPTREE_LINE - 1) & ~((uintptr_t) YOD_BPTREE_LINE - 1));
+	node->base = base;
+	node->count = 0;
+	node->next = NULL;
+	node->prev = NULL;
+
+	__ENV_VOID
+
+	return node;
+}
+/* }}} */
+
+
+/** {{{ static void _yod_bptree_release(yod_bptree_v *node __ENV_CPARM)
+*/
+static void _yod_bptree_release(yod_bptree_v *node __ENV_CPARM)
+{
+	free(node->base);
+}
+/* }}} */
+
+
+/** {{{ static void _yod_bptree_destroy(yod_bptree_t *self, yod_bptree_v *node, ulong level __ENV_CPARM)
+*/
+static void _yod_bptree_destroy(yod_bptree_t *self, yod_bptree_v *node, ulong level __ENV_CPARM)
+{
+	ulong i = 0;
+
+	if (level < self->height) {
+		for (i = 0; i <= node->count; ++i) {
+			_yod_bptree_destroy(self, (yod_bptree_v *) node->slot[i], level + 1 __ENV_CARGS);
+		}
+	}
+	else if (self->vfree) {
+		for (i = 0; i < node->count; ++i) {
+			self->vfree(node->slot[i] __ENV_CARGS);
+		}
+	}
+	_yod_bptree_release(node __ENV_CARGS);
+}
+/* }}} */
+
+
+/** {{{ static void _yod_bptree_locate(yod_bptree_t *self, uint64_t key, int upper, yod_bptree_s *path)
+*/
+static void _yod_bptree_locate(yod_bptree_t *self, uint64_t key, int upper, yod_bptree_s *path)
+{
+	yod_bptree_v *node = self->root;
+	ulong i = 0;
+
+	for (i = 0; i < self->height; ++i) {
+		path[i].node = node;
+		path[i].pos = yod_bptree_rank__(node->keys, node->count, key, upper);
+		node = (yod_bptree_v *) node->slot[path[i].pos];
+	}
+	path[i].node = node;
+	path[i].pos = yod_bptree_rank__(node->keys, node->count, key, upper);
+}
+/* }}} */
+
+
+/** {{{ static int _yod_bptree_step(yod_bptree_t *self, yod_bptree_s *path)
+*/
+static int _yod_bptree_step(yod_bptree_t *self, yod_bptree_s *path)
+{
+	yod_bptree_v *node = NULL;
+	long i = 0;
+
+	/* move the path to the first entry of the next leaf */
+	for (i = (long) self->height - 1; i >= 0; --i) {
+		if (path[i].pos < path[i].node->count) {
+			break;
+		}
+	}
+	if (i < 0) {
+		return (-1);
+	}
+
+	node = (yod_bptree_v *) path[i].node->slot[++ path[i].pos];
+	for (++i; i <= (long) self->height; ++i) {
+		path[i].node = node;
+		path[i].pos = 0;
+		if (i < (long) self->height) {
+			node = (yod_bptree_v *) node->slot[0];
+		}
+	}
+
+	return (0);
+}
+/* }}} */
+
+
+/** {{{ static yod_bptree_v *_yod_bptree_search(yod_bptree_t *self, uint64_t key, int mode, ulong *pos)
+*/
+static yod_bptree_v *_yod_bptree_search(yod_bptree_t *self, uint64_t key, int mode, ulong *pos)
+{
+	yod_bptree_v *node = self->root;
+	int upper = (mode == YOD_BPTREE_UPPER || mode == YOD_BPTREE_FLOOR);
+	ulong i = 0;
+	ulong n = 0;
+
+	if (!node) {
+		return NULL;
+	}
+
+	for (i = 0; i < self->height; ++i) {
+		node = (yod_bptree_v *) node->slot[yod_bptree_rank__(node->keys, node->count, key, upper)];
+		YOD_SYSTEM_PREFETCH(node->keys);
+	}
+	n = yod_bptree_rank__(node->keys, node->count, key, upper);
+
+	/* floor is the entry before the upper bound */
+	if (mode == YOD_BPTREE_FLOOR) {
+		if (n == 0) {
+			node = node->prev;
+			if (!node) {
+				return NULL;
+			}
+			n = node->count;
+		}
+		*pos = n - 1;
+		return node;
+	}
+
+	if (n == node->count) {
+		node = node->next;
+		n = 0;
+	}
+	*pos = n;
+
+	return node;
+}
+/* }}} */
+
+
+/** {{{ static int _yod_bptree_insert(yod_bptree_t *self, yod_bptree_s *path, uint64_t key, void *value __ENV_CPARM)
+*/
+static int _yod_bptree_insert(yod_bptree_t *self, yod_bptree_s *path, uint64_t key, void *value __ENV_CPARM)
+{
+	yod_bptree_v *spare[YOD_BPTREE_DEPTH + 1];
+	uint64_t keys[YOD_BPTREE_ORDER + 1];
+	void *slot[YOD_BPTREE_ORDER + 2];
+	yod_bptree_v *node = NULL;
+	yod_bptree_v *temp = NULL;
+	void *item = value;
+	ulong half = 0;
+	ulong pos = 0;
+	ulong n = 0;
+	long level = 0;
+	long need = 0;
+	long i = 0;
+
+	/* allocate every split up front, the tree is never left half split */
+	for (level = (long) self->height; level >= 0 && path[level].node->count == YOD_BPTREE_ORDER; --level) {
+		++ need;
+	}
+	if (level < 0) {
+		++ need;
+	}
+	if (need > YOD_BPTREE_DEPTH) {
+		YOD_STDLOG_ERROR("tree too deep");
+		return (-1);
+	}
+	for (i = 0; i < need; ++i) {
+		spare[i] = _yod_bptree_node(__ENV_ARGS);
+		if (!spare[i]) {
+			while (i > 0) {
+				_yod_bptree_release(spare[--i] __ENV_CARGS);
+			}
+			return (-1);
+		}
+	}
+
+	for (i = 0, level = (long) self->height; level >= 0; --level) {
+		node = path[level].node;
+		pos = path[level].pos;
+		n = node->count;
+
+		/* leaves take the value at pos, inner nodes the child after key */
+		if (n < YOD_BPTREE_ORDER) {
+			memmove(node->keys + pos + 1, node->keys + pos, (n - pos) * sizeof(uint64_t));
+			if (level == (long) self->height) {
+				memmove(node->slot + pos + 1, node->slot + pos, (n - pos) * sizeof(void *));
+				node->slot[pos] = item;
+			} else {
+				memmove(node->slot + pos + 2, node->slot + pos + 1, (n - pos) * sizeof(void *));
+				node->slot[pos + 1] = item;
+			}
+			node->keys[pos] = key;
+			++ node->count;
+			return (0);
+		}
+
+		temp = spare[i++];
+
+		memcpy(keys, node->keys, pos * sizeof(uint64_t));
+		keys[pos] = key;
+		memcpy(keys + pos + 1, node->keys + pos, (n - pos) * sizeof(uint64_t));
+
+		if (level == (long) self->height) {
+			memcpy(slot, node->slot, pos * sizeof(void *));
+			slot[pos] = item;
+			memcpy(slot + pos + 1, node->slot + pos, (n - pos) * sizeof(void *));
+
+			half = (YOD_BPTREE_ORDER + 1) >> 1;
+			node->count = half;
+			temp->count = YOD_BPTREE_ORDER + 1 - half;
+			memcpy(node->keys, keys, half * sizeof(uint64_t));
+			memcpy(node->slot, slot, half * sizeof(void *));
+			memcpy(temp->keys, keys + half, temp->count * sizeof(uint64_t));
+			memcpy(temp->slot, slot + half, temp->count * sizeof(void *));
+
+			temp->next = node->next;
+			temp->prev = node;
+			if (node->next) {
+				node->next->prev = temp;
+			} else {
+				self->tail = temp;
+			}
+			node->next = temp;
+
+			key = temp->keys[0];
+		}
+		else {
+			memcpy(slot, node->slot, (pos + 1) * sizeof(void *));
+			slot[pos + 1] = item;
+			memcpy(slot + pos + 2, node->slot + pos + 1, (n - pos) * sizeof(void *));
+
+			/* the middle key moves up */
+			half = YOD_BPTREE_ORDER >> 1;
+			node->count = half;
+			temp->count = YOD_BPTREE_ORDER - half;
+			memcpy(node->keys, keys, half * sizeof(uint64_t));
+			memcpy(node->slot, slot, (half + 1) * sizeof(void *));
+			memcpy(temp->keys, keys + half + 1, temp->count * sizeof(uint64_t));
+			memcpy(temp->slot, slot + half + 1, (temp->count + 1) * sizeof(void *));
+
+			key = keys[half];
+		}
+		item = temp;
+	}
+
+	/* the root split, grow a level */
+	temp = spare[i];
+	temp->count = 1;
+	temp->keys[0] = key;
+	temp->slot[0] = self->root;
+	temp->slot[1] = item;
+	self->root = temp;
+	++ self->height;
+
+#if (_YOD_SYSTEM_DEBUG && (_YOD_BPTREE_DEBUG & 0x02))
+	yod_stdlog_debug(NULL, "%s(%p): {height=%lu, count=%lu} in %s:%d %s",
+		__FUNCTION__, self, self->height, self->count, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (0);
+}
+/* }}} */
+
+
+/** {{{ static void _yod_bptree_remove(yod_bptree_t *self, yod_bptree_s *path __ENV_CPARM)
+*/
+static void _yod_bptree_remove(yod_bptree_t *self, yod_bptree_s *path __ENV_CPARM)
+{
+	yod_bptree_v *node = NULL;
+	yod_bptree_v *parent = NULL;
+	yod_bptree_v *left = NULL;
+	yod_bptree_v *right = NULL;
+	long level = (long) self->height;
+	int leaf = 1;
+	ulong pos = 0;
+	ulong n = 0;
+	ulong k = 0;
+
+	node = path[level].node;
+	pos = path[level].pos;
+	n = -- node->count;
+	memmove(node->keys + pos, node->keys + pos + 1, (n - pos) * sizeof(uint64_t));
+	memmove(node->slot + pos, node->slot + pos + 1, (n - pos) * sizeof(void *));
+
+	while (level > 0 && node->count < YOD_BPTREE_MIN) {
+		parent = path[level - 1].node;
+		pos = path[level - 1].pos;
+		leaf = (level == (long) self->height);
+		left = (pos > 0) ? (yod_bptree_v *) parent->slot[pos - 1] : NULL;
+		right = (pos < parent->count) ? (yod_bptree_v *) parent->slot[pos + 1] : NULL;
+		n = node->count;
+
+		/* borrow the last entry of the left sibling */
+		if (left && left->count > YOD_BPTREE_MIN) {
+			memmove(node->keys + 1, node->keys, n * sizeof(uint64_t));
+			if (leaf) {
+				memmove(node->slot + 1, node->slot, n * sizeof(void *));
+				node->keys[0] = left->keys[left->count - 1];
+				node->slot[0] = left->slot[left->count - 1];
+				parent->keys[pos - 1] = node->keys[0];
+			} else {
+				memmove(node->slot + 1, node->slot, (n + 1) * sizeof(void *));
+				node->keys[0] = parent->keys[pos - 1];
+				node->slot[0] = left->slot[left->count];
+				parent->keys[pos - 1] = left->keys[left->count - 1];
+			}
+			-- left->count;
+			++ node->count;
+			break;
+		}
+
+		/* borrow the first entry of the right sibling */
+		if (right && right->count > YOD_BPTREE_MIN) {
+			if (leaf) {
+				node->keys[n] = right->keys[0];
+				node->slot[n] = right->slot[0];
+				memmove(right->keys, right->keys + 1, (right->count - 1) * sizeof(uint64_t));
+				memmove(right->slot, right->slot + 1, (right->count - 1) * sizeof(void *));
+				parent->keys[pos] = right->keys[0];
+			} else {
+				node->keys[n] = parent->keys[pos];
+				node->slot[n + 1] = right->slot[0];
+				parent->keys[pos] = right->keys[0];
+				memmove(right->keys, right->keys + 1, (right->count - 1) * sizeof(uint64_t));
+				memmove(right->slot, right->slot + 1, right->count * sizeof(void *));
+			}
+			-- right->count;
+			++ node->count;
+			break;
+		}
+
+		/* merge with a sibling into the left one of the pair */
+		if (left) {
+			right = node;
+			k = pos - 1;
+		} else {
+			left = node;
+			k = pos;
+		}
+		if (leaf) {
+			memcpy(left->keys + left->count, right->keys, right->count * sizeof(uint64_t));
+			memcpy(left->slot + left->count, right->slot, right->count * sizeof(void *));
+			left->count += right->count;
+
+			left->next = right->next;
+			if (right->next) {
+				right->next->prev = left;
+			} else {
+				self->tail = left;
+			}
+		} else {
+			left->keys[left->count] = parent->keys[k];
+			memcpy(left->keys + left->count + 1, right->keys, right->count * sizeof(uint64_t));
+			memcpy(left->slot + left->count + 1, right->slot, (right->count + 1) * sizeof(void *));
+			left->count += right->count + 1;
+		}
+		_yod_bptree_release(right __ENV_CARGS);
+
+		/* drop the separator and the merged child */
+		memmove(parent->keys + k, parent->keys + k + 1, (parent->count - k - 1) * sizeof(uint64_t));
+		memmove(parent->slot + k + 1, parent->slot + k + 2, (parent->count - k - 1) * sizeof(void *));
+		-- parent->count;
+
+		node = parent;
+		-- level;
+	}
+
+	node = self->root;
+	if (node->count == 0) {
+		if (self->height > 0) {
+			self->root = (yod_bptree_v *) node->slot[0];
+			-- self->height;
+		} else {
+			self->root = NULL;
+			self->head = NULL;
+			self->tail = NULL;
+		}
+		_yod_bptree_release(node __ENV_CARGS);
+	}
+
+	__ENV_VOID
+}
+/* }}} */
+
+
+/** {{{ static void *_yod_bptree_iter(yod_bptree_i *iter, int forward, uint64_t *key)
+*/
+static void *_yod_bptree_iter(yod_bptree_i *iter, int forward, uint64_t *key)
+{
+	yod_bptree_t *self = iter->tree;
+	yod_bptree_v *node = NULL;
+	yod_bptree_v *p = NULL;
+	ulong pos = 0;
+	ulong i = 0;
+
+	if (!iter->node) {
+		node = forward ? self->head : self->tail;
+		pos = (node && !forward) ? node->count - 1 : 0;
+	}
+	else if (iter->stamp == self->stamp) {
+		node = (yod_bptree_v *) iter->node;
+		pos = iter->pos;
+		if (forward) {
+			if (++ pos == node->count) {
+				node = node->next;
+				pos = 0;
+			}
+		} else if (pos > 0) {
+			-- pos;
+		} else {
+			node = node->prev;
+			pos = node ? node->count - 1 : 0;
+		}
+	}
+	else if (forward) {
+		/* the tree changed, look for the saved entry among equal keys and
+		 * step past it; if it was deleted they are walked again */
+		node = _yod_bptree_search(self, iter->key, YOD_BPTREE_LOWER, &pos);
+		for (p = node, i = pos; p && p->keys[i] == iter->key;) {
+			if (p->slot[i] == iter->value) {
+				node = p;
+				pos = i;
+				if (++ pos == node->count) {
+					node = node->next;
+					pos = 0;
+				}
+				break;
+			}
+			if (++ i == p->count) {
+				p = p->next;
+				i = 0;
+			}
+		}
+	}
+	else {
+		/* the last entry not greater than the saved key, then back past
+		 * the saved entry among equal keys */
+		node = _yod_bptree_search(self, iter->key, YOD_BPTREE_UPPER, &pos);
+		if (!node) {
+			node = self->tail;
+			pos = node ? node->count : 0;
+		}
+		if (node && pos == 0) {
+			node = node->prev;
+			pos = node ? node->count : 0;
+		}
+		-- pos;
+		for (p = node, i = pos; p && p->keys[i] == iter->key;) {
+			if (p->slot[i] == iter->value) {
+				node = p;
+				pos = i;
+				if (pos > 0) {
+					-- pos;
+				} else {
+					node = node->prev;
+					pos = node ? node->count - 1 : 0;
+				}
+				break;
+			}
+			if (i > 0) {
+				-- i;
+			} else {
+				p = p->prev;
+				i = p ? p->count - 1 : 0;
+			}
+		}
+	}
+
+	iter->node = node;
+	if (!node) {
+		return NULL;
+	}
+
+	iter->pos = pos;
+	iter->key = node->keys[pos];
+	iter->value = node->slot[pos];
+	iter->stamp = self->stamp;
+	if (key) {
+		*key = node->keys[pos];
+	}
+
+	return node->slot[pos];
+}
+/* }}} */
@@ -0,0 +1,80 @@
+#ifndef __YOD_BPTREE_H__
+#define __YOD_BPTREE_H__
+
+#include "system.h"
+
+
+#define YOD_BPTREE_LOWER 										0
+#define YOD_BPTREE_UPPER 										1
+#define YOD_BPTREE_FLOOR 										2
+#define YOD_BPTREE_CEIL 										3
+
+
+/* yod_bptree_t */
+typedef struct _yod_bptree_t 									yod_bptree_t;
+
+/* yod_bptree_i */
+typedef struct _yod_bptree_i
+{
+	yod_bptree_t *tree;
+	void *node;
+	ulong pos;
+	uint64_t key;
+	void *value;
+	ulong stamp;
+} yod_bptree_i;
+
+/* yod_bptree_fn */
+typedef int (*yod_bptree_fn) (uint64_t key, void *value, void *arg __ENV_CPARM);
+
+
+#define yod_bptree_new(f) 										_yod_bptree_new(f __ENV_CARGS)
+#define yod_bptree_free(x) 										_yod_bptree_free(x __ENV_CARGS)
+
+#define yod_bptree_add(x, k, v, f) 								_yod_bptree_add(x, k, v, f __ENV_CARGS)
+#define yod_bptree_set(x, k, v) 								_yod_bptree_add(x, k, v, 1 __ENV_CARGS)
+#define yod_bptree_del(x, k) 									_yod_bptree_del(x, k __ENV_CARGS)
+#define yod_bptree_find(x, k) 									_yod_bptree_find(x, k __ENV_CARGS)
+
+#define yod_bptree_count(x) 									_yod_bptree_count(x __ENV_CARGS)
+#define yod_bptree_head(x, k) 									_yod_bptree_head(x, k __ENV_CARGS)
+#define yod_bptree_tail(x, k) 									_yod_bptree_tail(x, k __ENV_CARGS)
+#define yod_bptree_next(x, k) 									_yod_bptree_next(x, k __ENV_CARGS)
+#define yod_bptree_prev(x, k) 									_yod_bptree_prev(x, k __ENV_CARGS)
+
+#define yod_bptree_iter_head(x, t, k) 							_yod_bptree_iter_head(x, t, k __ENV_CARGS)
+#define yod_bptree_iter_tail(x, t, k) 							_yod_bptree_iter_tail(x, t, k __ENV_CARGS)
+#define yod_bptree_iter_next(t, k) 								_yod_bptree_iter_next(t, k __ENV_CARGS)
+#define yod_bptree_iter_prev(t, k) 								_yod_bptree_iter_prev(t, k __ENV_CARGS)
+#define yod_bptree_visit(x, f, a) 								_yod_bptree_visit(x, f, a __ENV_CARGS)
+
+#define yod_bptree_lower_bound(x, k, r) 						_yod_bptree_bound(x, k, r, YOD_BPTREE_LOWER __ENV_CARGS)
+#define yod_bptree_upper_bound(x, k, r) 						_yod_bptree_bound(x, k, r, YOD_BPTREE_UPPER __ENV_CARGS)
+#define yod_bptree_floor(x, k, r) 								_yod_bptree_bound(x, k, r, YOD_BPTREE_FLOOR __ENV_CARGS)
+#define yod_bptree_ceil(x, k, r) 								_yod_bptree_bound(x, k, r, YOD_BPTREE_CEIL __ENV_CARGS)
+#define yod_bptree_range(x, l, h, f, a) 						_yod_bptree_range(x, l, h, f, a __ENV_CARGS)
+
+
+yod_bptree_t *_yod_bptree_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM);
+void _yod_bptree_free(yod_bptree_t *self __ENV_CPARM);
+
+int _yod_bptree_add(yod_bptree_t *self, uint64_t key, void *value, int force __ENV_CPARM);
+int _yod_bptree_del(yod_bptree_t *self, uint64_t key __ENV_CPARM);
+void *_yod_bptree_find(yod_bptree_t *self, uint64_t key __ENV_CPARM);
+
+ulong _yod_bptree_count(yod_bptree_t *self __ENV_CPARM);
+void *_yod_bptree_head(yod_bptree_t *self, uint64_t *key __ENV_CPARM);
+void *_yod_bptree_tail(yod_bptree_t *self, uint64_t *key __ENV_CPARM);
+void *_yod_bptree_next(yod_bptree_t *self, uint64_t *key __ENV_CPARM);
+void *_yod_bptree_prev(yod_bptree_t *self, uint64_t *key __ENV_CPARM);
+
+void *_yod_bptree_iter_head(yod_bptree_t *self, yod_bptree_i *iter, uint64_t *key __ENV_CPARM);
+void *_yod_bptree_iter_tail(yod_bptree_t *self, yod_bptree_i *iter, uint64_t *key __ENV_CPARM);
+void *_yod_bptree_iter_next(yod_bptree_i *iter, uint64_t *key __ENV_CPARM);
+void *_yod_bptree_iter_prev(yod_bptree_i *iter, uint64_t *key __ENV_CPARM);
+int _yod_bptree_visit(yod_bptree_t *self, yod_bptree_fn func, void *arg __ENV_CPARM);
+
+void *_yod_bptree_bound(yod_bptree_t *self, uint64_t key, uint64_t *rkey, int mode __ENV_CPARM);
+int _yod_bptree_range(yod_bptree_t *self, uint64_t lo, uint64_t hi, yod_bptree_fn func, void *arg __ENV_CPARM);
+
+#endif
@@ -4,9 +4,12 @@
 #include <ctype.h>
 
 /* debug */
+#define _YOD_BPTREE_DEBUG 										0
 #define _YOD_DBCONN_DEBUG 										0
+#define _YOD_EPOCH_DEBUG 										0
 #define _YOD_EVLOOP_DEBUG 										0
 #define _YOD_HTABLE_DEBUG 										0
+#define _YOD_IMAP_DEBUG 										0
 #define _YOD_JVALUE_DEBUG 										0
 #define _YOD_RBTREE_DEBUG 										0
 #define _YOD_SERVER_DEBUG 										0
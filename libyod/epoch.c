@@ -0,0 +1,439 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+	#include <sched.h>
+#endif
+#include <errno.h>
+
+#include "stdlog.h"
+#include "epoch.h"
+
+
+#ifndef _YOD_EPOCH_DEBUG
+#define _YOD_EPOCH_DEBUG 										0
+#endif
+
+#define YOD_EPOCH_RETIRE_MAX 									64
+
+
+/* yod_epoch_r */
+typedef struct _yod_epoch_r
+{
+	ulong state;
+	ulong depth;
+	int used;
+
+	struct _yod_epoch_r *next;
+} yod_epoch_r;
+
+
+/* yod_epoch_d */
+typedef struct _yod_epoch_d
+{
+	void *ptr;
+	yod_epoch_fn func;
+	void *arg;
+
+	struct _yod_epoch_d *next;
+} yod_epoch_d;
+
+
+/* yod_epoch_t */
+struct _yod_epoch_t
+{
+	pthread_mutex_t lock;
+	pthread_key_t key;
+
+	ulong epoch;
+	ulong count;
+
+	yod_epoch_r *records;
+	yod_epoch_d *limbo[3];
+};
+
+
+static yod_epoch_r *_yod_epoch_record(yod_epoch_t *self __ENV_CPARM);
+static void _yod_epoch_release(void *arg);
+static int _yod_epoch_advance(yod_epoch_t *self, yod_epoch_d **list __ENV_CPARM);
+static void _yod_epoch_reclaim(yod_epoch_d *list __ENV_CPARM);
+
+
+/** {{{ yod_epoch_t *_yod_epoch_new(__ENV_PARM)
+*/
+yod_epoch_t *_yod_epoch_new(__ENV_PARM)
+{
+	yod_epoch_t *self = NULL;
+
+	self = (yod_epoch_t *) malloc(sizeof(yod_epoch_t));
+	if (!self) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
+	}
+
+	if (pthread_mutex_init(&self->lock, NULL) != 0) {
+		free(self);
+
+		YOD_STDLOG_ERROR("pthread_mutex_init failed");
+		return NULL;
+	}
+
+	if (pthread_key_create(&self->key, _yod_epoch_release) != 0) {
+		pthread_mutex_destroy(&self->lock);
+		free(self);
+
+		YOD_STDLOG_ERROR("pthread_key_create failed");
+		return NULL;
+	}
+
+	{
+		self->epoch = 1;
+		self->count = 0;
+		self->records = NULL;
+		self->limbo[0] = NULL;
+		self->limbo[1] = NULL;
+		self->limbo[2] = NULL;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_EPOCH_DEBUG)
+	yod_stdlog_debug(NULL, "%s(): %p in %s:%d %s",
+		__FUNCTION__, self, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return self;
+}
+/* }}} */
+
+
+/** {{{ void _yod_epoch_free(yod_epoch_t *self __ENV_CPARM)
+*/
+void _yod_epoch_free(yod_epoch_t *self __ENV_CPARM)
+{
+	yod_epoch_r *record = NULL;
+	int i = 0;
+
+	if (!self) {
+		return;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_EPOCH_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p): {epoch=%lu, count=%lu} in %s:%d %s",
+		__FUNCTION__, self, self->epoch, self->count, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	/* no reader may be left, run whatever is still pending */
+	pthread_key_delete(self->key);
+
+	pthread_mutex_lock(&self->lock);
+	for (i = 0; i < 3; ++i) {
+		_yod_epoch_reclaim(self->limbo[i] __ENV_CARGS);
+		self->limbo[i] = NULL;
+	}
+	while ((record = self->records) != NULL) {
+		self->records = record->next;
+		free(record);
+	}
+	pthread_mutex_unlock(&self->lock);
+	pthread_mutex_destroy(&self->lock);
+
+	free(self);
+}
+/* }}} */
+
+
+/** {{{ void _yod_epoch_enter(yod_epoch_t *self __ENV_CPARM)
+*/
+void _yod_epoch_enter(yod_epoch_t *self __ENV_CPARM)
+{
+	yod_epoch_r *record = NULL;
+
+	if (!self) {
+		return;
+	}
+
+	record = (yod_epoch_r *) pthread_getspecific(self->key);
+	if (!record) {
+		record = _yod_epoch_record(self __ENV_CARGS);
+		if (!record) {
+			return;
+		}
+	}
+
+	/* announce the epoch before any shared pointer is loaded */
+	if (record->depth ++ == 0) {
+		__ATM_SET(&record->state, (__ATM_LOAD(&self->epoch) << 1) | 1);
+		__ATM_FENCE();
+	}
+
+#if (_YOD_SYSTEM_DEBUG && (_YOD_EPOCH_DEBUG & 0x02))
+	yod_stdlog_debug(NULL, "%s(%p): %lu in %s:%d %s",
+		__FUNCTION__, self, record->state, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+}
+/* }}} */
+
+
+/** {{{ void _yod_epoch_leave(yod_epoch_t *self __ENV_CPARM)
+*/
+void _yod_epoch_leave(yod_epoch_t *self __ENV_CPARM)
+{
+	yod_epoch_r *record = NULL;
+
+	if (!self) {
+		return;
+	}
+
+	record = (yod_epoch_r *) pthread_getspecific(self->key);
+	if (!record || !record->depth) {
+		return;
+	}
+
+	if (-- record->depth == 0) {
+		__ATM_STORE(&record->state, 0);
+	}
+
+#if (_YOD_SYSTEM_DEBUG && (_YOD_EPOCH_DEBUG & 0x02))
+	yod_stdlog_debug(NULL, "%s(%p): %lu in %s:%d %s",
+		__FUNCTION__, self, record->depth, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+}
+/* }}} */
+
+
+/** {{{ int _yod_epoch_retire(yod_epoch_t *self, void *ptr, yod_epoch_fn func, void *arg __ENV_CPARM)
+*/
+int _yod_epoch_retire(yod_epoch_t *self, void *ptr, yod_epoch_fn func, void *arg __ENV_CPARM)
+{
+	yod_epoch_d *data = NULL;
+	yod_epoch_d *list = NULL;
+
+	if (!self || !func) {
+		return (-1);
+	}
+
+	data = (yod_epoch_d *) malloc(sizeof(yod_epoch_d));
+	if (!data) {
+		YOD_STDLOG_ERROR("malloc failed");
+
+		/* wait out the readers instead */
+		if (_yod_epoch_barrier(self __ENV_CARGS) != 0) {
+			return (-1);
+		}
+		func(ptr, arg __ENV_CARGS);
+		return (0);
+	}
+
+	data->ptr = ptr;
+	data->func = func;
+	data->arg = arg;
+
+	pthread_mutex_lock(&self->lock);
+	data->next = self->limbo[self->epoch % 3];
+	self->limbo[self->epoch % 3] = data;
+	if (++ self->count >= YOD_EPOCH_RETIRE_MAX) {
+		_yod_epoch_advance(self, &list __ENV_CARGS);
+	}
+	pthread_mutex_unlock(&self->lock);
+
+	_yod_epoch_reclaim(list __ENV_CARGS);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_EPOCH_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p, %p, %p) in %s:%d %s",
+		__FUNCTION__, self, ptr, func, arg, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (0);
+}
+/* }}} */
+
+
+/** {{{ int _yod_epoch_barrier(yod_epoch_t *self __ENV_CPARM)
+*/
+int _yod_epoch_barrier(yod_epoch_t *self __ENV_CPARM)
+{
+	yod_epoch_r *record = NULL;
+	yod_epoch_d *list = NULL;
+	ulong epoch = 0;
+
+	if (!self) {
+		return (-1);
+	}
+
+	/* a reader waiting for itself would never return */
+	record = (yod_epoch_r *) pthread_getspecific(self->key);
+	if (record && record->depth) {
+		YOD_STDLOG_ERROR("barrier inside a read section");
+		return (-1);
+	}
+
+	pthread_mutex_lock(&self->lock);
+	epoch = self->epoch + 3;
+	while (self->epoch < epoch) {
+		if (_yod_epoch_advance(self, &list __ENV_CARGS) != 0) {
+			pthread_mutex_unlock(&self->lock);
+#ifdef _WIN32
+			Sleep(0);
+#else
+			sched_yield();
+#endif
+			pthread_mutex_lock(&self->lock);
+			continue;
+		}
+		if (list) {
+			pthread_mutex_unlock(&self->lock);
+			_yod_epoch_reclaim(list __ENV_CARGS);
+			pthread_mutex_lock(&self->lock);
+			list = NULL;
+		}
+	}
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_EPOCH_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p): %lu in %s:%d %s",
+		__FUNCTION__, self, epoch, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (0);
+}
+/* }}} */
+
+
+/** {{{ ulong _yod_epoch_count(yod_epoch_t *self __ENV_CPARM)
+*/
+ulong _yod_epoch_count(yod_epoch_t *self __ENV_CPARM)
+{
+	if (!self) {
+		return 0;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && (_YOD_EPOCH_DEBUG & 0x02))
+	yod_stdlog_debug(NULL, "%s(%p): %lu in %s:%d %s",
+		__FUNCTION__, self, self->count, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return self->count;
+}
+/* }}} */
+
+
+/** {{{ static yod_epoch_r *_yod_epoch_record(yod_epoch_t *self __ENV_CPARM)
+*/
+static yod_epoch_r *_yod_epoch_record(yod_epoch_t *self __ENV_CPARM)
+{
+	yod_epoch_r *record = NULL;
+
+	pthread_mutex_lock(&self->lock);
+
+	/* reuse the record of an exited thread */
+	for (record = self->records; record != NULL; record = record->next) {
+		if (!__ATM_LOAD(&record->used)) {
+			break;
+		}
+	}
+
+	if (!record) {
+		record = (yod_epoch_r *) malloc(sizeof(yod_epoch_r));
+		if (!record) {
+			pthread_mutex_unlock(&self->lock);
+
+			YOD_STDLOG_ERROR("malloc failed");
+			return NULL;
+		}
+		record->next = self->records;
+		self->records = record;
+	}
+
+	record->state = 0;
+	record->depth = 0;
+	record->used = 1;
+
+	pthread_mutex_unlock(&self->lock);
+
+	pthread_setspecific(self->key, record);
+
+	return record;
+}
+/* }}} */
+
+
+/** {{{ static void _yod_epoch_release(void *arg)
+*/
+static void _yod_epoch_release(void *arg)
+{
+	yod_epoch_r *record = (yod_epoch_r *) arg;
+
+	if (record) {
+		__ATM_STORE(&record->state, 0);
+		__ATM_STORE(&record->used, 0);
+	}
+}
+/* }}} */
+
+
+/** {{{ static int _yod_epoch_advance(yod_epoch_t *self, yod_epoch_d **list __ENV_CPARM)
+*/
+static int _yod_epoch_advance(yod_epoch_t *self, yod_epoch_d **list __ENV_CPARM)
+{
+	yod_epoch_r *record = NULL;
+	yod_epoch_d *data = NULL;
+	ulong state = 0;
+
+	/* unlinks done by the caller are visible before the scan */
+	__ATM_FENCE();
+
+	/* every active reader must have seen the current epoch */
+	for (record = self->records; record != NULL; record = record->next) {
+		state = __ATM_LOAD(&record->state);
+		if ((state & 1) && (state >> 1) != self->epoch) {
+			return (-1);
+		}
+	}
+
+	__ATM_SET(&self->epoch, self->epoch + 1);
+
+	/* retired two epochs ago, nobody can reach it any more */
+	*list = self->limbo[self->epoch % 3];
+	self->limbo[self->epoch % 3] = NULL;
+	for (data = *list; data != NULL; data = data->next) {
+		-- self->count;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && (_YOD_EPOCH_DEBUG & 0x02))
+	yod_stdlog_debug(NULL, "%s(%p): {epoch=%lu, count=%lu} in %s:%d %s",
+		__FUNCTION__, self, self->epoch, self->count, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (0);
+}
+/* }}} */
+
+
+/** {{{ static void _yod_epoch_reclaim(yod_epoch_d *list __ENV_CPARM)
+*/
+static void _yod_epoch_reclaim(yod_epoch_d *list __ENV_CPARM)
+{
+	yod_epoch_d *data = NULL;
+
+	while ((data = list) != NULL) {
+		list = data->next;
+		data->func(data->ptr, data->arg __ENV_CARGS);
+		free(data);
+	}
+}
+/* }}} */
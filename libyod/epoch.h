@@ -0,0 +1,37 @@
+#ifndef __YOD_EPOCH_H__
+#define __YOD_EPOCH_H__
+
+#include "system.h"
+
+
+/* yod_epoch_t */
+typedef struct _yod_epoch_t 									yod_epoch_t;
+
+/* yod_epoch_fn */
+typedef void (*yod_epoch_fn) (void *ptr, void *arg __ENV_CPARM);
+
+
+#define yod_epoch_new() 										_yod_epoch_new(__ENV_ARGS)
+#define yod_epoch_free(x) 										_yod_epoch_free(x __ENV_CARGS)
+
+#define yod_epoch_enter(x) 										_yod_epoch_enter(x __ENV_CARGS)
+#define yod_epoch_leave(x) 										_yod_epoch_leave(x __ENV_CARGS)
+
+#define yod_epoch_retire(x, p, f, a) 							_yod_epoch_retire(x, p, f, a __ENV_CARGS)
+#define yod_epoch_barrier(x) 									_yod_epoch_barrier(x __ENV_CARGS)
+
+#define yod_epoch_count(x) 										_yod_epoch_count(x __ENV_CARGS)
+
+
+yod_epoch_t *_yod_epoch_new(__ENV_PARM);
+void _yod_epoch_free(yod_epoch_t *self __ENV_CPARM);
+
+void _yod_epoch_enter(yod_epoch_t *self __ENV_CPARM);
+void _yod_epoch_leave(yod_epoch_t *self __ENV_CPARM);
+
+int _yod_epoch_retire(yod_epoch_t *self, void *ptr, yod_epoch_fn func, void *arg __ENV_CPARM);
+int _yod_epoch_barrier(yod_epoch_t *self __ENV_CPARM);
+
+ulong _yod_epoch_count(yod_epoch_t *self __ENV_CPARM);
+
+#endif
@@ -1,9 +1,20 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <errno.h>
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#include <immintrin.h>
+#endif
 
 #include "stdlog.h"
+#include "epoch.h"
 #include "htable.h"
 
 
@@ -11,6 +22,27 @@
 #define _YOD_HTABLE_DEBUG 										0
 #endif
 
+#define YOD_HTABLE_MIN_SIZE 									(1 << 3)
+#define YOD_HTABLE_REHASH_STEP 									4
+#define YOD_HTABLE_MAX_SHARD 									1024
+#define YOD_HTABLE_BATCH 										64
+
+#define YOD_HTABLE_HASH_LONG 									64
+#define YOD_HTABLE_HASH_P0 										0xa0761d6478bd642fULL
+#define YOD_HTABLE_HASH_P1 										0xe7037ed1a0b428dbULL
+#define YOD_HTABLE_HASH_P2 										0x8ebc6af09c88c6e3ULL
+#define YOD_HTABLE_HASH_P3 										0x589965cc75374cc3ULL
+
+#define YOD_HTABLE_SNAP_MAGIC 									"YODHTS02"
+#define YOD_HTABLE_SNAP_ORDER 									0x01020304
+#define YOD_HTABLE_SNAP_ALIGN(n) 								(((n) + 7) & ~((size_t) 7))
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define YOD_HTABLE_HASH_AVX2 									1
+#else
+#define YOD_HTABLE_HASH_AVX2 									0
+#endif
+
 
 /* yod_htable_v */
 typedef struct _yod_htable_v
@@ -20,86 +52,210 @@ typedef struct _yod_htable_v
 	size_t key_len;
 	void *value;
 
+	/* cache mode */
+	size_t bytes;
+	uint64_t expire;
+
 	struct _yod_htable_v *next;
 	struct _yod_htable_v *prev;
-	struct _yod_htable_v *v_next;
+	struct _yod_htable_v *v_next[2];
 	struct _yod_htable_v *v_prev;
+
+	/* from the shard at insert, tells a reused address apart */
+	ulong seq;
+
+	byte ref;
 } yod_htable_v;
 
 
-/* yod_htable_t */
-struct _yod_htable_t
+/* yod_htable_b */
+typedef struct _yod_htable_b
 {
-	pthread_mutex_t lock;
-
 	ulong mask;
-
 	ulong size;
-	ulong count;
+	ulong slot;
 
-	ulong is_ref;
+	yod_htable_v *nodes[1];
+} yod_htable_b;
+
+
+/* yod_htable_s */
+typedef struct _yod_htable_s
+{
+	pthread_mutex_t lock;
+
+	ulong count;
+	ulong stamp;
+	ulong bytes;
+	ulong seq;
 
-	yod_htable_v **nodes;
+	yod_htable_b *buckets;
 	yod_htable_v *head;
 	yod_htable_v *tail;
-	yod_htable_v *curr;
+	yod_htable_v *hand;
 
-	void (*vfree) (void * __ENV_CPARM);
-};
+	struct
+	{
+		yod_htable_b *buckets;
+		ulong index;
+	} rehash;
 
+	/* keep the next shard's lock off this cache line */
+	byte padding[64];
+} yod_htable_s;
 
-static int _yod_htable_resize(yod_htable_t *self __ENV_CPARM);
-static ulong _yod_htable_str_nkey(const char *str_key, size_t key_len);
 
+/* yod_htable_h, snapshot header, offsets from the start of the file */
+typedef struct _yod_htable_h
+{
+	char magic[8];
+	uint64_t seed;
+	uint64_t count;
+	uint64_t mask;
+	uint64_t index;
+	uint64_t entry;
+	uint64_t size;
+	uint32_t order;
+	uint32_t word;
+} yod_htable_h;
+
+
+/* yod_htable_e, snapshot entry */
+typedef struct _yod_htable_e
+{
+	uint64_t num_key;
+	uint64_t key_off;
+	uint64_t val_off;
+	uint32_t key_len;
+	uint32_t val_len;
+} yod_htable_e;
 
-/** {{{ yod_htable_t *_yod_htable_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM)
-*/
-yod_htable_t *_yod_htable_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM)
+
+/* yod_htable_w, snapshot entry being written */
+typedef struct _yod_htable_w
 {
-	yod_htable_t *self = NULL;
+	yod_htable_v *node;
+	size_t len;
+	uint64_t key_off;
+	uint64_t val_off;
+} yod_htable_w;
 
-	self = (yod_htable_t *) malloc(sizeof(yod_htable_t) + 1);
-	if (!self) {
-		YOD_STDLOG_ERROR("malloc failed");
-		return NULL;
-	}
 
-	if (pthread_mutex_init(&self->lock, NULL) != 0) {
-		free(self);
+/* yod_htable_snap_t */
+struct _yod_htable_snap_t
+{
+	byte *base;
+	size_t size;
 
-		YOD_STDLOG_ERROR("pthread_mutex_init failed");
-		return NULL;
-	}
+	const yod_htable_h *head;
+	const uint64_t *index;
+	const yod_htable_e *entry;
+
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE map;
+#endif
+};
 
+
+/* yod_htable_t */
+struct _yod_htable_t
+{
+	pthread_mutex_t lock;
+
+	ulong is_ref;
+
+	uint64_t seed;
+
+	ulong shard_mask;
+	yod_htable_s *shards;
+
+	yod_htable_i curr;
+
+	yod_epoch_t *epoch;
+
+	/* per shard bounds, 0 is unbounded */
+	struct
 	{
-		self->size = 1 << 3;
-		self->mask = self->size - 1;
-		self->count = 0;
+		ulong count;
+		ulong bytes;
+	} cache;
 
-		self->is_ref = 0;
-		self->nodes = NULL;
-		self->head = NULL;
-		self->tail = NULL;
-		self->curr = NULL;
-		self->vfree = vfree;
-	}
+	void (*vfree) (void * __ENV_CPARM);
+};
 
-	self->nodes = calloc(self->size, sizeof(yod_htable_v *));
-	if (self->nodes == NULL) {
-		yod_htable_free(self);
 
-		YOD_STDLOG_ERROR("calloc failed");
-		return NULL;
-	}
+#define yod_htable_shard_lock(s) 								pthread_mutex_lock(&(s)->lock)
+#define yod_htable_shard_unlock(s) 								pthread_mutex_unlock(&(s)->lock)
+
+/* skip the store when set, hits on hot entries stay read-only */
+#define yod_htable_touch(n) 									((void) (__ATM_LOAD(&(n)->ref) || (__ATM_STORE(&(n)->ref, 1), 0)))
+
+
+static yod_htable_t *_yod_htable_create(void (*vfree) (void * __ENV_CPARM), ulong shard_num, int epoch __ENV_CPARM);
+static yod_htable_s *_yod_htable_shard(yod_htable_t *self, ulong num_key);
+static ulong _yod_htable_resolve(yod_htable_s *shard, yod_htable_s **shards, const ulong *idx, ulong m, const yod_htable_k *keys, const ulong *hash, void **values);
+static void *_yod_htable_iter(yod_htable_i *iter, long i, int forward, ulong *num_key, char **str_key, size_t *key_len);
+static int _yod_htable_exists(yod_htable_s *shard, yod_htable_v *node, ulong num_key, ulong seq);
+static void _yod_htable_clear(yod_htable_t *self, yod_htable_v *node __ENV_CPARM);
+static void _yod_htable_unlink(yod_htable_t *self, yod_htable_s *shard, yod_htable_v **bucket, yod_htable_v *node __ENV_CPARM);
+static void _yod_htable_evict(yod_htable_t *self, yod_htable_s *shard, yod_htable_v *keep __ENV_CPARM);
+static int _yod_htable_expired(yod_htable_v *node, uint64_t *now);
+static yod_htable_b *_yod_htable_alloc(ulong size, ulong slot __ENV_CPARM);
+static yod_htable_v **_yod_htable_bucket(yod_htable_s *shard, ulong num_key);
+static int _yod_htable_resize(yod_htable_t *self, yod_htable_s *shard, ulong size __ENV_CPARM);
+static int _yod_htable_publish(yod_htable_t *self, yod_htable_s *shard, ulong size __ENV_CPARM);
+static void _yod_htable_rehash(yod_htable_s *shard, ulong step __ENV_CPARM);
+static void _yod_htable_retire_node(void *ptr, void *arg __ENV_CPARM);
+static void _yod_htable_retire_list(void *ptr, void *arg __ENV_CPARM);
+static void _yod_htable_retire_value(void *ptr, void *arg __ENV_CPARM);
+static void _yod_htable_retire_buckets(void *ptr, void *arg __ENV_CPARM);
+static int _yod_htable_snap_blob(FILE *fp, const void *data, size_t len, int term);
+static int _yod_htable_snap_seek(FILE *fp, uint64_t off);
+static void _yod_htable_seed_init(void);
+static uint64_t _yod_htable_seed(yod_htable_t *self);
+static uint64_t _yod_htable_r64(const byte *p);
+static uint64_t _yod_htable_r32(const byte *p);
+static uint64_t _yod_htable_mum(uint64_t a, uint64_t b);
+static uint64_t _yod_htable_hash_long(uint64_t seed, const byte *p, size_t len);
+#if YOD_HTABLE_HASH_AVX2
+static uint64_t _yod_htable_hash_avx2(uint64_t seed, const byte *p, size_t len);
+#endif
+static ulong _yod_htable_str_nkey(uint64_t seed, const char *str_key, size_t key_len);
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_HTABLE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p): %p in %s:%d %s",
-		__FUNCTION__, vfree, self, __ENV_TRACE);
-#else
-	__ENV_VOID
+
+/* yod_htable_seed__ */
+static pthread_once_t yod_htable_once__ = PTHREAD_ONCE_INIT;
+static uint64_t yod_htable_seed__ = 0;
+static uint64_t yod_htable_count__ = 0;
+#if YOD_HTABLE_HASH_AVX2
+static int yod_htable_avx2__ = 0;
 #endif
 
-	return self;
+
+/** {{{ yod_htable_t *_yod_htable_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM)
+*/
+yod_htable_t *_yod_htable_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM)
+{
+	return _yod_htable_create(vfree, 1, 0 __ENV_CARGS);
+}
+/* }}} */
+
+
+/** {{{ yod_htable_t *_yod_htable_new_shard(void (*vfree) (void * __ENV_CPARM), ulong shard_num __ENV_CPARM)
+*/
+yod_htable_t *_yod_htable_new_shard(void (*vfree) (void * __ENV_CPARM), ulong shard_num __ENV_CPARM)
+{
+	return _yod_htable_create(vfree, shard_num, 0 __ENV_CARGS);
+}
+/* }}} */
+
+
+/** {{{ yod_htable_t *_yod_htable_new_epoch(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM)
+*/
+yod_htable_t *_yod_htable_new_epoch(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM)
+{
+	return _yod_htable_create(vfree, 1, 1 __ENV_CARGS);
 }
 /* }}} */
 
@@ -108,12 +264,15 @@ yod_htable_t *_yod_htable_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM)
 */
 void _yod_htable_free(yod_htable_t *self __ENV_CPARM)
 {
-	yod_htable_v *node = NULL;
-	yod_htable_v *temp = NULL;
+	yod_htable_s *shard = NULL;
+	ulong n = 0;
 #if (_YOD_HTABLE_DEBUG & 0x02)
+	yod_htable_v *node = NULL;
 	ulong *ht_nodes = NULL;
+	ulong ht_chain[17] = {0};
 	ulong ht_count = 0;
 	ulong ht_size = 0;
+	ulong ht_max = 0;
 	ulong k = 0;
 	ulong i = 0;
 #endif
@@ -124,7 +283,7 @@ void _yod_htable_free(yod_htable_t *self __ENV_CPARM)
 
 #if (_YOD_SYSTEM_DEBUG && _YOD_HTABLE_DEBUG)
 	yod_stdlog_debug(NULL, "%s(%p): {is_ref=%d, count=%lu} in %s:%d %s",
-		__FUNCTION__, self, self->is_ref, self->count, __ENV_TRACE);
+		__FUNCTION__, self, self->is_ref, yod_htable_count(self), __ENV_TRACE);
 #else
 	__ENV_VOID
 #endif
@@ -137,32 +296,46 @@ void _yod_htable_free(yod_htable_t *self __ENV_CPARM)
 	}
 
 #if (_YOD_HTABLE_DEBUG & 0x02)
-	if (self->count > 0) {
-		ht_nodes = (ulong *) calloc(self->size, sizeof(ulong));
-		ht_count = self->count;
-		ht_size = self->size;
+	for (n = 0; n <= self->shard_mask; ++n) {
+		ht_count += self->shards[n].count;
+		ht_size += self->shards[n].buckets->size;
+	}
+	if (ht_count > 0) {
+		ht_nodes = (ulong *) calloc(ht_size, sizeof(ulong));
 	}
+	for (n = 0, k = 0; ht_nodes && n <= self->shard_mask; ++n) {
+		shard = &self->shards[n];
+		for (node = shard->head; node != NULL; node = node->next) {
+			++ ht_nodes[k + (node->num_key & shard->buckets->mask)];
+		}
+		k += shard->buckets->size;
+	}
+	k = 0;
 #endif
 
-	/* nodes */
-	for (node = self->head; node != NULL;) {
-#if (_YOD_HTABLE_DEBUG & 0x02)
-		++ ht_nodes[node->num_key & self->mask];
-#endif
-		temp = node->next;
-		node->num_key = 0;
-		if (node->str_key) {
-			free(node->str_key);
+	/* shards */
+	for (n = 0; n <= self->shard_mask; ++n) {
+		shard = &self->shards[n];
+		if (!shard->buckets) {
+			break;
 		}
-		node->key_len = 0;
-		if (self->vfree) {
-			self->vfree(node->value __ENV_CARGS);
+
+		yod_htable_shard_lock(shard);
+		_yod_htable_clear(self, shard->head __ENV_CARGS);
+		free(shard->buckets);
+		if (shard->rehash.buckets) {
+			free(shard->rehash.buckets);
 		}
-		free(node);
-		node = temp;
+		yod_htable_shard_unlock(shard);
+		pthread_mutex_destroy(&shard->lock);
+	}
+
+	/* whatever the readers still held */
+	if (self->epoch) {
+		yod_epoch_free(self->epoch);
 	}
 
-	free(self->nodes);
+	free(self->shards);
 
 	pthread_mutex_unlock(&self->lock);
 	pthread_mutex_destroy(&self->lock);
@@ -189,7 +362,24 @@ void _yod_htable_free(yod_htable_t *self __ENV_CPARM)
 		}
 		yod_stdlog_dump(NULL,
 			"\n----------------------------------------------------------------\n");
-		
+
+		/* chain lengths */
+		for (i = 0; i < ht_size; ++i) {
+			++ ht_chain[ht_nodes[i] < 16 ? ht_nodes[i] : 16];
+			if (ht_nodes[i] > ht_max) {
+				ht_max = ht_nodes[i];
+			}
+		}
+		for (i = 0; i < 17; ++i) {
+			if (ht_chain[i] > 0) {
+				yod_stdlog_dump(NULL, "<%d%s> => %d\n", i, (i < 16 ? "" : "+"), ht_chain[i]);
+			}
+		}
+		yod_stdlog_dump(NULL,
+			"max = %d, avg = %.2f\n"
+			"----------------------------------------------------------------\n",
+			ht_max, (double) ht_count / (ht_size - ht_chain[0]));
+
 		if (ht_nodes) {
 			free(ht_nodes);
 		}
@@ -227,7 +417,9 @@ yod_htable_t *_yod_htable_ref(yod_htable_t *self __ENV_CPARM)
 */
 int _yod_htable_reset(yod_htable_t *self __ENV_CPARM)
 {
-	yod_htable_v *node, *temp;
+	yod_htable_s *shard = NULL;
+	yod_htable_b *buckets = NULL;
+	ulong n = 0;
 
 	if (!self) {
 		return (-1);
@@ -235,30 +427,41 @@ int _yod_htable_reset(yod_htable_t *self __ENV_CPARM)
 
 	pthread_mutex_lock(&self->lock);
 
-	self->count = 0;
-	self->head = NULL;
-	self->tail = NULL;
-	self->curr = NULL;
+	self->curr.node = NULL;
 
-	/* nodes */
-	memset(self->nodes, 0, self->size * sizeof(yod_htable_v *));
-	for (node = self->head; node != NULL;) {
-		temp = node->next;
-		node->num_key = 0;
-		if (node->str_key) {
-			free(node->str_key);
-			node->str_key = NULL;
-		}
-		node->key_len = 0;
-		if (self->vfree) {
-			self->vfree(node->value __ENV_CARGS);
-			node->value = NULL;
+	for (n = 0; n <= self->shard_mask; ++n) {
+		shard = &self->shards[n];
+
+		yod_htable_shard_lock(shard);
+		if (self->epoch) {
+			/* readers may still walk the old chains */
+			buckets = _yod_htable_alloc(shard->buckets->size, shard->buckets->slot __ENV_CARGS);
+			if (!buckets) {
+				yod_htable_shard_unlock(shard);
+				pthread_mutex_unlock(&self->lock);
+				return (-1);
+			}
+			yod_epoch_retire(self->epoch, shard->buckets, _yod_htable_retire_buckets, self);
+			if (shard->head) {
+				yod_epoch_retire(self->epoch, shard->head, _yod_htable_retire_list, self);
+			}
+			__ATM_STORE(&shard->buckets, buckets);
+		} else {
+			_yod_htable_clear(self, shard->head __ENV_CARGS);
+			if (shard->rehash.buckets) {
+				free(shard->rehash.buckets);
+				shard->rehash.buckets = NULL;
+				shard->rehash.index = 0;
+			}
+			memset(shard->buckets->nodes, 0, shard->buckets->size * sizeof(yod_htable_v *));
 		}
-		node->next = NULL;
-		node->prev = NULL;
-		node->v_next = NULL;
-		free(node);
-		node = temp;
+		shard->count = 0;
+		++ shard->stamp;
+		shard->bytes = 0;
+		shard->head = NULL;
+		shard->tail = NULL;
+		shard->hand = NULL;
+		yod_htable_shard_unlock(shard);
 	}
 
 	pthread_mutex_unlock(&self->lock);
@@ -276,52 +479,113 @@ int _yod_htable_reset(yod_htable_t *self __ENV_CPARM)
 /* }}} */
 
 
+/** {{{ int _yod_htable_cache(yod_htable_t *self, ulong max_count, ulong max_bytes __ENV_CPARM)
+*/
+int _yod_htable_cache(yod_htable_t *self, ulong max_count, ulong max_bytes __ENV_CPARM)
+{
+	yod_htable_s *shard = NULL;
+	ulong n = 0;
+
+	if (!self) {
+		return (-1);
+	}
+
+	/* the bounds are split evenly across the shards */
+	pthread_mutex_lock(&self->lock);
+	self->cache.count = (max_count + self->shard_mask) / (self->shard_mask + 1);
+	self->cache.bytes = (max_bytes + self->shard_mask) / (self->shard_mask + 1);
+
+	for (n = 0; n <= self->shard_mask; ++n) {
+		shard = &self->shards[n];
+
+		yod_htable_shard_lock(shard);
+		_yod_htable_evict(self, shard, NULL __ENV_CARGS);
+		yod_htable_shard_unlock(shard);
+	}
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_HTABLE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu, %lu) in %s:%d %s",
+		__FUNCTION__, self, max_count, max_bytes, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (0);
+}
+/* }}} */
+
+
 /** {{{ int _yod_htable_add(yod_htable_t *self, ulong num_key, const char *str_key, size_t key_len, void *value, int force  __ENV_CPARM)
 */
 int _yod_htable_add(yod_htable_t *self, ulong num_key, const char *str_key, size_t key_len, void *value, int force __ENV_CPARM)
 {
+	return _yod_htable_add_ttl(self, num_key, str_key, key_len, value, 0, 0, force __ENV_CARGS);
+}
+/* }}} */
+
+
+/** {{{ int _yod_htable_add_ttl(yod_htable_t *self, ulong num_key, const char *str_key, size_t key_len, void *value, size_t bytes, ulong ttl, int force __ENV_CPARM)
+*/
+int _yod_htable_add_ttl(yod_htable_t *self, ulong num_key, const char *str_key, size_t key_len, void *value, size_t bytes, ulong ttl, int force __ENV_CPARM)
+{
+	yod_htable_s *shard = NULL;
+	yod_htable_v **bucket = NULL;
 	yod_htable_v *node = NULL;
-	ulong k = 0;
+	ulong s = 0;
 
 	if (!self) {
 		return (-1);
 	}
 
 #if (_YOD_SYSTEM_DEBUG && _YOD_HTABLE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %lu, %s, %d, %p) in %s:%d %s",
-		__FUNCTION__, self, num_key, str_key, key_len, value, __ENV_TRACE);
+	yod_stdlog_debug(NULL, "%s(%p, %lu, %s, %d, %p, %lu, %lu) in %s:%d %s",
+		__FUNCTION__, self, num_key, str_key, key_len, value, (ulong) bytes, ttl, __ENV_TRACE);
 #else
 	__ENV_VOID
 #endif
 
-	pthread_mutex_lock(&self->lock);
+	if (key_len > 0) {
+		num_key = _yod_htable_str_nkey(self->seed, str_key, key_len);
+	}
+
+	shard = _yod_htable_shard(self, num_key);
 
-	if (self->count >= self->size) {
-		_yod_htable_resize(self __ENV_CARGS);
+	yod_htable_shard_lock(shard);
+
+	if (shard->rehash.buckets) {
+		_yod_htable_rehash(shard, YOD_HTABLE_REHASH_STEP __ENV_CARGS);
 	}
 
-	if (key_len > 0) {
-		num_key = _yod_htable_str_nkey(str_key, key_len);
+	if (shard->count >= shard->buckets->size) {
+		_yod_htable_resize(self, shard, shard->buckets->size << 1 __ENV_CARGS);
 	}
 
-	k = num_key & self->mask;
+	bucket = _yod_htable_bucket(shard, num_key);
+	s = shard->buckets->slot;
 
-	for (node = self->nodes[k]; node != NULL; node = node->v_next) {
+	for (node = *bucket; node != NULL; node = node->v_next[s]) {
 		if ((node->num_key == num_key) && (node->key_len == key_len) && (memcmp(node->str_key, str_key, key_len) == 0)) {
 			if (force) {
-				if (self->vfree) {
+				if (self->vfree && self->epoch) {
+					yod_epoch_retire(self->epoch, node->value, _yod_htable_retire_value, self);
+				} else if (self->vfree) {
 					self->vfree(node->value __ENV_CARGS);
 				}
-				node->value = value;
+				__ATM_STORE(&node->value, value);
+				shard->bytes += bytes - node->bytes;
+				node->bytes = bytes;
+				__ATM_STORE(&node->expire, ttl ? (yod_common_nowtime() + ttl) : 0);
+				_yod_htable_evict(self, shard, node __ENV_CARGS);
 			}
-			pthread_mutex_unlock(&self->lock);
+			yod_htable_shard_unlock(shard);
 			return (force ? 0 : (-1));
 		}
 	}
 
 	node = (yod_htable_v *) malloc(sizeof(yod_htable_v));
 	if (node == NULL) {
-		pthread_mutex_unlock(&self->lock);
+		yod_htable_shard_unlock(shard);
 
 		YOD_STDLOG_ERROR("malloc failed");
 		return (-1);
@@ -338,26 +602,37 @@ int _yod_htable_add(yod_htable_t *self, ulong num_key, const char *str_key, size
 		}
 		node->key_len = key_len;
 		node->value = value;
+		node->bytes = bytes;
+		node->expire = ttl ? (yod_common_nowtime() + ttl) : 0;
+		node->ref = 0;
+		node->seq = ++ shard->seq;
 		node->next = NULL;
-		node->prev = self->tail;
-		node->v_next = self->nodes[k];
+		node->prev = shard->tail;
+		node->v_next[s] = *bucket;
+		node->v_next[s ^ 1] = NULL;
 		node->v_prev = NULL;
-		if (node->v_next) {
-			node->v_next->v_prev = node;
+		if (node->v_next[s]) {
+			node->v_next[s]->v_prev = node;
 		}
 
-		self->nodes[k] = node;
+		/* readers see the node complete or not at all */
+		__ATM_STORE(bucket, node);
 
-		if (self->tail) {
-			self->tail->next = node;
+		if (shard->tail) {
+			shard->tail->next = node;
 		}
-		self->tail = node;
+		shard->tail = node;
 
-		if (!self->head) {
-			self->head = node;
+		if (!shard->head) {
+			shard->head = node;
 		}
 
-		self->count++;
+		shard->count++;
+		shard->bytes += bytes;
+	}
+
+	if (self->cache.count || self->cache.bytes) {
+		_yod_htable_evict(self, shard, node __ENV_CARGS);
 	}
 
 #if (_YOD_HTABLE_DEBUG & 0x02)
@@ -366,16 +641,16 @@ int _yod_htable_add(yod_htable_t *self, ulong num_key, const char *str_key, size
 			"----------------------------------------------------------------\n"
 			"%d / %d\n"
 			"----------------------------------------------------------------\n",
-			self->count, self->size);
+			shard->count, shard->buckets->size);
 
-		for (node = self->head; node != NULL; node = node->next) {
+		for (node = shard->head; node != NULL; node = node->next) {
 			yod_stdlog_dump(NULL,
 				"[%04ld] => %p: "
 				"{num_key=%lu, str_key=%s, key_len=%d, value=%p, "
 				"next=%p, prev=%p, v_next=%p, v_prev=%p}\n",
-				(ulong) (node->num_key & self->mask),
+				(ulong) (node->num_key & shard->buckets->mask),
 				node, node->num_key, node->str_key, node->key_len, node->value,
-				node->next, node->prev, node->v_next, node->v_prev);
+				node->next, node->prev, node->v_next[s], node->v_prev);
 		}
 
 		yod_stdlog_dump(NULL,
@@ -383,7 +658,7 @@ int _yod_htable_add(yod_htable_t *self, ulong num_key, const char *str_key, size
 	}
 #endif
 
-	pthread_mutex_unlock(&self->lock);
+	yod_htable_shard_unlock(shard);
 
 	return (0);
 }
@@ -394,8 +669,11 @@ int _yod_htable_add(yod_htable_t *self, ulong num_key, const char *str_key, size
 */
 int _yod_htable_del(yod_htable_t *self, ulong num_key, const char *str_key, size_t key_len __ENV_CPARM)
 {
+	yod_htable_s *shard = NULL;
+	yod_htable_v **bucket = NULL;
 	yod_htable_v *node = NULL;
-	ulong k = 0;
+	ulong size = 0;
+	ulong s = 0;
 
 	if (!self) {
 		return (-1);
@@ -409,83 +687,55 @@ int _yod_htable_del(yod_htable_t *self, ulong num_key, const char *str_key, size
 #endif
 
 	if (key_len > 0) {
-		num_key = _yod_htable_str_nkey(str_key, key_len);
+		num_key = _yod_htable_str_nkey(self->seed, str_key, key_len);
 	}
 
-	pthread_mutex_lock(&self->lock);
-
-	k = num_key & self->mask;
-
-	for (node = self->nodes[k]; node != NULL; node = node->v_next) {
-		if ((node->num_key == num_key) && (node->key_len == key_len) && (memcmp(node->str_key, str_key, key_len) == 0)) {
-			/* tail node */
-			if (!node->next) {
-				self->tail = node->prev;
-				if (self->tail) {
-					self->tail->next = NULL;
-				}
-			} else {
-				node->next->prev = node->prev;
-			}
-			
-			/* head node */
-			if (!node->prev) {
-				self->head = node->next;
-				if (self->head) {
-					self->head->prev = NULL;
-				}
-			} else {
-				node->prev->next = node->next;
-			}
-			
-			if (node->v_next) {
-				node->v_next->v_prev = node->v_prev;
-			}
+	shard = _yod_htable_shard(self, num_key);
 
-			if (!node->v_prev) {
-				self->nodes[k] = node->v_next;
-			} else {
-				node->v_prev->v_next = node->v_next;
-			}
+	yod_htable_shard_lock(shard);
 
-			if (node->str_key) {
-				free(node->str_key);
-			}
+	if (shard->rehash.buckets) {
+		_yod_htable_rehash(shard, YOD_HTABLE_REHASH_STEP __ENV_CARGS);
+	}
 
-			if (self->vfree) {
-				self->vfree(node->value __ENV_CARGS);
-			}
-			free(node);
+	bucket = _yod_htable_bucket(shard, num_key);
+	s = shard->buckets->slot;
 
-			self->count--;
+	for (node = *bucket; node != NULL; node = node->v_next[s]) {
+		if ((node->num_key == num_key) && (node->key_len == key_len) && (memcmp(node->str_key, str_key, key_len) == 0)) {
+			_yod_htable_unlink(self, shard, bucket, node __ENV_CARGS);
 			break;
 		}
 	}
 
-#if (_YOD_HTABLE_DEBUG & 0x02)
-	if (force != 0) {
-		yod_stdlog_dump(NULL,
-			"----------------------------------------------------------------\n"
-			"%d / %d\n"
-			"----------------------------------------------------------------\n",
-			self->count, self->size);
+	/* shrink */
+	if (!shard->rehash.buckets && (shard->buckets->size > YOD_HTABLE_MIN_SIZE) && (shard->count < (shard->buckets->size >> 3))) {
+		for (size = YOD_HTABLE_MIN_SIZE; size < (shard->count << 1); size <<= 1);
+		_yod_htable_resize(self, shard, size __ENV_CARGS);
+	}
 
-		for (node = self->head; node != NULL; node = node->next) {
-			yod_stdlog_dump(NULL,
-				"[%04ld] => %p: "
-				"{num_key=%lu, str_key=%s, key_len=%d, value=%p, "
-				"next=%p, prev=%p, v_next=%p, v_prev=%p}\n",
-				(ulong) (node->num_key & self->mask),
-				node, node->num_key, node->str_key, node->key_len, node->value,
-				node->next, node->prev, node->v_next, node->v_prev);
-		}
+#if (_YOD_HTABLE_DEBUG & 0x02)
+	yod_stdlog_dump(NULL,
+		"----------------------------------------------------------------\n"
+		"%d / %d\n"
+		"----------------------------------------------------------------\n",
+		shard->count, shard->buckets->size);
 
+	for (node = shard->head; node != NULL; node = node->next) {
 		yod_stdlog_dump(NULL,
-			"\n----------------------------------------------------------------\n");
+			"[%04ld] => %p: "
+			"{num_key=%lu, str_key=%s, key_len=%d, value=%p, "
+			"next=%p, prev=%p, v_next=%p, v_prev=%p}\n",
+			(ulong) (node->num_key & shard->buckets->mask),
+			node, node->num_key, node->str_key, node->key_len, node->value,
+			node->next, node->prev, node->v_next[s], node->v_prev);
 	}
+
+	yod_stdlog_dump(NULL,
+		"\n----------------------------------------------------------------\n");
 #endif
 
-	pthread_mutex_unlock(&self->lock);
+	yod_htable_shard_unlock(shard);
 
 	return (0);
 }
@@ -496,9 +746,12 @@ int _yod_htable_del(yod_htable_t *self, ulong num_key, const char *str_key, size
 */
 void *_yod_htable_find(yod_htable_t *self, ulong num_key, const char *str_key, size_t key_len __ENV_CPARM)
 {
+	yod_htable_s *shard = NULL;
+	yod_htable_b *buckets = NULL;
 	yod_htable_v *node = NULL;
 	void *value = NULL;
-	ulong k;
+	uint64_t now = 0;
+	ulong s = 0;
 
 #if (_YOD_SYSTEM_DEBUG && _YOD_HTABLE_DEBUG)
 	yod_stdlog_debug(NULL, "%s(%p, %lu, %s, %d) in %s:%d %s",
@@ -512,16 +765,47 @@ void *_yod_htable_find(yod_htable_t *self, ulong num_key, const char *str_key, s
 	}
 
 	if (key_len > 0) {
-		num_key = _yod_htable_str_nkey(str_key, key_len);
+		num_key = _yod_htable_str_nkey(self->seed, str_key, key_len);
 	}
 
-	pthread_mutex_lock(&self->lock);
+	shard = _yod_htable_shard(self, num_key);
+
+	/* lock-free readers */
+	if (self->epoch) {
+		yod_epoch_enter(self->epoch);
+		buckets = __ATM_LOAD(&shard->buckets);
+		s = buckets->slot;
+		for (node = __ATM_LOAD(&buckets->nodes[num_key & buckets->mask]); node != NULL; node = __ATM_LOAD(&node->v_next[s])) {
+			if ((node->num_key == num_key) && (node->key_len == key_len) && (memcmp(node->str_key, str_key, key_len) == 0)) {
+				/* expired entries are left to the next writer */
+				if (!_yod_htable_expired(node, &now)) {
+					value = __ATM_LOAD(&node->value);
+					yod_htable_touch(node);
+				}
+				break;
+			}
+		}
+		yod_epoch_leave(self->epoch);
+
+		return value;
+	}
+
+	yod_htable_shard_lock(shard);
 
-	k = num_key & self->mask;
+	if (shard->rehash.buckets) {
+		_yod_htable_rehash(shard, YOD_HTABLE_REHASH_STEP __ENV_CARGS);
+	}
+
+	s = shard->buckets->slot;
 
-	for (node = self->nodes[k]; node != NULL; node = node->v_next) {
+	for (node = *_yod_htable_bucket(shard, num_key); node != NULL; node = node->v_next[s]) {
 		if ((node->num_key == num_key) && (node->key_len == key_len) && (memcmp(node->str_key, str_key, key_len) == 0)) {
-			value = node->value;
+			if (_yod_htable_expired(node, &now)) {
+				_yod_htable_unlink(self, shard, NULL, node __ENV_CARGS);
+			} else {
+				value = node->value;
+				yod_htable_touch(node);
+			}
 			break;
 		}
 	}
@@ -531,45 +815,126 @@ void *_yod_htable_find(yod_htable_t *self, ulong num_key, const char *str_key, s
 		"----------------------------------------------------------------\n"
 		"%d / %d\n"
 		"----------------------------------------------------------------\n",
-		self->count, self->size);
+		shard->count, shard->buckets->size);
 
-	for (node = self->head; node != NULL; node = node->next) {
+	for (node = shard->head; node != NULL; node = node->next) {
 		yod_stdlog_dump(NULL,
 			"[%04ld] => %p: "
 			"{num_key=%lu, str_key=%s, key_len=%d, value=%p, "
 			"next=%p, prev=%p, v_next=%p, v_prev=%p}\n",
-			(ulong) (node->num_key & self->mask),
+			(ulong) (node->num_key & shard->buckets->mask),
 			node, node->num_key, node->str_key, node->key_len, node->value,
-			node->next, node->prev, node->v_next, node->v_prev);
+			node->next, node->prev, node->v_next[s], node->v_prev);
 	}
 
 	yod_stdlog_dump(NULL,
 		"\n----------------------------------------------------------------\n");
 #endif
 
-	pthread_mutex_unlock(&self->lock);
+	yod_htable_shard_unlock(shard);
 
 	return value;
 }
 /* }}} */
 
 
+/** {{{ ulong _yod_htable_find_many(yod_htable_t *self, const yod_htable_k *keys, ulong n, void **values __ENV_CPARM)
+*/
+ulong _yod_htable_find_many(yod_htable_t *self, const yod_htable_k *keys, ulong n, void **values __ENV_CPARM)
+{
+	yod_htable_s *shards[YOD_HTABLE_BATCH];
+	yod_htable_s *shard = NULL;
+	ulong hash[YOD_HTABLE_BATCH];
+	ulong idx[YOD_HTABLE_BATCH];
+	ulong count = 0;
+	ulong m = 0;
+	ulong i = 0;
+	ulong j = 0;
+	ulong k = 0;
+
+	if (!self || !keys || !values) {
+		return 0;
+	}
+
+	for (; n > 0; keys += m, values += m, n -= m) {
+		m = (n < YOD_HTABLE_BATCH) ? n : YOD_HTABLE_BATCH;
+
+		/* hash the whole batch before touching any bucket */
+		for (i = 0; i < m; ++i) {
+			hash[i] = keys[i].num_key;
+			if (keys[i].key_len > 0) {
+				hash[i] = _yod_htable_str_nkey(self->seed, keys[i].str_key, keys[i].key_len);
+			}
+			shards[i] = _yod_htable_shard(self, hash[i]);
+			values[i] = NULL;
+			idx[i] = i;
+		}
+
+		if (self->epoch) {
+			yod_epoch_enter(self->epoch);
+			count += _yod_htable_resolve(NULL, shards, idx, m, keys, hash, values);
+			yod_epoch_leave(self->epoch);
+			continue;
+		}
+
+		/* one lock per shard, grouped keys drop out of shards[] */
+		for (i = 0; i < m; ++i) {
+			shard = shards[i];
+			if (!shard) {
+				continue;
+			}
+			for (j = i, k = 0; j < m; ++j) {
+				if (shards[j] == shard) {
+					shards[j] = NULL;
+					idx[k ++] = j;
+				}
+			}
+
+			yod_htable_shard_lock(shard);
+			if (shard->rehash.buckets) {
+				_yod_htable_rehash(shard, YOD_HTABLE_REHASH_STEP __ENV_CARGS);
+			}
+			count += _yod_htable_resolve(shard, NULL, idx, k, keys, hash, values);
+			yod_htable_shard_unlock(shard);
+		}
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_HTABLE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p, %p): %lu in %s:%d %s",
+		__FUNCTION__, self, keys, values, count, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return count;
+}
+/* }}} */
+
+
 /** {{{ ulong _yod_htable_count(yod_htable_t *self __ENV_CPARM)
 */
 ulong _yod_htable_count(yod_htable_t *self __ENV_CPARM)
 {
+	ulong count = 0;
+	ulong n = 0;
+
 	if (!self) {
 		return 0;
 	}
 
+	/* no locking, the sum is a snapshot */
+	for (n = 0; n <= self->shard_mask; ++n) {
+		count += self->shards[n].count;
+	}
+
 #if (_YOD_SYSTEM_DEBUG && (_YOD_HTABLE_DEBUG & 0x02))
 	yod_stdlog_debug(NULL, "%s(%p): %lu in %s:%d %s",
-		__FUNCTION__, self, self->count, __ENV_TRACE);
+		__FUNCTION__, self, count, __ENV_TRACE);
 #else
 	__ENV_VOID
 #endif
 
-	return self->count;
+	return count;
 }
 /* }}} */
 
@@ -585,19 +950,8 @@ void *_yod_htable_head(yod_htable_t *self, ulong *num_key, char **str_key, size_
 	}
 
 	pthread_mutex_lock(&self->lock);
-	if (self->head) {
-		self->curr = self->head;
-		if (num_key) {
-			*num_key = self->curr->num_key;
-		}
-		if (str_key) {
-			*str_key = self->curr->str_key;
-		}
-		if (key_len) {
-			*key_len = self->curr->key_len;
-		}
-		value = self->curr->value;
-	}
+	self->curr.node = NULL;
+	value = _yod_htable_iter(&self->curr, 0, 1, num_key, str_key, key_len);
 	pthread_mutex_unlock(&self->lock);
 
 #if (_YOD_SYSTEM_DEBUG && (_YOD_HTABLE_DEBUG & 0x02))
@@ -624,19 +978,8 @@ void *_yod_htable_tail(yod_htable_t *self, ulong *num_key, char **str_key, size_
 	}
 
 	pthread_mutex_lock(&self->lock);
-	if (self->tail) {
-		self->curr = self->tail;
-		if (num_key) {
-			*num_key = self->curr->num_key;
-		}
-		if (str_key) {
-			*str_key = self->curr->str_key;
-		}
-		if (key_len) {
-			*key_len = self->curr->key_len;
-		}
-		value = self->curr->value;
-	}
+	self->curr.node = NULL;
+	value = _yod_htable_iter(&self->curr, self->shard_mask, 0, num_key, str_key, key_len);
 	pthread_mutex_unlock(&self->lock);
 
 #if (_YOD_SYSTEM_DEBUG && (_YOD_HTABLE_DEBUG & 0x02))
@@ -663,18 +1006,8 @@ void *_yod_htable_next(yod_htable_t *self, ulong *num_key, char **str_key, size_
 	}
 
 	pthread_mutex_lock(&self->lock);
-	if (self->curr && self->curr->next) {
-		self->curr = self->curr->next;
-		if (num_key) {
-			*num_key = self->curr->num_key;
-		}
-		if (str_key) {
-			*str_key = self->curr->str_key;
-		}
-		if (key_len) {
-			*key_len = self->curr->key_len;
-		}
-		value = self->curr->value;
+	if (self->curr.node) {
+		value = _yod_htable_iter(&self->curr, 0, 1, num_key, str_key, key_len);
 	}
 	pthread_mutex_unlock(&self->lock);
 
@@ -702,18 +1035,8 @@ void *_yod_htable_prev(yod_htable_t *self, ulong *num_key, char **str_key, size_
 	}
 
 	pthread_mutex_lock(&self->lock);
-	if (self->curr && self->curr->prev) {
-		self->curr = self->curr->prev;
-		if (num_key) {
-			*num_key = self->curr->num_key;
-		}
-		if (str_key) {
-			*str_key = self->curr->str_key;
-		}
-		if (key_len) {
-			*key_len = self->curr->key_len;
-		}
-		value = self->curr->value;
+	if (self->curr.node) {
+		value = _yod_htable_iter(&self->curr, 0, 0, num_key, str_key, key_len);
 	}
 	pthread_mutex_unlock(&self->lock);
 
@@ -730,134 +1053,1496 @@ void *_yod_htable_prev(yod_htable_t *self, ulong *num_key, char **str_key, size_
 /* }}} */
 
 
-/** {{{ int _yod_htable_resize(yod_htable_t *self __ENV_CPARM)
+/** {{{ void *_yod_htable_iter_head(yod_htable_t *self, yod_htable_i *iter, ulong *num_key, char **str_key, size_t *key_len __ENV_CPARM)
+*/
+void *_yod_htable_iter_head(yod_htable_t *self, yod_htable_i *iter, ulong *num_key, char **str_key, size_t *key_len __ENV_CPARM)
+{
+	void *value = NULL;
+
+	if (!self || !iter) {
+		return NULL;
+	}
+
+	iter->table = self;
+	iter->node = NULL;
+	value = _yod_htable_iter(iter, 0, 1, num_key, str_key, key_len);
+
+#if (_YOD_SYSTEM_DEBUG && (_YOD_HTABLE_DEBUG & 0x02))
+	yod_stdlog_debug(NULL, "%s(%p, %p, %lu, %s, %d): %p in %s:%d %s",
+		__FUNCTION__, self, iter, (num_key ? *num_key : 0), (str_key ? *str_key : NULL),
+		(key_len ? *key_len : 0), value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_htable_iter_tail(yod_htable_t *self, yod_htable_i *iter, ulong *num_key, char **str_key, size_t *key_len __ENV_CPARM)
+*/
+void *_yod_htable_iter_tail(yod_htable_t *self, yod_htable_i *iter, ulong *num_key, char **str_key, size_t *key_len __ENV_CPARM)
+{
+	void *value = NULL;
+
+	if (!self || !iter) {
+		return NULL;
+	}
+
+	iter->table = self;
+	iter->node = NULL;
+	value = _yod_htable_iter(iter, self->shard_mask, 0, num_key, str_key, key_len);
+
+#if (_YOD_SYSTEM_DEBUG && (_YOD_HTABLE_DEBUG & 0x02))
+	yod_stdlog_debug(NULL, "%s(%p, %p, %lu, %s, %d): %p in %s:%d %s",
+		__FUNCTION__, self, iter, (num_key ? *num_key : 0), (str_key ? *str_key : NULL),
+		(key_len ? *key_len : 0), value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_htable_iter_next(yod_htable_i *iter, ulong *num_key, char **str_key, size_t *key_len __ENV_CPARM)
+*/
+void *_yod_htable_iter_next(yod_htable_i *iter, ulong *num_key, char **str_key, size_t *key_len __ENV_CPARM)
+{
+	void *value = NULL;
+
+	if (!iter || !iter->table || !iter->node) {
+		return NULL;
+	}
+
+	value = _yod_htable_iter(iter, 0, 1, num_key, str_key, key_len);
+
+#if (_YOD_SYSTEM_DEBUG && (_YOD_HTABLE_DEBUG & 0x02))
+	yod_stdlog_debug(NULL, "%s(%p, %lu, %s, %d): %p in %s:%d %s",
+		__FUNCTION__, iter, (num_key ? *num_key : 0), (str_key ? *str_key : NULL),
+		(key_len ? *key_len : 0), value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_htable_iter_prev(yod_htable_i *iter, ulong *num_key, char **str_key, size_t *key_len __ENV_CPARM)
+*/
+void *_yod_htable_iter_prev(yod_htable_i *iter, ulong *num_key, char **str_key, size_t *key_len __ENV_CPARM)
+{
+	void *value = NULL;
+
+	if (!iter || !iter->table || !iter->node) {
+		return NULL;
+	}
+
+	value = _yod_htable_iter(iter, 0, 0, num_key, str_key, key_len);
+
+#if (_YOD_SYSTEM_DEBUG && (_YOD_HTABLE_DEBUG & 0x02))
+	yod_stdlog_debug(NULL, "%s(%p, %lu, %s, %d): %p in %s:%d %s",
+		__FUNCTION__, iter, (num_key ? *num_key : 0), (str_key ? *str_key : NULL),
+		(key_len ? *key_len : 0), value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ int _yod_htable_visit(yod_htable_t *self, yod_htable_fn func, void *arg __ENV_CPARM)
 */
-static int _yod_htable_resize(yod_htable_t *self __ENV_CPARM)
+int _yod_htable_visit(yod_htable_t *self, yod_htable_fn func, void *arg __ENV_CPARM)
 {
-	yod_htable_v **nodes = NULL;
+	yod_htable_s *shard = NULL;
 	yod_htable_v *node = NULL;
-	ulong k = 0;
+	ulong n = 0;
+	int ret = 0;
 
-	if (!self) {
+	if (!self || !func) {
+		return (-1);
+	}
+
+	/* one lock per shard, func must not call back into the table */
+	for (n = 0; ret == 0 && n <= self->shard_mask; ++n) {
+		shard = &self->shards[n];
+
+		yod_htable_shard_lock(shard);
+		for (node = shard->head; ret == 0 && node != NULL; node = node->next) {
+			ret = func(node->num_key, node->str_key, node->key_len, node->value, arg __ENV_CARGS);
+		}
+		yod_htable_shard_unlock(shard);
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_HTABLE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p, %p): %d in %s:%d %s",
+		__FUNCTION__, self, func, arg, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ int _yod_htable_save(yod_htable_t *self, const char *file, yod_htable_enc func, void *arg __ENV_CPARM)
+*/
+int _yod_htable_save(yod_htable_t *self, const char *file, yod_htable_enc func, void *arg __ENV_CPARM)
+{
+	yod_htable_h head;
+	yod_htable_e entry;
+	yod_htable_w *list = NULL;
+	yod_htable_v *node = NULL;
+	const void *data = NULL;
+	uint64_t *index = NULL;
+	ulong *order = NULL;
+	uint64_t now = 0;
+	uint64_t off = 0;
+	ulong count = 0;
+	ulong size = 0;
+	ulong n = 0;
+	ulong i = 0;
+	char temp[_MAX_PATH + 8];
+	FILE *fp = NULL;
+	int ret = -1;
+
+	if (!self || !file || !func) {
 		return (-1);
 	}
 
-	if ((self->size << 1) <= 0) {
+	if (snprintf(temp, sizeof(temp), "%s.tmp", file) == -1) {
+		YOD_STDLOG_ERROR("snprintf failed");
 		return (-1);
 	}
 
-	if (self->count < self->size) {
-		return (0);
+	/* a consistent cut: every shard stays locked until the file is written */
+	pthread_mutex_lock(&self->lock);
+	for (n = 0; n <= self->shard_mask; ++n) {
+		yod_htable_shard_lock(&self->shards[n]);
+		count += self->shards[n].count;
 	}
 
-#if (_YOD_HTABLE_DEBUG & 0x02)
-	yod_stdlog_dump(NULL,
-		"----------------------------------------------------------------\n"
-		"%d / %d\n"
-		"----------------------------------------------------------------\n",
-		self->count, self->size);
+	for (size = 1; size < count; size <<= 1);
 
-	for (k = 0; k < self->size; ++k) {
-		for (node = self->nodes[k]; node != NULL; node = node->v_next) {
-			yod_stdlog_dump(NULL,
-				"[%04ld] => %p: "
-				"{num_key=%lu, str_key=%s, key_len=%d, value=%p, "
-				"next=%p, prev=%p, v_next=%p, v_prev=%p}\n",
-				(ulong) k, node,
-				node->num_key, node->str_key, node->key_len, node->value,
-				node->next, node->prev, node->v_next, node->v_prev);
+	list = (yod_htable_w *) malloc((count + 1) * sizeof(yod_htable_w));
+	order = (ulong *) malloc((count + 1) * sizeof(ulong));
+	index = (uint64_t *) calloc(size + 1, sizeof(uint64_t));
+	if (!list || !order || !index) {
+		YOD_STDLOG_ERROR("malloc failed");
+		goto e_failed;
+	}
+
+	/* count the entries per bucket */
+	for (n = 0, count = 0; n <= self->shard_mask; ++n) {
+		for (node = self->shards[n].head; node != NULL; node = node->next) {
+			if (_yod_htable_expired(node, &now)) {
+				continue;
+			}
+			list[count].node = node;
+			list[count].len = 0;
+			++ index[(node->num_key & (size - 1)) + 1];
+			++ count;
 		}
 	}
 
-	yod_stdlog_dump(NULL,
-		"\n----------------------------------------------------------------\n");
+	/* bucket b holds entries index[b] .. index[b + 1], a counting sort */
+	for (i = 1; i <= size; ++i) {
+		index[i] += index[i - 1];
+	}
+	for (i = count; i > 0; --i) {
+		order[-- index[(list[i - 1].node->num_key & (size - 1)) + 1]] = i - 1;
+	}
+	for (i = 0; i < size; ++i) {
+		index[i] = index[i + 1];
+	}
+	index[size] = count;
+
+#ifdef _WIN32
+	if (fopen_s(&fp, temp, "wb") != 0)
+#else
+	if ((fp = fopen(temp, "wb")) == NULL)
 #endif
+	{
+		YOD_STDLOG_ERROR("fopen failed");
+		goto e_failed;
+	}
 
-	nodes = realloc(self->nodes, (self->size << 1) * sizeof(yod_htable_v *));
-	if (!nodes) {
-		pthread_mutex_unlock(&self->lock);
+	memset(&head, 0, sizeof(head));
+	memcpy(head.magic, YOD_HTABLE_SNAP_MAGIC, sizeof(head.magic));
+	head.seed = self->seed;
+	head.count = count;
+	head.mask = size - 1;
+	head.index = sizeof(yod_htable_h);
+	head.entry = head.index + (size + 1) * sizeof(uint64_t);
+	head.order = YOD_HTABLE_SNAP_ORDER;
+	head.word = sizeof(ulong);
+
+	/* blobs follow the entries, each padded to 8 bytes; a value is
+	 * written as soon as it is encoded, the encoder may reuse its buffer */
+	off = head.entry + count * sizeof(yod_htable_e);
+	if (_yod_htable_snap_seek(fp, off) != 0) {
+		YOD_STDLOG_ERROR("fseek failed");
+		goto e_failed;
+	}
 
-		YOD_STDLOG_ERROR("realloc failed");
-		return (-1);
+	for (i = 0; i < count; ++i) {
+		data = func(list[i].node->value, &list[i].len, arg __ENV_CARGS);
+		if (!data) {
+			list[i].len = 0;
+		}
+		if (_yod_htable_snap_blob(fp, list[i].node->str_key, list[i].node->key_len, 1) != 0
+			|| _yod_htable_snap_blob(fp, data, list[i].len, 0) != 0) {
+			YOD_STDLOG_ERROR("fwrite failed");
+			goto e_failed;
+		}
+		list[i].key_off = off;
+		off += YOD_HTABLE_SNAP_ALIGN(list[i].node->key_len + 1);
+		list[i].val_off = off;
+		off += YOD_HTABLE_SNAP_ALIGN(list[i].len);
 	}
+	head.size = off;
 
-	self->size = (self->size << 1);
-	self->mask = (uint32_t) (self->size - 1);
-	self->nodes = nodes;
+	/* then the header, the index and the entries in front of them */
+	if (_yod_htable_snap_seek(fp, 0) != 0) {
+		YOD_STDLOG_ERROR("fseek failed");
+		goto e_failed;
+	}
 
-	memset(self->nodes, 0, self->size * sizeof(yod_htable_v *));
-	for (node = self->head; node != NULL; node = node->next) {
-		k = node->num_key & self->mask;
-		node->v_next = self->nodes[k];
-		node->v_prev = NULL;
-		if (node->v_next) {
-			node->v_next->v_prev = node;
+	if (fwrite(&head, sizeof(head), 1, fp) != 1 || fwrite(index, sizeof(uint64_t), size + 1, fp) != size + 1) {
+		YOD_STDLOG_ERROR("fwrite failed");
+		goto e_failed;
+	}
+
+	/* entries in bucket order */
+	for (n = 0; n < count; ++n) {
+		i = order[n];
+		entry.num_key = list[i].node->num_key;
+		entry.key_off = list[i].key_off;
+		entry.val_off = list[i].val_off;
+		entry.key_len = (uint32_t) list[i].node->key_len;
+		entry.val_len = (uint32_t) list[i].len;
+		if (fwrite(&entry, sizeof(entry), 1, fp) != 1) {
+			YOD_STDLOG_ERROR("fwrite failed");
+			goto e_failed;
 		}
-		self->nodes[k] = node;
 	}
 
-#if (_YOD_HTABLE_DEBUG & 0x02)
-	yod_stdlog_dump(NULL,
-		"----------------------------------------------------------------\n"
-		"%d / %d\n"
-		"----------------------------------------------------------------\n",
-		self->count, self->size);
+	if (fclose(fp) != 0) {
+		fp = NULL;
+		YOD_STDLOG_ERROR("fclose failed");
+		goto e_failed;
+	}
+	fp = NULL;
 
-	for (k = 0; k < self->size; ++k) {
-		for (node = self->nodes[k]; node != NULL; node = node->v_next) {
-			yod_stdlog_dump(NULL,
-				"[%04ld] => %p: "
-				"{num_key=%lu, str_key=%s, key_len=%d, value=%p, "
-				"next=%p, prev=%p, v_next=%p, v_prev=%p}\n",
-				(ulong) k, node,
-				node->num_key, node->str_key, node->key_len, node->value,
-				node->next, node->prev, node->v_next, node->v_prev);
+	/* readers mapping the old file keep it until they close */
+#ifdef _WIN32
+	if (!MoveFileExA(temp, file, MOVEFILE_REPLACE_EXISTING))
+#else
+	if (rename(temp, file) != 0)
+#endif
+	{
+		YOD_STDLOG_ERROR("rename failed");
+		goto e_failed;
+	}
+
+	ret = 0;
+
+e_failed:
+
+	if (fp) {
+		fclose(fp);
+	}
+	if (ret != 0) {
+		remove(temp);
+	}
+	for (n = self->shard_mask + 1; n > 0; --n) {
+		yod_htable_shard_unlock(&self->shards[n - 1]);
+	}
+	pthread_mutex_unlock(&self->lock);
+
+	if (list) {
+		free(list);
+	}
+	if (order) {
+		free(order);
+	}
+	if (index) {
+		free(index);
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_HTABLE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %s, %p, %p): {count=%lu} %d in %s:%d %s",
+		__FUNCTION__, self, file, func, arg, count, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ yod_htable_snap_t *_yod_htable_snap_open(const char *file __ENV_CPARM)
+*/
+yod_htable_snap_t *_yod_htable_snap_open(const char *file __ENV_CPARM)
+{
+	yod_htable_snap_t *self = NULL;
+	const yod_htable_h *head = NULL;
+#ifdef _WIN32
+	LARGE_INTEGER size;
+#else
+	struct stat st;
+	int fd = -1;
+#endif
+
+	if (!file) {
+		return NULL;
+	}
+
+	self = (yod_htable_snap_t *) malloc(sizeof(yod_htable_snap_t));
+	if (!self) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
+	}
+	self->base = NULL;
+	self->size = 0;
+
+#ifdef _WIN32
+	self->file = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	self->map = NULL;
+	if (self->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(self->file, &size)) {
+		YOD_STDLOG_ERROR("open failed");
+		goto e_failed;
+	}
+	self->size = (size_t) size.QuadPart;
+	if (self->size >= sizeof(yod_htable_h)) {
+		self->map = CreateFileMapping(self->file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (self->map) {
+			self->base = (byte *) MapViewOfFile(self->map, FILE_MAP_READ, 0, 0, 0);
+		}
+	}
+#else
+	fd = open(file, O_RDONLY);
+	if (fd == -1 || fstat(fd, &st) != 0) {
+		YOD_STDLOG_ERROR("open failed");
+		goto e_failed;
+	}
+	self->size = (size_t) st.st_size;
+	if (self->size >= sizeof(yod_htable_h)) {
+		/* shared and read-only, every process maps the same page cache */
+		self->base = (byte *) mmap(NULL, self->size, PROT_READ, MAP_SHARED, fd, 0);
+		if (self->base == MAP_FAILED) {
+			self->base = NULL;
 		}
 	}
+	close(fd);
+	fd = -1;
+#endif
+
+	if (!self->base) {
+		YOD_STDLOG_ERROR("mmap failed");
+		goto e_failed;
+	}
 
-	yod_stdlog_dump(NULL,
-		"\n----------------------------------------------------------------\n");
+	head = (const yod_htable_h *) self->base;
+	if (memcmp(head->magic, YOD_HTABLE_SNAP_MAGIC, sizeof(head->magic)) != 0
+		|| head->order != YOD_HTABLE_SNAP_ORDER || head->word != sizeof(ulong)
+		|| head->size != self->size || (head->mask & (head->mask + 1)) != 0
+		|| head->index != sizeof(yod_htable_h)
+		|| head->entry != head->index + (head->mask + 2) * sizeof(uint64_t)
+		|| head->entry + head->count * sizeof(yod_htable_e) > head->size) {
+		YOD_STDLOG_ERROR("invalid snapshot");
+		goto e_failed;
+	}
+
+	self->head = head;
+	self->index = (const uint64_t *) (self->base + head->index);
+	self->entry = (const yod_htable_e *) (self->base + head->entry);
+
+	if (self->index[head->mask + 1] != head->count) {
+		YOD_STDLOG_ERROR("invalid snapshot");
+		goto e_failed;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_HTABLE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%s): {count=%lu, size=%lu} %p in %s:%d %s",
+		__FUNCTION__, file, (ulong) head->count, (ulong) self->size, self, __ENV_TRACE);
+#else
+	__ENV_VOID
 #endif
 
+	return self;
+
+e_failed:
+
+#ifndef _WIN32
+	if (fd != -1) {
+		close(fd);
+	}
+#endif
+	_yod_htable_snap_close(self __ENV_CARGS);
+
+	return NULL;
+}
+/* }}} */
+
+
+/** {{{ void _yod_htable_snap_close(yod_htable_snap_t *self __ENV_CPARM)
+*/
+void _yod_htable_snap_close(yod_htable_snap_t *self __ENV_CPARM)
+{
+	if (!self) {
+		return;
+	}
+
 #if (_YOD_SYSTEM_DEBUG && _YOD_HTABLE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p): {size=%lu, count=%lu} in %s:%d %s",
-		__FUNCTION__, self, self->size, self->count, __ENV_TRACE);
+	yod_stdlog_debug(NULL, "%s(%p) in %s:%d %s",
+		__FUNCTION__, self, __ENV_TRACE);
 #else
 	__ENV_VOID
 #endif
 
-	return (0);
+#ifdef _WIN32
+	if (self->base) {
+		UnmapViewOfFile(self->base);
+	}
+	if (self->map) {
+		CloseHandle(self->map);
+	}
+	if (self->file != INVALID_HANDLE_VALUE) {
+		CloseHandle(self->file);
+	}
+#else
+	if (self->base) {
+		munmap(self->base, self->size);
+	}
+#endif
+	free(self);
 }
 /* }}} */
 
 
-/** {{{ static ulong _yod_htable_str_nkey(const char *str_key, size_t key_len)
+/** {{{ const void *_yod_htable_snap_find(yod_htable_snap_t *self, ulong num_key, const char *str_key, size_t key_len, size_t *len __ENV_CPARM)
 */
-static ulong _yod_htable_str_nkey(const char *str_key, size_t key_len)
+const void *_yod_htable_snap_find(yod_htable_snap_t *self, ulong num_key, const char *str_key, size_t key_len, size_t *len __ENV_CPARM)
 {
-	register ulong num_key = 5381;
+	const yod_htable_e *entry = NULL;
+	const void *value = NULL;
+	uint64_t i = 0;
+	uint64_t k = 0;
+
+	if (!self) {
+		return NULL;
+	}
+
+	if (key_len > 0) {
+		num_key = _yod_htable_str_nkey(self->head->seed, str_key, key_len);
+	}
 
-	for (; key_len >= 8; key_len -= 8) {
-		num_key = ((num_key << 5) + num_key) + *str_key++;
-		num_key = ((num_key << 5) + num_key) + *str_key++;
-		num_key = ((num_key << 5) + num_key) + *str_key++;
-		num_key = ((num_key << 5) + num_key) + *str_key++;
-		num_key = ((num_key << 5) + num_key) + *str_key++;
-		num_key = ((num_key << 5) + num_key) + *str_key++;
-		num_key = ((num_key << 5) + num_key) + *str_key++;
-		num_key = ((num_key << 5) + num_key) + *str_key++;
+	/* no locks, the mapping never changes */
+	k = num_key & self->head->mask;
+	for (i = self->index[k]; i < self->index[k + 1] && i < self->head->count; ++i) {
+		entry = &self->entry[i];
+		if ((entry->num_key == num_key) && (entry->key_len == key_len)
+			&& (entry->key_off + key_len <= self->size) && (entry->val_off + entry->val_len <= self->size)
+			&& (memcmp(self->base + entry->key_off, str_key, key_len) == 0)) {
+			if (len) {
+				*len = entry->val_len;
+			}
+			value = self->base + entry->val_off;
+			break;
+		}
 	}
-	switch (key_len) {
-		case 7: num_key = ((num_key << 5) + num_key) + *str_key++;
-		case 6: num_key = ((num_key << 5) + num_key) + *str_key++;
-		case 5: num_key = ((num_key << 5) + num_key) + *str_key++;
-		case 4: num_key = ((num_key << 5) + num_key) + *str_key++;
-		case 3: num_key = ((num_key << 5) + num_key) + *str_key++;
-		case 2: num_key = ((num_key << 5) + num_key) + *str_key++;
-		case 1: num_key = ((num_key << 5) + num_key) + *str_key++; break;
-		case 0: break;
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_HTABLE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu, %s, %d): %p in %s:%d %s",
+		__FUNCTION__, self, num_key, str_key, key_len, value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ ulong _yod_htable_snap_count(yod_htable_snap_t *self __ENV_CPARM)
+*/
+ulong _yod_htable_snap_count(yod_htable_snap_t *self __ENV_CPARM)
+{
+	if (!self) {
+		return 0;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && (_YOD_HTABLE_DEBUG & 0x02))
+	yod_stdlog_debug(NULL, "%s(%p): %lu in %s:%d %s",
+		__FUNCTION__, self, (ulong) self->head->count, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (ulong) self->head->count;
+}
+/* }}} */
+
+
+/** {{{ static yod_htable_s *_yod_htable_shard(yod_htable_t *self, ulong num_key)
+*/
+static yod_htable_s *_yod_htable_shard(yod_htable_t *self, ulong num_key)
+{
+	if (!self->shard_mask) {
+		return self->shards;
+	}
+
+	/* high bits of a fibonacci product, the low bits pick the bucket */
+	return &self->shards[(ulong) (((uint64_t) num_key * 0x9E3779B97F4A7C15ULL) >> 40) & self->shard_mask];
+}
+/* }}} */
+
+
+/** {{{ static yod_htable_t *_yod_htable_create(void (*vfree) (void * __ENV_CPARM), ulong shard_num, int epoch __ENV_CPARM)
+*/
+static yod_htable_t *_yod_htable_create(void (*vfree) (void * __ENV_CPARM), ulong shard_num, int epoch __ENV_CPARM)
+{
+	yod_htable_t *self = NULL;
+	yod_htable_s *shard = NULL;
+	ulong i = 0;
+
+	if (shard_num > YOD_HTABLE_MAX_SHARD) {
+		shard_num = YOD_HTABLE_MAX_SHARD;
+	}
+	for (i = 1; i < shard_num; i <<= 1);
+	shard_num = i;
+
+	self = (yod_htable_t *) malloc(sizeof(yod_htable_t) + 1);
+	if (!self) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
+	}
+
+	if (pthread_mutex_init(&self->lock, NULL) != 0) {
+		free(self);
+
+		YOD_STDLOG_ERROR("pthread_mutex_init failed");
+		return NULL;
+	}
+
+	self->shards = (yod_htable_s *) calloc(shard_num, sizeof(yod_htable_s));
+	if (!self->shards) {
+		pthread_mutex_destroy(&self->lock);
+		free(self);
+
+		YOD_STDLOG_ERROR("calloc failed");
+		return NULL;
+	}
+
+	{
+		self->is_ref = 0;
+		self->seed = _yod_htable_seed(self);
+		self->shard_mask = 0;
+		self->curr.table = self;
+		self->curr.node = NULL;
+		self->epoch = NULL;
+		self->cache.count = 0;
+		self->cache.bytes = 0;
+		self->vfree = vfree;
+	}
+
+	for (i = 0; i < shard_num; ++i) {
+		shard = &self->shards[i];
+
+		shard->count = 0;
+		shard->stamp = 0;
+		shard->bytes = 0;
+		shard->seq = 0;
+		shard->head = NULL;
+		shard->tail = NULL;
+		shard->hand = NULL;
+		shard->rehash.buckets = NULL;
+		shard->rehash.index = 0;
+
+		shard->buckets = _yod_htable_alloc(YOD_HTABLE_MIN_SIZE, 0 __ENV_CARGS);
+		if (shard->buckets == NULL) {
+			yod_htable_free(self);
+			return NULL;
+		}
+
+		if (pthread_mutex_init(&shard->lock, NULL) != 0) {
+			free(shard->buckets);
+			shard->buckets = NULL;
+			yod_htable_free(self);
+
+			YOD_STDLOG_ERROR("pthread_mutex_init failed");
+			return NULL;
+		}
+
+		self->shard_mask = i;
+	}
+
+	if (epoch) {
+		self->epoch = yod_epoch_new();
+		if (!self->epoch) {
+			yod_htable_free(self);
+
+			YOD_STDLOG_ERROR("epoch_new failed");
+			return NULL;
+		}
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_HTABLE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu, %d): %p in %s:%d %s",
+		__FUNCTION__, vfree, shard_num, epoch, self, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return self;
+}
+/* }}} */
+
+
+/** {{{ static ulong _yod_htable_resolve(yod_htable_s *shard, yod_htable_s **shards, const ulong *idx, ulong m, const yod_htable_k *keys, const ulong *hash, void **values)
+*/
+static ulong _yod_htable_resolve(yod_htable_s *shard, yod_htable_s **shards, const ulong *idx, ulong m, const yod_htable_k *keys, const ulong *hash, void **values)
+{
+	yod_htable_v **bucket[YOD_HTABLE_BATCH];
+	yod_htable_v *node[YOD_HTABLE_BATCH];
+	yod_htable_b *buckets = NULL;
+	ulong slot[YOD_HTABLE_BATCH];
+	uint64_t now = 0;
+	ulong count = 0;
+	ulong i = 0;
+	ulong j = 0;
+
+	/* a locked shard, or lock-free readers loading each shard's buckets */
+	for (j = 0; j < m; ++j) {
+		i = idx[j];
+		if (shard) {
+			bucket[j] = _yod_htable_bucket(shard, hash[i]);
+			slot[j] = shard->buckets->slot;
+		} else {
+			buckets = __ATM_LOAD(&shards[i]->buckets);
+			bucket[j] = &buckets->nodes[hash[i] & buckets->mask];
+			slot[j] = buckets->slot;
+		}
+		YOD_SYSTEM_PREFETCH(bucket[j]);
+	}
+
+	/* the bucket lines are in flight, now the chain heads */
+	for (j = 0; j < m; ++j) {
+		node[j] = __ATM_LOAD(bucket[j]);
+		YOD_SYSTEM_PREFETCH(node[j]);
+	}
+
+	for (j = 0; j < m; ++j) {
+		i = idx[j];
+		for (; node[j] != NULL; node[j] = __ATM_LOAD(&node[j]->v_next[slot[j]])) {
+			if ((node[j]->num_key == hash[i]) && (node[j]->key_len == keys[i].key_len) && (memcmp(node[j]->str_key, keys[i].str_key, keys[i].key_len) == 0)) {
+				if (!_yod_htable_expired(node[j], &now)) {
+					values[i] = __ATM_LOAD(&node[j]->value);
+					yod_htable_touch(node[j]);
+					++ count;
+				}
+				break;
+			}
+		}
+	}
+
+	return count;
+}
+/* }}} */
+
+
+/** {{{ static void *_yod_htable_iter(yod_htable_i *iter, long i, int forward, ulong *num_key, char **str_key, size_t *key_len)
+*/
+static void *_yod_htable_iter(yod_htable_i *iter, long i, int forward, ulong *num_key, char **str_key, size_t *key_len)
+{
+	yod_htable_t *self = iter->table;
+	yod_htable_s *shard = NULL;
+	yod_htable_v *node = NULL;
+	yod_htable_v *back = NULL;
+	yod_htable_v *ahead = NULL;
+	void *value = NULL;
+
+	/* step from the current node, else start at shard i */
+	if (iter->node) {
+		shard = _yod_htable_shard(self, iter->num_key);
+		i = shard - self->shards;
+
+		yod_htable_shard_lock(shard);
+		if (shard->stamp != iter->stamp && !_yod_htable_exists(shard, iter->node, iter->num_key, iter->seq)) {
+			/* deleted under the iterator, the shard list keeps its order,
+			 * so the neighbour behind it still leads to the one after */
+			back = (yod_htable_v *) (forward ? iter->prev : iter->next);
+			ahead = (yod_htable_v *) (forward ? iter->next : iter->prev);
+
+			if (!back) {
+				node = forward ? shard->head : shard->tail;
+			}
+			else if (_yod_htable_exists(shard, back, forward ? iter->prev_key : iter->next_key, forward ? iter->prev_seq : iter->next_seq)) {
+				node = forward ? back->next : back->prev;
+			}
+			else if (!ahead) {
+				node = NULL;
+			}
+			else if (_yod_htable_exists(shard, ahead, forward ? iter->next_key : iter->prev_key, forward ? iter->next_seq : iter->prev_seq)) {
+				node = ahead;
+			}
+			else {
+				/* both neighbours went too, tell it from the end */
+				yod_htable_shard_unlock(shard);
+				iter->node = NULL;
+				errno = EAGAIN;
+				return NULL;
+			}
+		}
+		else {
+			node = (yod_htable_v *) iter->node;
+			node = forward ? node->next : node->prev;
+		}
+
+		/* nodes added since the shard was entered, a deleted and re-added
+		 * key among them, are left out so the walk comes to an end */
+		while (node && node->seq > iter->last) {
+			node = forward ? node->next : node->prev;
+		}
+		if (!node) {
+			yod_htable_shard_unlock(shard);
+			i += forward ? 1 : -1;
+		}
+	}
+
+	for (; !node && i >= 0 && (ulong) i <= self->shard_mask; i += forward ? 1 : -1) {
+		shard = &self->shards[i];
+		yod_htable_shard_lock(shard);
+		node = forward ? shard->head : shard->tail;
+		if (!node) {
+			yod_htable_shard_unlock(shard);
+		}
+		iter->last = shard->seq;
+	}
+
+	if (!node) {
+		iter->node = NULL;
+		return NULL;
+	}
+
+	/* the shard is still locked */
+	iter->node = node;
+	iter->num_key = node->num_key;
+	iter->seq = node->seq;
+	iter->stamp = shard->stamp;
+	iter->prev = node->prev;
+	iter->prev_key = node->prev ? node->prev->num_key : 0;
+	iter->prev_seq = node->prev ? node->prev->seq : 0;
+	iter->next = node->next;
+	iter->next_key = node->next ? node->next->num_key : 0;
+	iter->next_seq = node->next ? node->next->seq : 0;
+	if (num_key) {
+		*num_key = node->num_key;
+	}
+	if (str_key) {
+		*str_key = node->str_key;
+	}
+	if (key_len) {
+		*key_len = node->key_len;
+	}
+	value = node->value;
+	yod_htable_shard_unlock(shard);
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ static int _yod_htable_exists(yod_htable_s *shard, yod_htable_v *node, ulong num_key, ulong seq)
+*/
+static int _yod_htable_exists(yod_htable_s *shard, yod_htable_v *node, ulong num_key, ulong seq)
+{
+	yod_htable_v *p = NULL;
+	ulong s = shard->buckets->slot;
+
+	/* node may already be freed and its address reused, so only
+	 * live nodes are read and the sequence must match too */
+	for (p = *_yod_htable_bucket(shard, num_key); p != NULL; p = p->v_next[s]) {
+		if (p == node && p->seq == seq) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+/* }}} */
+
+
+/** {{{ static void _yod_htable_clear(yod_htable_t *self, yod_htable_v *node __ENV_CPARM)
+*/
+static void _yod_htable_clear(yod_htable_t *self, yod_htable_v *node __ENV_CPARM)
+{
+	yod_htable_v *temp = NULL;
+
+	for (; node != NULL; node = temp) {
+		temp = node->next;
+		_yod_htable_retire_node(node, self __ENV_CARGS);
+	}
+}
+/* }}} */
+
+
+/** {{{ static void _yod_htable_unlink(yod_htable_t *self, yod_htable_s *shard, yod_htable_v **bucket, yod_htable_v *node __ENV_CPARM)
+*/
+static void _yod_htable_unlink(yod_htable_t *self, yod_htable_s *shard, yod_htable_v **bucket, yod_htable_v *node __ENV_CPARM)
+{
+	ulong s = shard->buckets->slot;
+
+	/* tail node */
+	if (!node->next) {
+		shard->tail = node->prev;
+		if (shard->tail) {
+			shard->tail->next = NULL;
+		}
+	} else {
+		node->next->prev = node->prev;
+	}
+	
+	if (shard->hand == node) {
+		shard->hand = node->next;
+	}
+
+	/* head node */
+	if (!node->prev) {
+		shard->head = node->next;
+		if (shard->head) {
+			shard->head->prev = NULL;
+		}
+	} else {
+		node->prev->next = node->next;
+	}
+	
+	if (!bucket) {
+		bucket = _yod_htable_bucket(shard, node->num_key);
+	}
+
+	if (node->v_next[s]) {
+		node->v_next[s]->v_prev = node->v_prev;
+	}
+
+	if (!node->v_prev) {
+		__ATM_STORE(bucket, node->v_next[s]);
+	} else {
+		__ATM_STORE(&node->v_prev->v_next[s], node->v_next[s]);
+	}
+
+	shard->count--;
+	shard->bytes -= node->bytes;
+	++ shard->stamp;
+
+	/* the node stays readable until the readers are gone */
+	if (self->epoch) {
+		yod_epoch_retire(self->epoch, node, _yod_htable_retire_node, self);
+	} else {
+		_yod_htable_retire_node(node, self __ENV_CARGS);
+	}
+}
+/* }}} */
+
+
+/** {{{ static void _yod_htable_evict(yod_htable_t *self, yod_htable_s *shard, yod_htable_v *keep __ENV_CPARM)
+*/
+static void _yod_htable_evict(yod_htable_t *self, yod_htable_s *shard, yod_htable_v *keep __ENV_CPARM)
+{
+	yod_htable_v *node = NULL;
+	uint64_t now = 0;
+
+	/* CLOCK: a hit sets ref, the hand clears it once before evicting */
+	while ((self->cache.count && shard->count > self->cache.count) || (self->cache.bytes && shard->bytes > self->cache.bytes)) {
+		node = shard->hand ? shard->hand : shard->head;
+		if (!node || (node == keep && shard->count == 1)) {
+			break;
+		}
+		shard->hand = node->next;
+		if (node == keep) {
+			continue;
+		}
+		if (__ATM_LOAD(&node->ref) && !_yod_htable_expired(node, &now)) {
+			__ATM_STORE(&node->ref, 0);
+			continue;
+		}
+
+#if (_YOD_SYSTEM_DEBUG && (_YOD_HTABLE_DEBUG & 0x02))
+		yod_stdlog_debug(NULL, "%s(%p, %p): {num_key=%lu, bytes=%lu} in %s:%d %s",
+			__FUNCTION__, self, shard, node->num_key, (ulong) node->bytes, __ENV_TRACE);
+#endif
+
+		_yod_htable_unlink(self, shard, NULL, node __ENV_CARGS);
+	}
+}
+/* }}} */
+
+
+/** {{{ static int _yod_htable_expired(yod_htable_v *node, uint64_t *now)
+*/
+static int _yod_htable_expired(yod_htable_v *node, uint64_t *now)
+{
+	uint64_t expire = __ATM_LOAD(&node->expire);
+
+	if (!expire) {
+		return 0;
+	}
+
+	/* one clock read per call site */
+	if (!*now) {
+		*now = yod_common_nowtime();
+	}
+
+	return (*now >= expire);
+}
+/* }}} */
+
+
+/** {{{ static yod_htable_b *_yod_htable_alloc(ulong size, ulong slot __ENV_CPARM)
+*/
+static yod_htable_b *_yod_htable_alloc(ulong size, ulong slot __ENV_CPARM)
+{
+	yod_htable_b *buckets = NULL;
+
+	buckets = (yod_htable_b *) calloc(1, sizeof(yod_htable_b) + (size - 1) * sizeof(yod_htable_v *));
+	if (!buckets) {
+		YOD_STDLOG_ERROR("calloc failed");
+		return NULL;
+	}
+
+	buckets->mask = size - 1;
+	buckets->size = size;
+	buckets->slot = slot;
+
+	return buckets;
+}
+/* }}} */
+
+
+/** {{{ static yod_htable_v **_yod_htable_bucket(yod_htable_s *shard, ulong num_key)
+*/
+static yod_htable_v **_yod_htable_bucket(yod_htable_s *shard, ulong num_key)
+{
+	ulong k = 0;
+
+	/* not yet migrated */
+	if (shard->rehash.buckets) {
+		k = num_key & shard->rehash.buckets->mask;
+		if (k >= shard->rehash.index) {
+			return &shard->rehash.buckets->nodes[k];
+		}
+	}
+
+	return &shard->buckets->nodes[num_key & shard->buckets->mask];
+}
+/* }}} */
+
+
+/** {{{ static int _yod_htable_resize(yod_htable_t *self, yod_htable_s *shard, ulong size __ENV_CPARM)
+*/
+static int _yod_htable_resize(yod_htable_t *self, yod_htable_s *shard, ulong size __ENV_CPARM)
+{
+	yod_htable_b *buckets = NULL;
+#if (_YOD_HTABLE_DEBUG & 0x02)
+	yod_htable_v *node = NULL;
+	ulong k = 0;
+#endif
+
+	if (!self || !shard) {
+		return (-1);
+	}
+
+	if (size < YOD_HTABLE_MIN_SIZE) {
+		size = YOD_HTABLE_MIN_SIZE;
+	}
+
+	if (shard->rehash.buckets) {
+		_yod_htable_rehash(shard, shard->rehash.buckets->size __ENV_CARGS);
+	}
+
+	if (size == shard->buckets->size) {
+		return (0);
+	}
+
+#if (_YOD_HTABLE_DEBUG & 0x02)
+	yod_stdlog_dump(NULL,
+		"----------------------------------------------------------------\n"
+		"%d / %d\n"
+		"----------------------------------------------------------------\n",
+		shard->count, shard->buckets->size);
+
+	for (k = 0; k < shard->buckets->size; ++k) {
+		for (node = shard->buckets->nodes[k]; node != NULL; node = node->v_next[shard->buckets->slot]) {
+			yod_stdlog_dump(NULL,
+				"[%04ld] => %p: "
+				"{num_key=%lu, str_key=%s, key_len=%d, value=%p, "
+				"next=%p, prev=%p, v_next=%p, v_prev=%p}\n",
+				(ulong) k, node,
+				node->num_key, node->str_key, node->key_len, node->value,
+				node->next, node->prev, node->v_next[shard->buckets->slot], node->v_prev);
+		}
+	}
+
+	yod_stdlog_dump(NULL,
+		"\n----------------------------------------------------------------\n");
+#endif
+
+	/* readers can not follow an incremental rehash */
+	if (self->epoch) {
+		return _yod_htable_publish(self, shard, size __ENV_CARGS);
+	}
+
+	buckets = _yod_htable_alloc(size, shard->buckets->slot __ENV_CARGS);
+	if (!buckets) {
+		return (-1);
+	}
+
+	/* the old buckets are drained by _yod_htable_rehash */
+	shard->rehash.buckets = shard->buckets;
+	shard->rehash.index = 0;
+	shard->buckets = buckets;
+
+	if (shard->count == 0) {
+		_yod_htable_rehash(shard, shard->rehash.buckets->size __ENV_CARGS);
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_HTABLE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p, %lu): {size=%lu, count=%lu} in %s:%d %s",
+		__FUNCTION__, self, shard, size, shard->buckets->size, shard->count, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (0);
+}
+/* }}} */
+
+
+/** {{{ static int _yod_htable_publish(yod_htable_t *self, yod_htable_s *shard, ulong size __ENV_CPARM)
+*/
+static int _yod_htable_publish(yod_htable_t *self, yod_htable_s *shard, ulong size __ENV_CPARM)
+{
+	yod_htable_b *buckets = NULL;
+	yod_htable_b *temp = NULL;
+	yod_htable_v *node = NULL;
+	ulong s = 0;
+	ulong k = 0;
+
+	/* chain the nodes through the other slot, the current chains stay intact */
+	s = shard->buckets->slot ^ 1;
+
+	buckets = _yod_htable_alloc(size, s __ENV_CARGS);
+	if (!buckets) {
+		return (-1);
+	}
+
+	/* readers of the buckets the last resize replaced may still walk that
+	 * slot, it is only rewritten once they are gone */
+	if (yod_epoch_barrier(self->epoch) != 0) {
+		YOD_STDLOG_WARN("barrier failed, resize skipped");
+		free(buckets);
+		return (-1);
+	}
+
+	for (node = shard->head; node != NULL; node = node->next) {
+		k = node->num_key & buckets->mask;
+		node->v_next[s] = buckets->nodes[k];
+		node->v_prev = NULL;
+		if (node->v_next[s]) {
+			node->v_next[s]->v_prev = node;
+		}
+		buckets->nodes[k] = node;
+	}
+
+	temp = shard->buckets;
+	__ATM_STORE(&shard->buckets, buckets);
+	yod_epoch_retire(self->epoch, temp, _yod_htable_retire_buckets, self);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_HTABLE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p, %lu): {slot=%lu, count=%lu} in %s:%d %s",
+		__FUNCTION__, self, shard, size, s, shard->count, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (0);
+}
+/* }}} */
+
+
+/** {{{ static void _yod_htable_rehash(yod_htable_s *shard, ulong step __ENV_CPARM)
+*/
+static void _yod_htable_rehash(yod_htable_s *shard, ulong step __ENV_CPARM)
+{
+	yod_htable_b *buckets = NULL;
+	yod_htable_v *node = NULL;
+	yod_htable_v *temp = NULL;
+	ulong empty = step * 10;
+	ulong s = 0;
+	ulong k = 0;
+
+	if (!shard || !shard->rehash.buckets) {
+		return;
+	}
+
+	buckets = shard->rehash.buckets;
+	s = buckets->slot;
+
+	/* migrate at most `step` buckets, skip at most `step * 10` empty ones */
+	while (step > 0 && shard->rehash.index < buckets->size) {
+		node = buckets->nodes[shard->rehash.index];
+		if (!node) {
+			++ shard->rehash.index;
+			if (-- empty == 0) {
+				break;
+			}
+			continue;
+		}
+
+		for (; node != NULL; node = temp) {
+			temp = node->v_next[s];
+			k = node->num_key & shard->buckets->mask;
+			node->v_next[s] = shard->buckets->nodes[k];
+			node->v_prev = NULL;
+			if (node->v_next[s]) {
+				node->v_next[s]->v_prev = node;
+			}
+			shard->buckets->nodes[k] = node;
+		}
+
+		buckets->nodes[shard->rehash.index ++] = NULL;
+		-- step;
+	}
+
+	if (shard->rehash.index >= buckets->size) {
+		free(buckets);
+		shard->rehash.buckets = NULL;
+		shard->rehash.index = 0;
+
+#if (_YOD_HTABLE_DEBUG & 0x02)
+		yod_stdlog_dump(NULL,
+			"----------------------------------------------------------------\n"
+			"%d / %d\n"
+			"----------------------------------------------------------------\n",
+			shard->count, shard->buckets->size);
+
+		for (k = 0; k < shard->buckets->size; ++k) {
+			for (node = shard->buckets->nodes[k]; node != NULL; node = node->v_next[s]) {
+				yod_stdlog_dump(NULL,
+					"[%04ld] => %p: "
+					"{num_key=%lu, str_key=%s, key_len=%d, value=%p, "
+					"next=%p, prev=%p, v_next=%p, v_prev=%p}\n",
+					(ulong) k, node,
+					node->num_key, node->str_key, node->key_len, node->value,
+					node->next, node->prev, node->v_next[s], node->v_prev);
+			}
+		}
+
+		yod_stdlog_dump(NULL,
+			"\n----------------------------------------------------------------\n");
+#endif
+	}
+
+#if (_YOD_SYSTEM_DEBUG && (_YOD_HTABLE_DEBUG & 0x02))
+	yod_stdlog_debug(NULL, "%s(%p): {index=%lu} in %s:%d %s",
+		__FUNCTION__, shard, shard->rehash.index, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+}
+/* }}} */
+
+
+/** {{{ static void _yod_htable_retire_node(void *ptr, void *arg __ENV_CPARM)
+*/
+static void _yod_htable_retire_node(void *ptr, void *arg __ENV_CPARM)
+{
+	yod_htable_t *self = (yod_htable_t *) arg;
+	yod_htable_v *node = (yod_htable_v *) ptr;
+
+	node->num_key = 0;
+	if (node->str_key) {
+		free(node->str_key);
+	}
+	node->key_len = 0;
+	if (self->vfree) {
+		self->vfree(node->value __ENV_CARGS);
+	}
+	free(node);
+}
+/* }}} */
+
+
+/** {{{ static void _yod_htable_retire_list(void *ptr, void *arg __ENV_CPARM)
+*/
+static void _yod_htable_retire_list(void *ptr, void *arg __ENV_CPARM)
+{
+	_yod_htable_clear((yod_htable_t *) arg, (yod_htable_v *) ptr __ENV_CARGS);
+}
+/* }}} */
+
+
+/** {{{ static void _yod_htable_retire_value(void *ptr, void *arg __ENV_CPARM)
+*/
+static void _yod_htable_retire_value(void *ptr, void *arg __ENV_CPARM)
+{
+	yod_htable_t *self = (yod_htable_t *) arg;
+
+	if (self->vfree) {
+		self->vfree(ptr __ENV_CARGS);
+	}
+}
+/* }}} */
+
+
+/** {{{ static void _yod_htable_retire_buckets(void *ptr, void *arg __ENV_CPARM)
+*/
+static void _yod_htable_retire_buckets(void *ptr, void *arg __ENV_CPARM)
+{
+	free(ptr);
+}
+/* }}} */
+
+
+/** {{{ static uint64_t _yod_htable_r64(const byte *p)
+*/
+static uint64_t _yod_htable_r64(const byte *p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+/* }}} */
+
+
+/** {{{ static uint64_t _yod_htable_r32(const byte *p)
+*/
+static uint64_t _yod_htable_r32(const byte *p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+/* }}} */
+
+
+/** {{{ static uint64_t _yod_htable_mum(uint64_t a, uint64_t b)
+*/
+static uint64_t _yod_htable_mum(uint64_t a, uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+	__uint128_t r = (__uint128_t) a * b;
+	return (uint64_t) r ^ (uint64_t) (r >> 64);
+#else
+	uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t) a, lb = (uint32_t) b;
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	uint64_t t = rl + (rm0 << 32), c = (t < rl), lo, hi;
+	lo = t + (rm1 << 32);
+	c += (lo < t);
+	hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+	return lo ^ hi;
+#endif
+}
+/* }}} */
+
+
+/** {{{ static int _yod_htable_snap_blob(FILE *fp, const void *data, size_t len, int term)
+*/
+static int _yod_htable_snap_blob(FILE *fp, const void *data, size_t len, int term)
+{
+	static const byte zero[8] = {0};
+	size_t pad = YOD_HTABLE_SNAP_ALIGN(len + term) - len;
+
+	if (len > 0 && fwrite(data, len, 1, fp) != 1) {
+		return (-1);
+	}
+
+	/* the key terminator is part of the padding */
+	if (pad > 0 && fwrite(zero, pad, 1, fp) != 1) {
+		return (-1);
+	}
+
+	return (0);
+}
+/* }}} */
+
+
+/** {{{ static int _yod_htable_snap_seek(FILE *fp, uint64_t off)
+*/
+static int _yod_htable_snap_seek(FILE *fp, uint64_t off)
+{
+#ifdef _WIN32
+	return _fseeki64(fp, (__int64) off, SEEK_SET);
+#else
+	return fseeko(fp, (off_t) off, SEEK_SET);
+#endif
+}
+/* }}} */
+
+
+/** {{{ static void _yod_htable_seed_init(void)
+*/
+static void _yod_htable_seed_init(void)
+{
+	uint64_t seed = 0;
+	FILE *fp = NULL;
+
+	fp = fopen("/dev/urandom", "rb");
+	if (!fp || fread(&seed, sizeof(seed), 1, fp) != 1) {
+		seed = yod_common_nowtime() ^ (uint64_t) clock();
+	}
+	if (fp) {
+		fclose(fp);
+	}
+	yod_htable_seed__ = seed | 1;
+
+#if YOD_HTABLE_HASH_AVX2
+	__builtin_cpu_init();
+	yod_htable_avx2__ = __builtin_cpu_supports("avx2");
+#endif
+}
+/* }}} */
+
+
+/** {{{ static uint64_t _yod_htable_seed(yod_htable_t *self)
+*/
+static uint64_t _yod_htable_seed(yod_htable_t *self)
+{
+	uint64_t seed = 0;
+
+	pthread_once(&yod_htable_once__, _yod_htable_seed_init);
+
+	/* per table: secret ^ address ^ sequence */
+	seed = yod_htable_seed__ ^ (uint64_t) (size_t) self;
+	seed ^= __ATM_ADD(&yod_htable_count__, 1) * YOD_HTABLE_HASH_P2;
+
+	return _yod_htable_mum(seed ^ YOD_HTABLE_HASH_P0, seed ^ YOD_HTABLE_HASH_P1);
+}
+/* }}} */
+
+
+/** {{{ static uint64_t _yod_htable_hash_long(uint64_t seed, const byte *p, size_t len)
+*/
+static uint64_t _yod_htable_hash_long(uint64_t seed, const byte *p, size_t len)
+{
+	uint64_t acc[4], key[4], d, dk;
+	int i;
+
+	acc[0] = seed ^ YOD_HTABLE_HASH_P0;
+	acc[1] = seed ^ YOD_HTABLE_HASH_P1;
+	acc[2] = seed ^ YOD_HTABLE_HASH_P2;
+	acc[3] = seed ^ YOD_HTABLE_HASH_P3;
+
+	key[0] = YOD_HTABLE_HASH_P1;
+	key[1] = YOD_HTABLE_HASH_P2;
+	key[2] = YOD_HTABLE_HASH_P3;
+	key[3] = YOD_HTABLE_HASH_P0;
+
+	/* 4 x 64-bit lanes per 32-byte stripe, the key changes every stripe;
+	 * the last stripe ends on the last byte and may overlap the one before */
+	for (; len > 0; len -= 32, p += 32) {
+		if (len < 32) {
+			p -= 32 - len;
+			len = 32;
+		}
+		for (i = 0; i < 4; ++i) {
+			d = _yod_htable_r64(p + (i << 3));
+			dk = d ^ key[i];
+			acc[i] += (dk & 0xFFFFFFFF) * (dk >> 32) + d;
+			key[i] += YOD_HTABLE_HASH_P2;
+		}
+	}
+
+	return seed ^ _yod_htable_mum(acc[0] ^ YOD_HTABLE_HASH_P0, acc[1] ^ YOD_HTABLE_HASH_P1)
+		^ _yod_htable_mum(acc[2] ^ YOD_HTABLE_HASH_P2, acc[3] ^ YOD_HTABLE_HASH_P3);
+}
+/* }}} */
+
+
+#if YOD_HTABLE_HASH_AVX2
+/** {{{ static uint64_t _yod_htable_hash_avx2(uint64_t seed, const byte *p, size_t len)
+*/
+__attribute__((target("avx2")))
+static uint64_t _yod_htable_hash_avx2(uint64_t seed, const byte *p, size_t len)
+{
+	__m256i acc, key, step, d, dk;
+	uint64_t lanes[4];
+
+	acc = _mm256_xor_si256(_mm256_set1_epi64x((long long) seed),
+		_mm256_set_epi64x((long long) YOD_HTABLE_HASH_P3, (long long) YOD_HTABLE_HASH_P2,
+			(long long) YOD_HTABLE_HASH_P1, (long long) YOD_HTABLE_HASH_P0));
+	key = _mm256_set_epi64x((long long) YOD_HTABLE_HASH_P0, (long long) YOD_HTABLE_HASH_P3,
+		(long long) YOD_HTABLE_HASH_P2, (long long) YOD_HTABLE_HASH_P1);
+	step = _mm256_set1_epi64x((long long) YOD_HTABLE_HASH_P2);
+
+	/* same lanes as _yod_htable_hash_long, the results are identical */
+	for (; len > 0; len -= 32, p += 32) {
+		if (len < 32) {
+			p -= 32 - len;
+			len = 32;
+		}
+		d = _mm256_loadu_si256((const __m256i *) p);
+		dk = _mm256_xor_si256(d, key);
+		acc = _mm256_add_epi64(acc, _mm256_add_epi64(_mm256_mul_epu32(dk, _mm256_srli_epi64(dk, 32)), d));
+		key = _mm256_add_epi64(key, step);
+	}
+	_mm256_storeu_si256((__m256i *) lanes, acc);
+
+	return seed ^ _yod_htable_mum(lanes[0] ^ YOD_HTABLE_HASH_P0, lanes[1] ^ YOD_HTABLE_HASH_P1)
+		^ _yod_htable_mum(lanes[2] ^ YOD_HTABLE_HASH_P2, lanes[3] ^ YOD_HTABLE_HASH_P3);
+}
+/* }}} */
+#endif
+
+
+/** {{{ static ulong _yod_htable_str_nkey(uint64_t seed, const char *str_key, size_t key_len)
+*/
+static ulong _yod_htable_str_nkey(uint64_t seed, const char *str_key, size_t key_len)
+{
+	const byte *p = (const byte *) str_key;
+	size_t i = key_len;
+	uint64_t a = 0;
+	uint64_t b = 0;
+
+	seed ^= YOD_HTABLE_HASH_P0;
+
+	if (key_len <= 16) {
+		if (key_len >= 4) {
+			a = (_yod_htable_r32(p) << 32) | _yod_htable_r32(p + ((key_len >> 3) << 2));
+			b = (_yod_htable_r32(p + key_len - 4) << 32) | _yod_htable_r32(p + key_len - 4 - ((key_len >> 3) << 2));
+		} else if (key_len > 0) {
+			a = ((uint64_t) p[0] << 16) | ((uint64_t) p[key_len >> 1] << 8) | p[key_len - 1];
+		}
+	} else {
+		if (key_len >= YOD_HTABLE_HASH_LONG) {
+#if YOD_HTABLE_HASH_AVX2
+			if (yod_htable_avx2__) {
+				seed = _yod_htable_hash_avx2(seed, p, key_len);
+			} else
+#endif
+			seed = _yod_htable_hash_long(seed, p, key_len);
+		} else {
+			for (; i > 16; i -= 16, p += 16) {
+				seed = _yod_htable_mum(_yod_htable_r64(p) ^ YOD_HTABLE_HASH_P1, _yod_htable_r64(p + 8) ^ seed);
+			}
+		}
+		/* the last 16 bytes, may overlap */
+		p = (const byte *) str_key + key_len - 16;
+		a = _yod_htable_r64(p);
+		b = _yod_htable_r64(p + 8);
 	}
 
-	return num_key;
+	return (ulong) _yod_htable_mum(YOD_HTABLE_HASH_P1 ^ key_len,
+		_yod_htable_mum(a ^ YOD_HTABLE_HASH_P1, b ^ seed));
 }
 /* }}} */
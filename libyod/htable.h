@@ -7,15 +7,59 @@
 /* yod_htable_t */
 typedef struct _yod_htable_t 									yod_htable_t;
 
+/* yod_htable_snap_t */
+typedef struct _yod_htable_snap_t 								yod_htable_snap_t;
+
+/* yod_htable_i */
+typedef struct _yod_htable_i
+{
+	yod_htable_t *table;
+	void *node;
+	ulong num_key;
+	ulong seq;
+	ulong stamp;
+
+	/* the shard's sequence when the walk entered it */
+	ulong last;
+
+	/* neighbours of node, to resume from when it is deleted */
+	void *prev;
+	void *next;
+	ulong prev_key;
+	ulong next_key;
+	ulong prev_seq;
+	ulong next_seq;
+} yod_htable_i;
+
+/* yod_htable_k */
+typedef struct _yod_htable_k
+{
+	ulong num_key;
+	const char *str_key;
+	size_t key_len;
+} yod_htable_k;
+
+/* yod_htable_fn */
+typedef int (*yod_htable_fn) (ulong num_key, char *str_key, size_t key_len, void *value, void *arg __ENV_CPARM);
+
+/* yod_htable_enc, the data is written before the next call and never freed,
+ * so the encoder may hand back the same buffer every time */
+typedef const void *(*yod_htable_enc) (void *value, size_t *len, void *arg __ENV_CPARM);
+
 
 #define yod_htable_new(f) 										_yod_htable_new(f __ENV_CARGS)
+#define yod_htable_new_shard(f, n) 								_yod_htable_new_shard(f, n __ENV_CARGS)
+#define yod_htable_new_epoch(f) 								_yod_htable_new_epoch(f __ENV_CARGS)
 #define yod_htable_ref(x) 										_yod_htable_ref(x __ENV_CARGS)
 #define yod_htable_reset(x) 									_yod_htable_reset(x __ENV_CARGS)
+#define yod_htable_cache(x, c, b) 								_yod_htable_cache(x, c, b __ENV_CARGS)
 #define yod_htable_free(x) 										_yod_htable_free(x __ENV_CARGS)
 
 #define yod_htable_add(x, i, k, l, v) 							_yod_htable_add(x, i, k, l, v, 1 __ENV_CARGS)
+#define yod_htable_add_ttl(x, i, k, l, v, b, t) 				_yod_htable_add_ttl(x, i, k, l, v, b, t, 1 __ENV_CARGS)
 #define yod_htable_del(x, i, k, l) 								_yod_htable_del(x, i, k, l __ENV_CARGS)
 #define yod_htable_find(x, i, k, l) 							_yod_htable_find(x, i, k, l __ENV_CARGS)
+#define yod_htable_find_many(x, k, n, v) 						_yod_htable_find_many(x, k, n, v __ENV_CARGS)
 
 #define yod_htable_count(x) 									_yod_htable_count(x __ENV_CARGS)
 #define yod_htable_head(x, i, k, l) 							_yod_htable_head(x, i, k, l __ENV_CARGS)
@@ -23,7 +67,22 @@ typedef struct _yod_htable_t 									yod_htable_t;
 #define yod_htable_next(x, i, k, l) 							_yod_htable_next(x, i, k, l __ENV_CARGS)
 #define yod_htable_prev(x, i, k, l) 							_yod_htable_prev(x, i, k, l __ENV_CARGS)
 
+#define yod_htable_iter_head(x, t, i, k, l) 					_yod_htable_iter_head(x, t, i, k, l __ENV_CARGS)
+#define yod_htable_iter_tail(x, t, i, k, l) 					_yod_htable_iter_tail(x, t, i, k, l __ENV_CARGS)
+#define yod_htable_iter_next(t, i, k, l) 						_yod_htable_iter_next(t, i, k, l __ENV_CARGS)
+#define yod_htable_iter_prev(t, i, k, l) 						_yod_htable_iter_prev(t, i, k, l __ENV_CARGS)
+#define yod_htable_visit(x, f, a) 								_yod_htable_visit(x, f, a __ENV_CARGS)
+
+#define yod_htable_save(x, f, e, a) 							_yod_htable_save(x, f, e, a __ENV_CARGS)
+#define yod_htable_snap_open(f) 								_yod_htable_snap_open(f __ENV_CARGS)
+#define yod_htable_snap_close(x) 								_yod_htable_snap_close(x __ENV_CARGS)
+#define yod_htable_snap_find(x, i, k, l, n) 					_yod_htable_snap_find(x, i, k, l, n __ENV_CARGS)
+#define yod_htable_snap_find_index(x, i, n) 					_yod_htable_snap_find(x, i, NULL, 0, n __ENV_CARGS)
+#define yod_htable_snap_find_assoc(x, k, n) 					_yod_htable_snap_find(x, 0, k, strlen(k), n __ENV_CARGS)
+#define yod_htable_snap_count(x) 								_yod_htable_snap_count(x __ENV_CARGS)
+
 #define yod_htable_add_index(x, i, v) 							_yod_htable_add(x, i, NULL, 0, v, 1 __ENV_CARGS)
+#define yod_htable_add_ttl_index(x, i, v, b, t) 				_yod_htable_add_ttl(x, i, NULL, 0, v, b, t, 1 __ENV_CARGS)
 #define yod_htable_del_index(x, i) 								_yod_htable_del(x, i, NULL, 0 __ENV_CARGS)
 #define yod_htable_find_index(x, i) 							_yod_htable_find(x, i, NULL, 0 __ENV_CARGS)
 
@@ -32,7 +91,13 @@ typedef struct _yod_htable_t 									yod_htable_t;
 #define yod_htable_next_index(x, i) 							_yod_htable_next(x, i, NULL, NULL __ENV_CARGS)
 #define yod_htable_prev_index(x, i) 							_yod_htable_prev(x, i, NULL, NULL __ENV_CARGS)
 
+#define yod_htable_iter_head_index(x, t, i) 					_yod_htable_iter_head(x, t, i, NULL, NULL __ENV_CARGS)
+#define yod_htable_iter_tail_index(x, t, i) 					_yod_htable_iter_tail(x, t, i, NULL, NULL __ENV_CARGS)
+#define yod_htable_iter_next_index(t, i) 						_yod_htable_iter_next(t, i, NULL, NULL __ENV_CARGS)
+#define yod_htable_iter_prev_index(t, i) 						_yod_htable_iter_prev(t, i, NULL, NULL __ENV_CARGS)
+
 #define yod_htable_add_assocl(x, k, l, v) 						_yod_htable_add(x, 0, k, l, v, 1 __ENV_CARGS)
+#define yod_htable_add_ttl_assocl(x, k, l, v, b, t) 			_yod_htable_add_ttl(x, 0, k, l, v, b, t, 1 __ENV_CARGS)
 #define yod_htable_del_assocl(x, k, l) 							_yod_htable_del(x, 0, k, l __ENV_CARGS)
 #define yod_htable_find_assocl(x, k, l) 						_yod_htable_find(x, 0, k, l __ENV_CARGS)
 
@@ -41,7 +106,13 @@ typedef struct _yod_htable_t 									yod_htable_t;
 #define yod_htable_next_assocl(x, k, l) 						_yod_htable_next(x, NULL, k, l __ENV_CARGS)
 #define yod_htable_prev_assocl(x, k, l) 						_yod_htable_prev(x, NULL, k, l __ENV_CARGS)
 
+#define yod_htable_iter_head_assocl(x, t, k, l) 				_yod_htable_iter_head(x, t, NULL, k, l __ENV_CARGS)
+#define yod_htable_iter_tail_assocl(x, t, k, l) 				_yod_htable_iter_tail(x, t, NULL, k, l __ENV_CARGS)
+#define yod_htable_iter_next_assocl(t, k, l) 					_yod_htable_iter_next(t, NULL, k, l __ENV_CARGS)
+#define yod_htable_iter_prev_assocl(t, k, l) 					_yod_htable_iter_prev(t, NULL, k, l __ENV_CARGS)
+
 #define yod_htable_add_assoc(x, k, v) 							_yod_htable_add(x, 0, k, strlen(k), v, 1 __ENV_CARGS)
+#define yod_htable_add_ttl_assoc(x, k, v, b, t) 				_yod_htable_add_ttl(x, 0, k, strlen(k), v, b, t, 1 __ENV_CARGS)
 #define yod_htable_del_assoc(x, k) 								_yod_htable_del(x, 0, k, strlen(k) __ENV_CARGS)
 #define yod_htable_find_assoc(x, k) 							_yod_htable_find(x, 0, k, strlen(k) __ENV_CARGS)
 
@@ -50,15 +121,25 @@ typedef struct _yod_htable_t 									yod_htable_t;
 #define yod_htable_next_assoc(x, k) 							_yod_htable_next(x, NULL, k, NULL __ENV_CARGS)
 #define yod_htable_prev_assoc(x, k) 							_yod_htable_prev(x, NULL, k, NULL __ENV_CARGS)
 
+#define yod_htable_iter_head_assoc(x, t, k) 					_yod_htable_iter_head(x, t, NULL, k, NULL __ENV_CARGS)
+#define yod_htable_iter_tail_assoc(x, t, k) 					_yod_htable_iter_tail(x, t, NULL, k, NULL __ENV_CARGS)
+#define yod_htable_iter_next_assoc(t, k) 						_yod_htable_iter_next(t, NULL, k, NULL __ENV_CARGS)
+#define yod_htable_iter_prev_assoc(t, k) 						_yod_htable_iter_prev(t, NULL, k, NULL __ENV_CARGS)
+
 
 yod_htable_t *_yod_htable_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM);
+yod_htable_t *_yod_htable_new_shard(void (*vfree) (void * __ENV_CPARM), ulong shard_num __ENV_CPARM);
+yod_htable_t *_yod_htable_new_epoch(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM);
 void _yod_htable_free(yod_htable_t *self __ENV_CPARM);
 yod_htable_t *_yod_htable_ref(yod_htable_t *self __ENV_CPARM);
 int _yod_htable_reset(yod_htable_t *self __ENV_CPARM);
+int _yod_htable_cache(yod_htable_t *self, ulong max_count, ulong max_bytes __ENV_CPARM);
 
 int _yod_htable_add(yod_htable_t *self, ulong num_key, const char *str_key, size_t key_len, void *value, int force __ENV_CPARM);
+int _yod_htable_add_ttl(yod_htable_t *self, ulong num_key, const char *str_key, size_t key_len, void *value, size_t bytes, ulong ttl, int force __ENV_CPARM);
 int _yod_htable_del(yod_htable_t *self, ulong num_key, const char *str_key, size_t key_len __ENV_CPARM);
 void *_yod_htable_find(yod_htable_t *self, ulong num_key, const char *str_key, size_t key_len __ENV_CPARM);
+ulong _yod_htable_find_many(yod_htable_t *self, const yod_htable_k *keys, ulong n, void **values __ENV_CPARM);
 
 ulong _yod_htable_count(yod_htable_t *self __ENV_CPARM);
 void *_yod_htable_head(yod_htable_t *self, ulong *num_key, char **str_key, size_t *key_len __ENV_CPARM);
@@ -66,4 +147,18 @@ void *_yod_htable_tail(yod_htable_t *self, ulong *num_key, char **str_key, size_
 void *_yod_htable_next(yod_htable_t *self, ulong *num_key, char **str_key, size_t *key_len __ENV_CPARM);
 void *_yod_htable_prev(yod_htable_t *self, ulong *num_key, char **str_key, size_t *key_len __ENV_CPARM);
 
+/* a deleted current node is stepped over, NULL with errno EAGAIN means
+ * its neighbours went too and the walk must restart */
+void *_yod_htable_iter_head(yod_htable_t *self, yod_htable_i *iter, ulong *num_key, char **str_key, size_t *key_len __ENV_CPARM);
+void *_yod_htable_iter_tail(yod_htable_t *self, yod_htable_i *iter, ulong *num_key, char **str_key, size_t *key_len __ENV_CPARM);
+void *_yod_htable_iter_next(yod_htable_i *iter, ulong *num_key, char **str_key, size_t *key_len __ENV_CPARM);
+void *_yod_htable_iter_prev(yod_htable_i *iter, ulong *num_key, char **str_key, size_t *key_len __ENV_CPARM);
+int _yod_htable_visit(yod_htable_t *self, yod_htable_fn func, void *arg __ENV_CPARM);
+
+int _yod_htable_save(yod_htable_t *self, const char *file, yod_htable_enc func, void *arg __ENV_CPARM);
+yod_htable_snap_t *_yod_htable_snap_open(const char *file __ENV_CPARM);
+void _yod_htable_snap_close(yod_htable_snap_t *self __ENV_CPARM);
+const void *_yod_htable_snap_find(yod_htable_snap_t *self, ulong num_key, const char *str_key, size_t key_len, size_t *len __ENV_CPARM);
+ulong _yod_htable_snap_count(yod_htable_snap_t *self __ENV_CPARM);
+
 #endif
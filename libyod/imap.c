@@ -0,0 +1,463 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "stdlog.h"
+#include "imap.h"
+
+
+#ifndef _YOD_IMAP_DEBUG
+#define _YOD_IMAP_DEBUG 										0
+#endif
+
+#define YOD_IMAP_MIN_SIZE 										(1 << 4)
+
+
+/* yod_imap_v */
+typedef struct _yod_imap_v
+{
+	uint64_t key;
+	void *value;
+} yod_imap_v;
+
+
+/* yod_imap_t */
+struct _yod_imap_t
+{
+	pthread_mutex_t lock;
+
+	ulong mask;
+	ulong size;
+	ulong count;
+
+	/* key 0 marks an empty slot, its entry lives here */
+	int has_zero;
+	void *zero;
+
+	yod_imap_v *slots;
+
+	void (*vfree) (void * __ENV_CPARM);
+};
+
+
+static int _yod_imap_resize(yod_imap_t *self, ulong size __ENV_CPARM);
+static ulong _yod_imap_hash(uint64_t key);
+
+
+/** {{{ yod_imap_t *_yod_imap_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM)
+*/
+yod_imap_t *_yod_imap_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM)
+{
+	yod_imap_t *self = NULL;
+
+	self = (yod_imap_t *) malloc(sizeof(yod_imap_t));
+	if (!self) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
+	}
+
+	if (pthread_mutex_init(&self->lock, NULL) != 0) {
+		free(self);
+
+		YOD_STDLOG_ERROR("pthread_mutex_init failed");
+		return NULL;
+	}
+
+	self->slots = (yod_imap_v *) calloc(YOD_IMAP_MIN_SIZE, sizeof(yod_imap_v));
+	if (!self->slots) {
+		pthread_mutex_destroy(&self->lock);
+		free(self);
+
+		YOD_STDLOG_ERROR("calloc failed");
+		return NULL;
+	}
+
+	{
+		self->mask = YOD_IMAP_MIN_SIZE - 1;
+		self->size = YOD_IMAP_MIN_SIZE;
+		self->count = 0;
+		self->has_zero = 0;
+		self->zero = NULL;
+		self->vfree = vfree;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_IMAP_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p): %p in %s:%d %s",
+		__FUNCTION__, vfree, self, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return self;
+}
+/* }}} */
+
+
+/** {{{ void _yod_imap_free(yod_imap_t *self __ENV_CPARM)
+*/
+void _yod_imap_free(yod_imap_t *self __ENV_CPARM)
+{
+	if (!self) {
+		return;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_IMAP_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p) in %s:%d %s",
+		__FUNCTION__, self, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	_yod_imap_reset(self __ENV_CARGS);
+
+	pthread_mutex_destroy(&self->lock);
+	free(self->slots);
+	free(self);
+}
+/* }}} */
+
+
+/** {{{ int _yod_imap_reset(yod_imap_t *self __ENV_CPARM)
+*/
+int _yod_imap_reset(yod_imap_t *self __ENV_CPARM)
+{
+	ulong i = 0;
+
+	if (!self) {
+		return (-1);
+	}
+
+	pthread_mutex_lock(&self->lock);
+	if (self->vfree) {
+		if (self->has_zero) {
+			self->vfree(self->zero __ENV_CARGS);
+		}
+		for (i = 0; i < self->size; ++i) {
+			if (self->slots[i].key) {
+				self->vfree(self->slots[i].value __ENV_CARGS);
+			}
+		}
+	}
+	memset(self->slots, 0, self->size * sizeof(yod_imap_v));
+	self->count = 0;
+	self->has_zero = 0;
+	self->zero = NULL;
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_IMAP_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p) in %s:%d %s",
+		__FUNCTION__, self, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (0);
+}
+/* }}} */
+
+
+/** {{{ int _yod_imap_add(yod_imap_t *self, uint64_t key, void *value, int force __ENV_CPARM)
+*/
+int _yod_imap_add(yod_imap_t *self, uint64_t key, void *value, int force __ENV_CPARM)
+{
+	yod_imap_v *slot = NULL;
+	ulong i = 0;
+	int ret = 0;
+
+	if (!self) {
+		return (-1);
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_IMAP_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu, %p) in %s:%d %s",
+		__FUNCTION__, self, (ulong) key, value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	pthread_mutex_lock(&self->lock);
+
+	if (key == 0) {
+		if (self->has_zero) {
+			if (force) {
+				if (self->vfree) {
+					self->vfree(self->zero __ENV_CARGS);
+				}
+				self->zero = value;
+			}
+			ret = force ? 0 : (-1);
+		} else {
+			self->has_zero = 1;
+			self->zero = value;
+			++ self->count;
+		}
+		goto e_return;
+	}
+
+	/* keep the load under 3/4 */
+	if (((self->count + 1) << 2) > self->size * 3) {
+		if (_yod_imap_resize(self, self->size << 1 __ENV_CARGS) != 0) {
+			ret = -1;
+			goto e_return;
+		}
+	}
+
+	for (i = _yod_imap_hash(key) & self->mask; ; i = (i + 1) & self->mask) {
+		slot = &self->slots[i];
+		if (slot->key == key) {
+			if (force) {
+				if (self->vfree) {
+					self->vfree(slot->value __ENV_CARGS);
+				}
+				slot->value = value;
+			}
+			ret = force ? 0 : (-1);
+			break;
+		}
+		if (slot->key == 0) {
+			slot->key = key;
+			slot->value = value;
+			++ self->count;
+			break;
+		}
+	}
+
+e_return:
+
+	pthread_mutex_unlock(&self->lock);
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ int _yod_imap_del(yod_imap_t *self, uint64_t key __ENV_CPARM)
+*/
+int _yod_imap_del(yod_imap_t *self, uint64_t key __ENV_CPARM)
+{
+	yod_imap_v *slot = NULL;
+	ulong size = 0;
+	ulong i = 0;
+	ulong j = 0;
+	ulong h = 0;
+	int ret = -1;
+
+	if (!self) {
+		return (-1);
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_IMAP_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu) in %s:%d %s",
+		__FUNCTION__, self, (ulong) key, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	pthread_mutex_lock(&self->lock);
+
+	if (key == 0) {
+		if (self->has_zero) {
+			if (self->vfree) {
+				self->vfree(self->zero __ENV_CARGS);
+			}
+			self->has_zero = 0;
+			self->zero = NULL;
+			-- self->count;
+			ret = 0;
+		}
+		goto e_return;
+	}
+
+	for (i = _yod_imap_hash(key) & self->mask; ; i = (i + 1) & self->mask) {
+		slot = &self->slots[i];
+		if (slot->key == 0) {
+			goto e_return;
+		}
+		if (slot->key == key) {
+			break;
+		}
+	}
+
+	if (self->vfree) {
+		self->vfree(slot->value __ENV_CARGS);
+	}
+	-- self->count;
+	ret = 0;
+
+	/* backward shift, no tombstones */
+	for (j = (i + 1) & self->mask; self->slots[j].key != 0; j = (j + 1) & self->mask) {
+		h = _yod_imap_hash(self->slots[j].key) & self->mask;
+		if ((j > i && (h <= i || h > j)) || (j < i && (h <= i && h > j))) {
+			self->slots[i] = self->slots[j];
+			i = j;
+		}
+	}
+	self->slots[i].key = 0;
+	self->slots[i].value = NULL;
+
+	/* shrink */
+	if ((self->size > YOD_IMAP_MIN_SIZE) && (self->count < (self->size >> 3))) {
+		for (size = YOD_IMAP_MIN_SIZE; size < (self->count << 2); size <<= 1);
+		_yod_imap_resize(self, size __ENV_CARGS);
+	}
+
+e_return:
+
+	pthread_mutex_unlock(&self->lock);
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_imap_find(yod_imap_t *self, uint64_t key __ENV_CPARM)
+*/
+void *_yod_imap_find(yod_imap_t *self, uint64_t key __ENV_CPARM)
+{
+	yod_imap_v *slot = NULL;
+	void *value = NULL;
+	ulong i = 0;
+
+	if (!self) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&self->lock);
+	if (key == 0) {
+		value = self->zero;
+	} else {
+		for (i = _yod_imap_hash(key) & self->mask; ; i = (i + 1) & self->mask) {
+			slot = &self->slots[i];
+			if (slot->key == key) {
+				value = slot->value;
+				break;
+			}
+			if (slot->key == 0) {
+				break;
+			}
+		}
+	}
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_IMAP_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu): %p in %s:%d %s",
+		__FUNCTION__, self, (ulong) key, value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ ulong _yod_imap_count(yod_imap_t *self __ENV_CPARM)
+*/
+ulong _yod_imap_count(yod_imap_t *self __ENV_CPARM)
+{
+	if (!self) {
+		return 0;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && (_YOD_IMAP_DEBUG & 0x02))
+	yod_stdlog_debug(NULL, "%s(%p): %lu in %s:%d %s",
+		__FUNCTION__, self, self->count, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return self->count;
+}
+/* }}} */
+
+
+/** {{{ int _yod_imap_visit(yod_imap_t *self, yod_imap_fn func, void *arg __ENV_CPARM)
+*/
+int _yod_imap_visit(yod_imap_t *self, yod_imap_fn func, void *arg __ENV_CPARM)
+{
+	ulong i = 0;
+	int ret = 0;
+
+	if (!self || !func) {
+		return (-1);
+	}
+
+	/* func must not call back into the map */
+	pthread_mutex_lock(&self->lock);
+	if (self->has_zero) {
+		ret = func(0, self->zero, arg __ENV_CARGS);
+	}
+	for (i = 0; ret == 0 && i < self->size; ++i) {
+		if (self->slots[i].key) {
+			ret = func(self->slots[i].key, self->slots[i].value, arg __ENV_CARGS);
+		}
+	}
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_IMAP_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p, %p): %d in %s:%d %s",
+		__FUNCTION__, self, func, arg, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ static int _yod_imap_resize(yod_imap_t *self, ulong size __ENV_CPARM)
+*/
+static int _yod_imap_resize(yod_imap_t *self, ulong size __ENV_CPARM)
+{
+	yod_imap_v *slots = NULL;
+	ulong mask = size - 1;
+	ulong i = 0;
+	ulong j = 0;
+
+	slots = (yod_imap_v *) calloc(size, sizeof(yod_imap_v));
+	if (!slots) {
+		YOD_STDLOG_ERROR("calloc failed");
+		return (-1);
+	}
+
+	for (i = 0; i < self->size; ++i) {
+		if (self->slots[i].key == 0) {
+			continue;
+		}
+		for (j = _yod_imap_hash(self->slots[i].key) & mask; slots[j].key != 0; j = (j + 1) & mask);
+		slots[j] = self->slots[i];
+	}
+
+	free(self->slots);
+	self->slots = slots;
+	self->mask = mask;
+	self->size = size;
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_IMAP_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu): {count=%lu} in %s:%d %s",
+		__FUNCTION__, self, size, self->count, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (0);
+}
+/* }}} */
+
+
+/** {{{ static ulong _yod_imap_hash(uint64_t key)
+*/
+static ulong _yod_imap_hash(uint64_t key)
+{
+	/* murmur3 finalizer, sequential ids spread over the whole table */
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+
+	return (ulong) key;
+}
+/* }}} */
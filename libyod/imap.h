@@ -0,0 +1,37 @@
+#ifndef __YOD_IMAP_H__
+#define __YOD_IMAP_H__
+
+#include "system.h"
+
+
+/* yod_imap_t */
+typedef struct _yod_imap_t 										yod_imap_t;
+
+/* yod_imap_fn */
+typedef int (*yod_imap_fn) (uint64_t key, void *value, void *arg __ENV_CPARM);
+
+
+#define yod_imap_new(f) 										_yod_imap_new(f __ENV_CARGS)
+#define yod_imap_reset(x) 										_yod_imap_reset(x __ENV_CARGS)
+#define yod_imap_free(x) 										_yod_imap_free(x __ENV_CARGS)
+
+#define yod_imap_add(x, k, v) 									_yod_imap_add(x, k, v, 1 __ENV_CARGS)
+#define yod_imap_del(x, k) 										_yod_imap_del(x, k __ENV_CARGS)
+#define yod_imap_find(x, k) 									_yod_imap_find(x, k __ENV_CARGS)
+
+#define yod_imap_count(x) 										_yod_imap_count(x __ENV_CARGS)
+#define yod_imap_visit(x, f, a) 								_yod_imap_visit(x, f, a __ENV_CARGS)
+
+
+yod_imap_t *_yod_imap_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM);
+void _yod_imap_free(yod_imap_t *self __ENV_CPARM);
+int _yod_imap_reset(yod_imap_t *self __ENV_CPARM);
+
+int _yod_imap_add(yod_imap_t *self, uint64_t key, void *value, int force __ENV_CPARM);
+int _yod_imap_del(yod_imap_t *self, uint64_t key __ENV_CPARM);
+void *_yod_imap_find(yod_imap_t *self, uint64_t key __ENV_CPARM);
+
+ulong _yod_imap_count(yod_imap_t *self __ENV_CPARM);
+int _yod_imap_visit(yod_imap_t *self, yod_imap_fn func, void *arg __ENV_CPARM);
+
+#endif
@@ -6,6 +6,9 @@
 #include <direct.h>
 #else
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #endif
 #include <math.h>
 #include <errno.h>
@@ -18,7 +21,29 @@
 #define _YOD_JVALUE_DEBUG 										0
 #endif
 
+#ifndef _YOD_JVALUE_SIMD
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+#define _YOD_JVALUE_SIMD 										1
+#else
+#define _YOD_JVALUE_SIMD 										0
+#endif
+#endif
+
+#if (_YOD_JVALUE_SIMD)
+#include <immintrin.h>
+#endif
+
 #define YOD_JVALUE_MAX_SIZE 									0xFFFFFFF7
+#define YOD_JVALUE_ARENA_SIZE 									4096
+#define YOD_JVALUE_DECODE_SIZE 									256
+#define YOD_JVALUE_DECODE_NONAME 								((size_t) -1)
+#define YOD_JVALUE_DECODE_NOPOS 								((size_t) -1)
+#define YOD_JVALUE_DECODE_TAIL 									64
+#define YOD_JVALUE_INDEX_MIN 									16
+#define YOD_JVALUE_ENCODE_SIZE 									4096
+#define YOD_JVALUE_ENCODE_DEPTH 								32
+
+#define YOD_JVALUE_ALIGN(z) 									(((z) + 7) & ~((size_t) 7))
 
 
 /* yod_jvalue_v */
@@ -26,16 +51,145 @@ typedef struct
 {
 	char *name;
 	size_t name_len;
+	uint32_t hash;
 
 	yod_jvalue_t *value;
 } yod_jvalue_v;
 
 
+/* yod_jvalue_a */
+typedef struct _yod_jvalue_a
+{
+	struct _yod_jvalue_a *next;
+	struct _yod_jvalue_a *tail;
+	size_t size;
+	size_t used;
+} yod_jvalue_a;
+
+
+/* yod_jvalue_e */
+typedef struct
+{
+	size_t name;
+	size_t name_len;
+
+	yod_jvalue_t *value;
+} yod_jvalue_e;
+
+
+/* yod_jvalue_i */
+typedef struct
+{
+	size_t open;
+	size_t close;
+} yod_jvalue_i;
+
+
+/* yod_jvalue_m */
+typedef struct
+{
+	char *data;
+	size_t size;
+	size_t start;
+
+	/* every { and [ of the root in document order, with its closing offset */
+	yod_jvalue_i *index;
+	size_t count;
+
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE map;
+#endif
+} yod_jvalue_m;
+
+
+/* yod_jvalue_d */
+typedef struct _yod_jvalue_d
+{
+	int opts;
+	int closed;
+
+	yod_jvalue_a *arena;
+	yod_jvalue_t *top;
+	yod_jvalue_t *root;
+
+	/* event mode, see _yod_jvalue_parse */
+	yod_jvalue_fn func;
+	void *arg;
+	int stop;
+	yod_jvalue_t *spare;
+
+	/* lazy mode, see _yod_jvalue_mapped_read */
+	yod_jvalue_m *doc;
+	size_t doc_off;
+
+	yod_jvalue_e *stack;
+	size_t stack_size;
+	size_t count;
+
+	char *names;
+	size_t names_size;
+	size_t names_len;
+
+	char *buf;
+	size_t buf_size;
+
+	/* where _yod_jvalue_decode_run stopped */
+	long flags;
+	uint32_t line;
+	uint32_t col;
+	size_t str_len;
+	long num_digits;
+	long num_e;
+	int64_t num_fraction;
+	size_t num_pos;
+	size_t pos;
+	size_t keep;
+	size_t total;
+
+	/* input held back for the next chunk */
+	char *tail;
+	size_t tail_size;
+	size_t tail_len;
+} yod_jvalue_d;
+
+
+/* yod_jvalue_s */
+typedef struct
+{
+	yod_jvalue_t *value;
+	size_t index;
+} yod_jvalue_s;
+
+
+/* yod_jvalue_w */
+typedef struct
+{
+	int mode;
+	int failed;
+
+	/* sink mode, see _yod_jvalue_write */
+	yod_jvalue_sink_fn func;
+	void *arg;
+
+	char *data;
+	size_t size;
+	size_t len;
+
+	/* open containers, the tree itself is never touched */
+	yod_jvalue_s *stack;
+	size_t stack_size;
+	size_t count;
+	yod_jvalue_s frames[YOD_JVALUE_ENCODE_DEPTH];
+} yod_jvalue_w;
+
+
 /* yod_jvalue_t */
 struct _yod_jvalue_t
 {
 	yod_jvalue_t *parent;
 	int type;
+	int flags;
 
 	union
 	{
@@ -100,10 +254,86 @@ enum
 };
 
 
-static int _yod_jvalue_decode_new(int first_pass, yod_jvalue_t **top, yod_jvalue_t** root, yod_jvalue_t **alloc, int type);
+enum
+{
+	YOD_JVALUE_NODE_ARENA = 0x01,
+	YOD_JVALUE_NODE_ROOT = 0x02,
+	YOD_JVALUE_NODE_INDEX = 0x04,
+	YOD_JVALUE_NODE_INSERT = 0x08,
+	YOD_JVALUE_NODE_LAZY = 0x10,
+	YOD_JVALUE_NODE_MAPPED = 0x20,
+	YOD_JVALUE_NODE_BORROW = 0x40,
+	YOD_JVALUE_NODE_ORDER = 0x80,
+};
+
+
+enum
+{
+	YOD_JVALUE_WRITE_COUNT,
+	YOD_JVALUE_WRITE_BUFFER,
+	YOD_JVALUE_WRITE_GROW,
+	YOD_JVALUE_WRITE_SINK
+};
+
+
+static int _yod_jvalue_decode_new(yod_jvalue_d *ctx, yod_jvalue_t **top, yod_jvalue_t **root, int type);
+static int _yod_jvalue_decode_push(yod_jvalue_d *ctx, yod_jvalue_t *value, char *name, size_t name_len);
+static int _yod_jvalue_decode_end(yod_jvalue_d *ctx, yod_jvalue_t *value);
+static void _yod_jvalue_decode_init(yod_jvalue_d *ctx, int opts);
+static int _yod_jvalue_decode_run(yod_jvalue_d *ctx, const char *data, size_t len, int last, char *err);
+static yod_jvalue_t *_yod_jvalue_decode_root(yod_jvalue_d *ctx);
+static void _yod_jvalue_decode_clear(yod_jvalue_d *ctx);
+static void _yod_jvalue_decode_free(yod_jvalue_d *ctx);
+static int _yod_jvalue_decode_hold(yod_jvalue_d *ctx, const char *data, size_t len);
+static void _yod_jvalue_decode_move(yod_jvalue_d *ctx, size_t len);
+static int _yod_jvalue_decode_emit(yod_jvalue_d *ctx, yod_jvalue_t *value, int event);
+static void _yod_jvalue_decode_drop(yod_jvalue_d *ctx, yod_jvalue_t *value);
+static void *_yod_jvalue_decode_alloc(yod_jvalue_d *ctx, size_t size);
+static void *_yod_jvalue_decode_grow(void *ptr, size_t *size, size_t need);
+static size_t _yod_jvalue_decode_lazy(yod_jvalue_d *ctx, yod_jvalue_t *value, size_t pos);
+static const char *_yod_jvalue_decode_space(const char *jptr, const char *jend, char b, uint32_t *line, uint32_t *col);
+static void _yod_jvalue_scan_init(void);
+static const char *_yod_jvalue_scan_plain(const char *ptr, const char *end);
+static const char *_yod_jvalue_scan_space(const char *ptr, const char *end);
+#if (_YOD_JVALUE_SIMD)
+static const char *_yod_jvalue_scan_plain_sse42(const char *ptr, const char *end);
+static const char *_yod_jvalue_scan_space_sse42(const char *ptr, const char *end);
+static const char *_yod_jvalue_scan_plain_avx2(const char *ptr, const char *end);
+static const char *_yod_jvalue_scan_space_avx2(const char *ptr, const char *end);
+#endif
+static yod_jvalue_a *_yod_jvalue_arena_new(size_t size);
+static void *_yod_jvalue_arena_alloc(yod_jvalue_a *self, size_t size);
+static void _yod_jvalue_arena_free(yod_jvalue_a *self);
+static yod_jvalue_m *_yod_jvalue_mapped_load(const char *file);
+static int _yod_jvalue_mapped_check(int event, const char *name, size_t name_len, yod_jvalue_t *value, void *arg __ENV_CPARM);
+static yod_jvalue_m *_yod_jvalue_mapped_open(const char *path);
+static int _yod_jvalue_mapped_index(yod_jvalue_m *doc);
+static yod_jvalue_i *_yod_jvalue_mapped_find(yod_jvalue_m *doc, size_t pos);
+static int _yod_jvalue_mapped_read(yod_jvalue_t *self, char *err);
+static void _yod_jvalue_mapped_free(yod_jvalue_m *doc);
+static void _yod_jvalue_encode_init(yod_jvalue_w *enc, int mode);
+static int _yod_jvalue_encode_run(yod_jvalue_w *enc, yod_jvalue_t *self);
+static void _yod_jvalue_encode_free(yod_jvalue_w *enc);
+static int _yod_jvalue_encode_push(yod_jvalue_w *enc, yod_jvalue_t *value);
+static void _yod_jvalue_encode_put(yod_jvalue_w *enc, const char *str, size_t len);
+static void _yod_jvalue_encode_text(yod_jvalue_w *enc, char *str, size_t len);
+static char *_yod_jvalue_encode_reserve(yod_jvalue_w *enc, size_t need);
+static int _yod_jvalue_encode_flush(yod_jvalue_w *enc);
+static int _yod_jvalue_encode_sink(yod_jvalue_t *self, yod_jvalue_sink_fn func, void *arg, int (*run) (yod_jvalue_w *, yod_jvalue_t *));
+static int _yod_jvalue_pack_run(yod_jvalue_w *enc, yod_jvalue_t *self);
+static void _yod_jvalue_pack_head(yod_jvalue_w *enc, int type, size_t len);
+static void _yod_jvalue_pack_set(byte *data, uint64_t num, int size);
+static uint64_t _yod_jvalue_pack_get(const byte *data, int size);
+static int _yod_jvalue_unpack_run(yod_jvalue_d *ctx, char *data, size_t len, char *err);
 static size_t _yod_jvalue_encode_string(char *str, size_t len, char *data);
 static size_t _yod_jvalue_encode_strlen(char *str, size_t len);
 static int _yod_jvalue_object_find(yod_jvalue_t *self, char *name, size_t *index, int force);
+static uint32_t _yod_jvalue_object_hash(const char *name);
+static size_t _yod_jvalue_object_slots(size_t size);
+static void _yod_jvalue_object_index(yod_jvalue_t *self);
+static size_t _yod_jvalue_object_at(yod_jvalue_t *self, size_t index);
+static void _yod_jvalue_object_sort(yod_jvalue_t *self);
+static int _yod_jvalue_object_cmp(const void *a, const void *b);
 
 
 #define __JVF_NEXT 												YOD_JVALUE_FLAG_NEXT
@@ -123,6 +353,25 @@ static int _yod_jvalue_object_find(yod_jvalue_t *self, char *name, size_t *index
 #define __JVF_LINE_COMMENT										YOD_JVALUE_FLAG_LINE_COMMENT
 #define __JVF_BLOCK_COMMENT										YOD_JVALUE_FLAG_BLOCK_COMMENT
 
+/* scanners picked for this cpu by _yod_jvalue_scan_init */
+static const char *(*yod_jvalue_scan_plain__) (const char *ptr, const char *end) = NULL;
+static const char *(*yod_jvalue_scan_space__) (const char *ptr, const char *end) = NULL;
+
+
+#define __JVN_ARENA 											YOD_JVALUE_NODE_ARENA
+#define __JVN_ROOT 												YOD_JVALUE_NODE_ROOT
+#define __JVN_INDEX 											YOD_JVALUE_NODE_INDEX
+#define __JVN_INSERT 											YOD_JVALUE_NODE_INSERT
+#define __JVN_LAZY 												YOD_JVALUE_NODE_LAZY
+#define __JVN_MAPPED 											YOD_JVALUE_NODE_MAPPED
+#define __JVN_BORROW 											YOD_JVALUE_NODE_BORROW
+#define __JVN_ORDER 											YOD_JVALUE_NODE_ORDER
+
+#define __JVW_COUNT 											YOD_JVALUE_WRITE_COUNT
+#define __JVW_BUFFER 											YOD_JVALUE_WRITE_BUFFER
+#define __JVW_GROW 												YOD_JVALUE_WRITE_GROW
+#define __JVW_SINK 												YOD_JVALUE_WRITE_SINK
+
 
 /** {{{ yod_jvalue_t *_yod_jvalue_new(__ENV_PARM)
 */
@@ -138,6 +387,7 @@ yod_jvalue_t *_yod_jvalue_new(__ENV_PARM)
 
 	self->type = __JVT_NULL;
 	self->parent = NULL;
+	self->flags = 0;
 
 	self->_reserved.u.ptr = NULL;
 	self->_reserved.index = 0;
@@ -171,6 +421,14 @@ void _yod_jvalue_free(yod_jvalue_t *self __ENV_CPARM)
 	__ENV_VOID
 #endif
 
+	/* arena nodes are released with their root, all at once */
+	if (self->flags & __JVN_ARENA) {
+		if (self->flags & __JVN_ROOT) {
+			_yod_jvalue_arena_free(((yod_jvalue_a *) self) - 1);
+		}
+		return;
+	}
+
 	switch (self->type) {
 		case __JVT_OBJECT:
 			if (self->u.object.data.ptr) {
@@ -189,12 +447,16 @@ void _yod_jvalue_free(yod_jvalue_t *self __ENV_CPARM)
 			}
 			break;
 		case __JVT_STRING:
-			if (self->u.string.ptr) {
+			if (self->u.string.ptr && !(self->flags & __JVN_BORROW)) {
 				free(self->u.string.ptr);
 			}
 			break;
 	}
 
+	if (self->flags & __JVN_MAPPED) {
+		_yod_jvalue_mapped_free((yod_jvalue_m *) self->_reserved.u.ptr);
+	}
+
 	free(self);
 }
 /* }}} */
@@ -229,64 +491,74 @@ int _yod_jvalue_type(yod_jvalue_t *self __ENV_CPARM)
 yod_jvalue_t *_yod_jvalue_load(const char *file, char *err __ENV_CPARM)
 {
 	yod_jvalue_t *self = NULL;
-	char cwd[256], path[256];
-	FILE *fp = NULL;
-	char *data = NULL;
-	long len = 0;
+	yod_jvalue_m *doc = NULL;
 
-	if (!file) {
-		errno = EINVAL;
-		YOD_STDLOG_WARN("invalid argument");
+	if ((doc = _yod_jvalue_mapped_load(file)) == NULL) {
 		return NULL;
 	}
 
-	if (*file == '/' || *(file + 1) == ':') {
-		strcpy(path, file);
-	} else {
-		if (getcwd(cwd, sizeof(cwd)) == NULL) {
-			YOD_STDLOG_ERROR("getcwd failed");
-			return NULL;
-		}
-
-		if (snprintf(path, sizeof(path), "%s/%s", cwd, file) == -1) {
-			YOD_STDLOG_ERROR("snprintf failed");
-			return NULL;
-		}
-	}
+	self = yod_jvalue_decode(doc->data + doc->start, doc->size - doc->start, err);
+	_yod_jvalue_mapped_free(doc);
 
-#ifdef _WIN32
-	if (fopen_s(&fp, path, "rb") != 0)
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%s): %p in %s:%d %s",
+		__FUNCTION__, file, self, __ENV_TRACE);
 #else
-	if ((fp = fopen(path, "rb")) == NULL)
+	__ENV_VOID
 #endif
-	{
-		YOD_STDLOG_ERROR("fopen failed");
+
+	return self;
+}
+/* }}} */
+
+
+/** {{{ yod_jvalue_t *_yod_jvalue_load_lazy(const char *file, char *err __ENV_CPARM)
+*/
+yod_jvalue_t *_yod_jvalue_load_lazy(const char *file, char *err __ENV_CPARM)
+{
+	yod_jvalue_t *self = NULL;
+	yod_jvalue_m *doc = NULL;
+	const char *data = NULL;
+
+	if ((doc = _yod_jvalue_mapped_load(file)) == NULL) {
 		return NULL;
 	}
+	data = doc->data;
 
-	fseek(fp, 0L, SEEK_END);
-	len = ftell(fp);
-
-	data = (char *) malloc((len + 1) * sizeof(char));
-	if (!data) {
-		YOD_STDLOG_ERROR("malloc failed");
-		goto e_failed;
+	/* the whole document is checked now, so its errors reach err and
+	 * reading a container later cannot fail */
+	if (yod_jvalue_parse(doc->data + doc->start, doc->size - doc->start, _yod_jvalue_mapped_check, NULL, err) != 0) {
+		_yod_jvalue_mapped_free(doc);
+		goto e_done;
 	}
 
-	fseek(fp, 0L, SEEK_SET);
-	if (len != (long) fread(data, sizeof(char), len, fp)) {
-		YOD_STDLOG_ERROR("fread failed");
-		goto e_failed;
+	/* a container at the root is read level by level on first use,
+	 * anything else is decoded at once */
+	if (_yod_jvalue_mapped_index(doc) != 0 || !yod_jvalue_scan_space__
+		|| yod_jvalue_scan_space__(data + doc->start, data + doc->index[0].open) != data + doc->index[0].open)
+	{
+		self = yod_jvalue_decode(doc->data + doc->start, doc->size - doc->start, err);
+		_yod_jvalue_mapped_free(doc);
+		goto e_done;
 	}
 
-	self = yod_jvalue_decode(data, len, err);
+	if ((self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t))) == NULL) {
+		YOD_STDLOG_ERROR("malloc failed");
+		_yod_jvalue_mapped_free(doc);
+		goto e_done;
+	}
 
-e_failed:
+	memset(self, 0, sizeof(yod_jvalue_t));
+	self->type = (data[doc->index[0].open] == '{') ? __JVT_OBJECT : __JVT_ARRAY;
+	self->flags = __JVN_MAPPED | __JVN_LAZY;
+	self->_reserved.u.ptr = doc;
 
-	if (data) {
-		free(data);
+	if (_yod_jvalue_mapped_read(self, err) != 0) {
+		yod_jvalue_free(self);
+		self = NULL;
 	}
-	fclose(fp);
+
+e_done:
 
 #if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
 	yod_stdlog_debug(NULL, "%s(%s): %p in %s:%d %s",
@@ -311,6 +583,7 @@ yod_jvalue_t *_yod_jvalue_clone(yod_jvalue_t *self __ENV_CPARM)
 	yod_jvalue_t *parent = NULL;
 	yod_jvalue_t *clone = NULL;
 	size_t data_len = 0;
+	size_t slot_len = 0;
 	size_t name_len = 0;
 	int alloc = 0;
 
@@ -322,6 +595,9 @@ yod_jvalue_t *_yod_jvalue_clone(yod_jvalue_t *self __ENV_CPARM)
 
 	while (value) {
 		alloc = 0;
+		if (value->flags & __JVN_LAZY) {
+			_yod_jvalue_mapped_read(value, NULL);
+		}
 		if (value->type == __JVT_OBJECT || value->type == __JVT_ARRAY) {
 			alloc = (int) value->_reserved.index;
 		}
@@ -329,6 +605,7 @@ yod_jvalue_t *_yod_jvalue_clone(yod_jvalue_t *self __ENV_CPARM)
 			if ((clone = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t))) != NULL) {
 				clone->type = __JVT_NULL;
 				clone->parent = parent;
+				clone->flags = 0;
 
 				clone->_reserved.u.ptr = NULL;
 				clone->_reserved.index = 0;
@@ -343,13 +620,20 @@ yod_jvalue_t *_yod_jvalue_clone(yod_jvalue_t *self __ENV_CPARM)
 				case __JVT_OBJECT:
 					if (value->_reserved.index == 0) {
 						clone->type = __JVT_OBJECT;
+						clone->flags = value->flags & (__JVN_INDEX | __JVN_INSERT | __JVN_ORDER);
 						clone->u.object.count = 0;
 						clone->u.object.size = value->u.object.size;
 						data_len = (value->u.object.size + 1) * sizeof(yod_jvalue_v);
-						name_len = value->u.object.data.ptr[value->u.object.size].name_len;
-						clone->u.object.data.ptr = malloc(data_len + name_len);
+						slot_len = (value->flags & __JVN_INDEX) ? _yod_jvalue_object_slots(value->u.object.size) * sizeof(uint32_t) : 0;
+						if (value->flags & __JVN_ORDER) {
+							slot_len += value->u.object.size * sizeof(uint32_t);
+						}
+						name_len = value->u.object.data.ptr ? value->u.object.data.ptr[value->u.object.size].name_len : 0;
+						clone->u.object.data.ptr = value->u.object.data.ptr ? malloc(data_len + slot_len + name_len) : NULL;
 						if (clone->u.object.data.ptr) {
-							clone->u.object.data.ptr[clone->u.object.size].name = (char *) clone->u.object.data.ptr + data_len;
+							/* members keep their places, so do the index and order */
+							memcpy((char *) clone->u.object.data.ptr + data_len, (char *) value->u.object.data.ptr + data_len, slot_len);
+							clone->u.object.data.ptr[clone->u.object.size].name = (char *) clone->u.object.data.ptr + data_len + slot_len;
 							clone->u.object.data.ptr[clone->u.object.size].name_len = name_len;
 							clone->u.object.data.ptr[clone->u.object.size].value = NULL;
 						}
@@ -369,6 +653,7 @@ yod_jvalue_t *_yod_jvalue_clone(yod_jvalue_t *self __ENV_CPARM)
 						clone->u.object.data.ptr[clone->u.object.count].name = clone->u.object.data.ptr[clone->u.object.size].name;
 						memcpy(clone->u.object.data.ptr[clone->u.object.count].name, vitem.name, vitem.name_len + 1);
 						clone->u.object.data.ptr[clone->u.object.count].name_len = vitem.name_len;
+						clone->u.object.data.ptr[clone->u.object.count].hash = vitem.hash;
 						clone->u.object.data.ptr[clone->u.object.count].value = NULL;
 
 						clone->u.object.data.ptr[clone->u.object.size].name += vitem.name_len + 1;
@@ -399,7 +684,7 @@ yod_jvalue_t *_yod_jvalue_clone(yod_jvalue_t *self __ENV_CPARM)
 					item = value->u.array.data[value->_reserved.index ++];
 
 					if (clone->u.array.data) {
-						clone->u.array.data[self->u.array.count] = NULL;
+						clone->u.array.data[clone->u.array.count] = NULL;
 					}
 
 					if (item) {
@@ -479,18 +764,27 @@ yod_jvalue_t *_yod_jvalue_clone(yod_jvalue_t *self __ENV_CPARM)
 */
 char *_yod_jvalue_dump(yod_jvalue_t *self __ENV_CPARM)
 {
-	size_t len = 0;
+	yod_jvalue_w enc;
+	char *ptr = NULL;
 	char *ret = NULL;
 
 	if (!self) {
 		return NULL;
 	}
 
-	len = yod_jvalue_encode(NULL, self);
-	if ((ret = (char *) malloc(len * sizeof(char))) != NULL) {
-		yod_jvalue_encode(ret, self);
+	/* one pass, the buffer grows as it goes */
+	_yod_jvalue_encode_init(&enc, __JVW_GROW);
+
+	if (_yod_jvalue_encode_run(&enc, self) == 0) {
+		if ((ptr = _yod_jvalue_encode_reserve(&enc, 1)) != NULL) {
+			*ptr = '\0';
+			ret = enc.data;
+			enc.data = NULL;
+		}
 	}
 
+	_yod_jvalue_encode_free(&enc);
+
 #if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
 	yod_stdlog_debug(NULL, "%s(%p): %p in %s:%d %s",
 		__FUNCTION__, self, ret, __ENV_TRACE);
@@ -507,11 +801,7 @@ char *_yod_jvalue_dump(yod_jvalue_t *self __ENV_CPARM)
 */
 size_t _yod_jvalue_encode(char *data, yod_jvalue_t *self __ENV_CPARM)
 {
-	yod_jvalue_t *value = self;
-	yod_jvalue_v vitem = {0};
-	yod_jvalue_t *item = NULL;
-	int64_t num1, num2;
-	char tmp[20], *ptr, *dot;
+	yod_jvalue_w enc;
 	size_t ret = 0;
 
 	if (!self) {
@@ -520,218 +810,54 @@ size_t _yod_jvalue_encode(char *data, yod_jvalue_t *self __ENV_CPARM)
 		return (0);
 	}
 
-	while (value) {
-		switch (value->type) {
-			case __JVT_OBJECT:
-				if (value->_reserved.index == 0) {
-					if (data) {
-						data[ret] = '{';
-					}
-					++ ret;
-					if (value->u.object.count == 0) {
-						if (data) {
-							data[ret] = '}';
-						}
-						++ ret;
-						break;
-					}
-				}
-
-				if (value->_reserved.index == value->u.object.count) {
-					if (data) {
-						data[ret] = '}';
-					}
-					++ ret;
-					value->_reserved.index = 0;
-					break;
-				}
-
-				if (value->_reserved.index > 0) {
-					if (data) {
-						data[ret] = ',';
-					}
-					++ ret;
-				}
-
-				vitem = value->u.object.data.ptr[value->_reserved.index ++];
-
-				if (data) {
-					data[ret ++] = '\"';
-					ret += _yod_jvalue_encode_string(vitem.name, vitem.name_len, data + ret);
-					data[ret ++] = '\"';
-					data[ret ++] = ':';
-					if (!vitem.value) {
-						memcpy(data + ret, "null", 4);
-						ret += 4;
-					}
-				}
-				else {
-					ret += _yod_jvalue_encode_strlen(vitem.name, vitem.name_len) + 3;
-					if (!vitem.value) {
-						ret += 4;
-					}
-				}
-
-				if (vitem.value) {
-					value = vitem.value;
-				}
-				continue;
-
-			case __JVT_ARRAY:
-				if (value->_reserved.index == 0) {
-					if (data) {
-						data[ret] = '[';
-					}
-					++ ret;
-					if (value->u.array.count == 0) {
-						if (data) {
-							data[ret] = ']';
-						}
-						++ ret;
-						break;
-					}
-				}
-
-				if (value->_reserved.index == value->u.array.count) {
-					if (data) {
-						data[ret] = ']';
-					}
-					++ ret;
-					value->_reserved.index = 0;
-					break;
-				}
-
-				if (value->_reserved.index > 0) {
-					if (data) {
-						data[ret] = ',';
-					}
-					++ ret;
-				}
-
-				item = value->u.array.data[value->_reserved.index ++];
-
-				if (!item) {
-					if (data) {
-						memcpy(data + ret, "null", 4);
-					}
-					ret += 4;
-				}
-				else {
-					value = item;
-				}
-				continue;
-
-			case __JVT_STRING:
-				if (data) {
-					data[ret ++] = '\"';
-					ret += _yod_jvalue_encode_string(value->u.string.ptr, value->u.string.len, data + ret);
-					data[ret ++] = '\"';
-				}
-				else {
-					ret += _yod_jvalue_encode_strlen(value->u.string.ptr, value->u.string.len) + 2;
-				}
-				break;
-
-			case __JVT_INTEGER:
-				num1 = value->u.ival;
-
-				if (num1 < 0) {
-					if (data) {
-						data[ret] = '-';
-					}
-					++ ret;
-					num1 = - num1;
-				}
-				num2 = num1;
-
-				++ ret;
-				while (num1 >= 10) {
-					++ ret;
-					num1 /= 10;
-				}
+	/* without data only the size is counted */
+	_yod_jvalue_encode_init(&enc, data ? __JVW_BUFFER : __JVW_COUNT);
+	enc.data = data;
 
-				if (data) {
-					num1 = num2;
-					ptr = data + ret;
-					do {
-						*-- ptr = "0123456789"[num1 % 10];
-					} while ((num1 /= 10) > 0);
-				}
+	if (_yod_jvalue_encode_run(&enc, self) == 0) {
+		if (data) {
+			data[enc.len] = '\0';
+		}
+		ret = enc.len + 1;
+	}
 
-				break;
+	enc.data = NULL;
+	_yod_jvalue_encode_free(&enc);
 
-			case __JVT_DOUBLE:
-				if (data) {
-					ptr = data + ret;
-#ifdef _WIN32
-					ret += sprintf_s(ptr, 20, "%lg", value->u.dval);
-#else
-					ret += sprintf(ptr, "%lg", value->u.dval);
-#endif
-					if ((dot = strchr(ptr, ',')) != NULL) {
-						*dot = '.';
-					}
-					else if (!strchr (ptr, '.')) {
-						data[ret ++] = '.';
-						data[ret ++] = '0';
-					}
-				}
-				else {
-#ifdef _WIN32
-					ret += sprintf_s(tmp, 20, "%lg", value->u.dval);
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p): %d in %s:%d %s",
+		__FUNCTION__, data, self, ret, __ENV_TRACE);
 #else
-					ret += sprintf(tmp, "%lg", value->u.dval);
+	__ENV_VOID
 #endif
-					if (!strchr(tmp, ',') && !strchr (tmp, '.')) {
-						ret += 2;
-					}
-				}
-				break;
 
-			case __JVT_BOOLEAN:
-				if (data) {
-					ptr = data + ret;
-					if (value->u.bval) {
-						memcpy(ptr, "true", 4);
-						ret += 4;
-					}
-					else {
-						memcpy(ptr, "false", 5);
-						ret += 5;
-					}
-				}
-				else {
-					ret += value->u.bval ? 4 : 5;
-				}
-				break;
+	return ret;
+}
+/* }}} */
 
-			case __JVT_NULL:
-				if (data) {
-					memcpy(data + ret, "null", 4);
-				}
-				ret += 4;
-				break;
 
-			default:
-				break;
-		};
+/** {{{ int _yod_jvalue_write(yod_jvalue_t *self, yod_jvalue_sink_fn func, void *arg __ENV_CPARM)
+*/
+int _yod_jvalue_write(yod_jvalue_t *self, yod_jvalue_sink_fn func, void *arg __ENV_CPARM)
+{
+	int ret = -1;
 
-		value = value->parent;
+	if (!self || !func) {
+		errno = EINVAL;
+		YOD_STDLOG_WARN("invalid argument");
+		return (-1);
 	}
 
-	if (data) {
-		data[ret] = '\0';
-	}
-	++ ret;
+	ret = _yod_jvalue_encode_sink(self, func, arg, _yod_jvalue_encode_run);
 
 #if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %p): %d in %s:%d %s",
-		__FUNCTION__, data, self, ret, __ENV_TRACE);
+	yod_stdlog_debug(NULL, "%s(%p, %p, %p): %d in %s:%d %s",
+		__FUNCTION__, self, func, arg, ret, __ENV_TRACE);
 #else
 	__ENV_VOID
 #endif
 
-	return ret;
+	return (ret);
 }
 /* }}} */
 
@@ -740,14 +866,17 @@ size_t _yod_jvalue_encode(char *data, yod_jvalue_t *self __ENV_CPARM)
 */
 yod_jvalue_t *_yod_jvalue_decode(char *data, size_t len, char *err __ENV_CPARM)
 {
-	yod_jvalue_t *top, *root, *alloc = NULL;
-	yod_jvalue_t *parent = NULL;
-	long num_digits = 0, num_e = 0;
-	int64_t num_fraction = 0;
-	uint32_t curr_line, curr_col;
-	const char *jptr, *jend, *jnum;
-	int first_pass;
-	long flags;
+	return _yod_jvalue_decode_ex(data, len, err, 0 __ENV_CARGS);
+}
+/* }}} */
+
+
+/** {{{ yod_jvalue_t *_yod_jvalue_decode_ex(char *data, size_t len, char *err, int opts __ENV_CPARM)
+*/
+yod_jvalue_t *_yod_jvalue_decode_ex(char *data, size_t len, char *err, int opts __ENV_CPARM)
+{
+	yod_jvalue_d ctx;
+	yod_jvalue_t *root = NULL;
 
 	if (!data || !len) {
 		return NULL;
@@ -759,1833 +888,4199 @@ yod_jvalue_t *_yod_jvalue_decode(char *data, size_t len, char *err __ENV_CPARM)
 		len -= 3;
 	}
 
-	jend = (data + len);
-	jnum = NULL;
+	_yod_jvalue_decode_init(&ctx, opts);
 
-	for (first_pass = 1; first_pass >= 0; -- first_pass) {
-		byte uc_b1, uc_b2, uc_b3, uc_b4;
-		uint32_t uc1, uc2;
-		char *str = NULL;
-		size_t str_len = 0;
+	if (opts & __JVD_ARENA) {
+		ctx.arena = _yod_jvalue_arena_new(len * 2);
+		if (!ctx.arena) {
+			return NULL;
+		}
+	}
 
-		top = root = NULL;
-		flags = __JVF_SEEK_VALUE;
+	if (_yod_jvalue_decode_run(&ctx, data, len, 1, err) > 0) {
+		root = _yod_jvalue_decode_root(&ctx);
+	}
 
-		curr_line = 1;
-		curr_col = 0;
+	_yod_jvalue_decode_free(&ctx);
 
-		for (jptr = data; ; ++ jptr) {
-			char b = (jptr == jend ? 0 : *jptr);
-			++ curr_col;
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %d, %s, %d): %p in %s:%d %s",
+		__FUNCTION__, data, len, err, opts, root, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
 
-			/* string */
-			if (flags & __JVF_STRING) {
-				if (!b) {
+	return root;
+}
+/* }}} */
+
+
+/** {{{ yod_jdecoder_t *_yod_jvalue_decoder_new(int opts __ENV_CPARM)
+*/
+yod_jdecoder_t *_yod_jvalue_decoder_new(int opts __ENV_CPARM)
+{
+	yod_jdecoder_t *self = NULL;
+
+	self = (yod_jdecoder_t *) malloc(sizeof(yod_jdecoder_t));
+	if (!self) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
+	}
+
+	/* a chunk is gone by the next feed, so strings are always copied */
+	_yod_jvalue_decode_init(self, opts & ~ __JVD_INSITU);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%d): %p in %s:%d %s",
+		__FUNCTION__, opts, self, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return self;
+}
+/* }}} */
+
+
+/** {{{ void _yod_jvalue_decoder_free(yod_jdecoder_t *self __ENV_CPARM)
+*/
+void _yod_jvalue_decoder_free(yod_jdecoder_t *self __ENV_CPARM)
+{
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p) in %s:%d %s",
+		__FUNCTION__, self, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	if (!self) {
+		return;
+	}
+
+	_yod_jvalue_decode_free(self);
+
+	free(self);
+}
+/* }}} */
+
+
+/** {{{ int _yod_jvalue_decoder_feed(yod_jdecoder_t *self, const char *data, size_t len, char *err __ENV_CPARM)
+*/
+int _yod_jvalue_decoder_feed(yod_jdecoder_t *self, const char *data, size_t len, char *err __ENV_CPARM)
+{
+	size_t base = 0;
+	size_t used = 0;
+	size_t n = 0;
+	int ret = 0;
+
+	if (!self || (!data && len)) {
+		errno = EINVAL;
+		return (-1);
+	}
+
+	/* input after a NUL past the root value is ignored, as in decode */
+	if (self->closed) {
+		return (__JVD_FEED_DONE);
+	}
+
+	if (!self->total && len) {
+		/* Skip UTF-8 BOM */
+		if (len >= 3 && ((byte) data[0]) == 0xEF && ((byte) data[1]) == 0xBB && ((byte) data[2]) == 0xBF) {
+			data += 3;
+			len -= 3;
+			self->total = 3;
+		}
+
+		if ((self->opts & __JVD_ARENA) && !self->arena) {
+			self->arena = _yod_jvalue_arena_new(len * 2);
+			if (!self->arena) {
+				goto e_failed;
+			}
+		}
+	}
+	self->total += len;
+
+	/* the bytes held back last time are glued with the head of this
+	 * chunk, a few at a time, until the token they start is complete */
+	base = self->tail_len;
+	while (self->tail_len && used < len) {
+		n = len - used;
+		if (n > YOD_JVALUE_DECODE_TAIL) {
+			n = YOD_JVALUE_DECODE_TAIL;
+		}
+
+		if (!_yod_jvalue_decode_hold(self, data + used, n)) {
+			goto e_failed;
+		}
+		used += n;
+
+		if ((ret = _yod_jvalue_decode_run(self, self->tail, self->tail_len, 0, err)) != 0) {
+			break;
+		}
+
+		if (self->keep >= base) {
+			_yod_jvalue_decode_move(self, base);
+			self->tail_len = 0;
+			break;
+		}
+
+		memmove(self->tail, self->tail + self->keep, self->tail_len - self->keep);
+		self->tail_len -= self->keep;
+		self->tail[self->tail_len] = '\0';
+		base -= self->keep;
+		_yod_jvalue_decode_move(self, self->keep);
+	}
+
+	/* then the chunk is decoded in place */
+	if (!ret && !self->tail_len) {
+		ret = _yod_jvalue_decode_run(self, data, len, 0, err);
+		if (!ret) {
+			if (!_yod_jvalue_decode_hold(self, data + self->keep, len - self->keep)) {
+				goto e_failed;
+			}
+			_yod_jvalue_decode_move(self, self->keep);
+		}
+	}
+
+	if (ret < 0) {
+		goto e_failed;
+	}
+
+	if (ret > 0) {
+		self->closed = 1;
+	}
+	else if (self->flags & __JVF_DONE) {
+		ret = __JVD_FEED_DONE;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p, %d, %s): %d in %s:%d %s",
+		__FUNCTION__, self, data, len, err, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (ret);
+
+e_failed:
+
+	_yod_jvalue_decode_clear(self);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p, %d, %s): %d in %s:%d %s",
+		__FUNCTION__, self, data, len, err, -1, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (__JVD_FEED_ERROR);
+}
+/* }}} */
+
+
+/** {{{ yod_jvalue_t *_yod_jvalue_decoder_end(yod_jdecoder_t *self, char *err __ENV_CPARM)
+*/
+yod_jvalue_t *_yod_jvalue_decoder_end(yod_jdecoder_t *self, char *err __ENV_CPARM)
+{
+	yod_jvalue_t *root = NULL;
+	int ret = 1;
+
+	if (!self) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	if (self->total) {
+		if (!self->closed) {
+			ret = _yod_jvalue_decode_run(self, (self->tail ? self->tail : ""), self->tail_len, 1, err);
+		}
+
+		if (ret > 0) {
+			root = _yod_jvalue_decode_root(self);
+		}
+	}
+
+	/* ready for the next document */
+	_yod_jvalue_decode_clear(self);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %s): %p in %s:%d %s",
+		__FUNCTION__, self, err, root, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return root;
+}
+/* }}} */
+
+
+/** {{{ int _yod_jvalue_parse(char *data, size_t len, yod_jvalue_fn func, void *arg, char *err __ENV_CPARM)
+*/
+int _yod_jvalue_parse(char *data, size_t len, yod_jvalue_fn func, void *arg, char *err __ENV_CPARM)
+{
+	yod_jvalue_d ctx;
+	int ret = -1;
+
+	if (!data || !len || !func) {
+		errno = EINVAL;
+		return (-1);
+	}
+
+	/* Skip UTF-8 BOM */
+	if (len >= 3 && ((byte) data[0]) == 0xEF && ((byte) data[1]) == 0xBB && ((byte) data[2]) == 0xBF) {
+		data += 3;
+		len -= 3;
+	}
+
+	/* no tree is built, a node per open value is reused instead */
+	_yod_jvalue_decode_init(&ctx, 0);
+	ctx.func = func;
+	ctx.arg = arg;
+
+	if (_yod_jvalue_decode_run(&ctx, data, len, 1, err) > 0) {
+		ret = ctx.stop;
+	}
+
+	_yod_jvalue_decode_free(&ctx);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %d, %p, %p, %s): %d in %s:%d %s",
+		__FUNCTION__, data, len, func, arg, err, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (ret);
+}
+/* }}} */
+
+
+/** {{{ char *_yod_jvalue_pack(yod_jvalue_t *self, size_t *len __ENV_CPARM)
+*/
+char *_yod_jvalue_pack(yod_jvalue_t *self, size_t *len __ENV_CPARM)
+{
+	yod_jvalue_w enc;
+	char *ret = NULL;
+
+	if (!self) {
+		errno = EINVAL;
+		YOD_STDLOG_WARN("invalid argument");
+		return NULL;
+	}
+
+	_yod_jvalue_encode_init(&enc, __JVW_GROW);
+
+	if (_yod_jvalue_pack_run(&enc, self) == 0) {
+		if (len) {
+			*len = enc.len;
+		}
+		ret = enc.data;
+		enc.data = NULL;
+	}
+
+	_yod_jvalue_encode_free(&enc);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p): %p in %s:%d %s",
+		__FUNCTION__, self, len, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ int _yod_jvalue_pack_write(yod_jvalue_t *self, yod_jvalue_sink_fn func, void *arg __ENV_CPARM)
+*/
+int _yod_jvalue_pack_write(yod_jvalue_t *self, yod_jvalue_sink_fn func, void *arg __ENV_CPARM)
+{
+	int ret = -1;
+
+	if (!self || !func) {
+		errno = EINVAL;
+		YOD_STDLOG_WARN("invalid argument");
+		return (-1);
+	}
+
+	ret = _yod_jvalue_encode_sink(self, func, arg, _yod_jvalue_pack_run);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p, %p): %d in %s:%d %s",
+		__FUNCTION__, self, func, arg, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (ret);
+}
+/* }}} */
+
+
+/** {{{ yod_jvalue_t *_yod_jvalue_unpack(char *data, size_t len, char *err, int opts __ENV_CPARM)
+*/
+yod_jvalue_t *_yod_jvalue_unpack(char *data, size_t len, char *err, int opts __ENV_CPARM)
+{
+	yod_jvalue_d ctx;
+	yod_jvalue_t *root = NULL;
+
+	if (!data || !len) {
+		return NULL;
+	}
+
+	_yod_jvalue_decode_init(&ctx, opts);
+
+	if (opts & __JVD_ARENA) {
+		ctx.arena = _yod_jvalue_arena_new(len * 2);
+		if (!ctx.arena) {
+			return NULL;
+		}
+	}
+
+	if (_yod_jvalue_unpack_run(&ctx, data, len, err) > 0) {
+		if ((root = _yod_jvalue_decode_root(&ctx)) != NULL && root->type == __JVT_ARRAY) {
+			root->u.array.size = root->u.array.count;
+		}
+	}
+
+	_yod_jvalue_decode_free(&ctx);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %d, %s, %d): %p in %s:%d %s",
+		__FUNCTION__, data, len, err, opts, root, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return root;
+}
+/* }}} */
+
+
+/** {{{ yod_jvalue_t *_yod_jvalue_object_new(size_t size __ENV_CPARM)
+*/
+yod_jvalue_t *_yod_jvalue_object_new(size_t size __ENV_CPARM)
+{
+	return _yod_jvalue_object_new_ex(size, 0 __ENV_CARGS);
+}
+/* }}} */
+
+
+/** {{{ yod_jvalue_t *_yod_jvalue_object_new_ex(size_t size, int opts __ENV_CPARM)
+*/
+yod_jvalue_t *_yod_jvalue_object_new_ex(size_t size, int opts __ENV_CPARM)
+{
+	yod_jvalue_t *self = NULL;
+	size_t slots = 0;
+	size_t order = 0;
+
+	self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t));
+	if (!self) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
+	}
+
+	/* larger objects get a hash index behind the members, sorted
+	 * ones also the order of their members behind the index */
+	slots = _yod_jvalue_object_slots(size);
+	order = (slots && !(opts & __JVO_INSERT)) ? size : 0;
+
+	self->type = __JVT_OBJECT;
+	self->flags = 0;
+	self->u.object.count = 0;
+	self->u.object.size = size;
+	self->u.object.data.ptr = calloc(1, (size + 1) * sizeof(yod_jvalue_v) + (slots + order) * sizeof(uint32_t));
+	if (!self->u.object.data.ptr) {
+		yod_jvalue_free(self);
+
+		YOD_STDLOG_ERROR("calloc failed");
+		return NULL;
+	}
+
+	self->u.object.data.ptr[size].name = NULL;
+	self->u.object.data.ptr[size].name_len = 0;
+	self->u.object.data.ptr[size].value = NULL;
+
+	if (slots) {
+		self->flags |= __JVN_INDEX;
+	}
+
+	if (order) {
+		self->flags |= __JVN_ORDER;
+	}
+
+	if (opts & __JVO_INSERT) {
+		self->flags |= __JVN_INSERT;
+	}
+
+	self->parent = NULL;
+	self->_reserved.u.ptr = NULL;
+	self->_reserved.index = 0;
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%d, %d): %p in %s:%d %s",
+		__FUNCTION__, size, opts, self, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return self;
+}
+/* }}} */
+
+
+/** {{{ int _yod_jvalue_object_set(yod_jvalue_t *self, const char *name, yod_jvalue_t *value __ENV_CPARM)
+*/
+int _yod_jvalue_object_set(yod_jvalue_t *self, const char *name, yod_jvalue_t *value __ENV_CPARM)
+{
+	size_t name_len = 0;
+	size_t index = 0;
+	int ret = 0;
+
+	if (!self || !name) {
+		return (-1);
+	}
+
+	if (self->type != __JVT_OBJECT) {
+		YOD_STDLOG_WARN("illegal jvalue");
+		return (-1);
+	}
+
+	if (self->flags & __JVN_ARENA) {
+		YOD_STDLOG_WARN("read-only jvalue");
+		return (-1);
+	}
+
+	if (self->flags & __JVN_LAZY) {
+		_yod_jvalue_mapped_read(self, NULL);
+	}
+
+	if (_yod_jvalue_object_find(self, (char *) name, &index, 1) != 0) {
+		if (index >= self->u.object.size) {
+			YOD_STDLOG_WARN("index overflow");
+			return (-1);
+		}
+		name_len = strlen(name);;
+		self->u.object.data.ptr[index].name = (char *) name;
+		self->u.object.data.ptr[index].name_len = name_len;
+		self->u.object.data.ptr[index].value = value;
+		self->u.object.data.ptr[self->u.object.size].name_len += name_len + 1;
+	}
+	else {
+		if (self->u.object.data.ptr[index].value) {
+			yod_jvalue_free(self->u.object.data.ptr[index].value);
+		}
+		self->u.object.data.ptr[index].value = value;
+	}
+
+	if (value) {
+		value->parent = self;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %s, %p): %d in %s:%d %s",
+		__FUNCTION__, self, name, value, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ yod_jvalue_t *_yod_jvalue_object_get(yod_jvalue_t *self, const char *name __ENV_CPARM)
+*/
+yod_jvalue_t *_yod_jvalue_object_get(yod_jvalue_t *self, const char *name __ENV_CPARM)
+{
+	yod_jvalue_t *ret = NULL;
+	size_t index = 0;
+
+	if (!self) {
+		return NULL;
+	}
+
+	if (self->flags & __JVN_LAZY) {
+		_yod_jvalue_mapped_read(self, NULL);
+	}
+
+	if (self->type == __JVT_OBJECT) {
+		if (_yod_jvalue_object_find(self, (char *) name, &index, 0) == 0) {
+			ret = self->u.object.data.ptr[index].value;
+		}
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %s): %p in %s:%d %s",
+		__FUNCTION__, self, name, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ yod_jvalue_t *_yod_jvalue_object_fetch(yod_jvalue_t *self, size_t index, char **name, size_t *name_len __ENV_CPARM)
+*/
+yod_jvalue_t *_yod_jvalue_object_fetch(yod_jvalue_t *self, size_t index, char **name, size_t *name_len __ENV_CPARM)
+{
+	yod_jvalue_t *ret = NULL;
+
+	if (!self) {
+		return NULL;
+	}
+
+	if (self->flags & __JVN_LAZY) {
+		_yod_jvalue_mapped_read(self, NULL);
+	}
+
+	if (self->type == __JVT_OBJECT) {
+		if (index < self->u.object.count) {
+			index = _yod_jvalue_object_at(self, index);
+			if (name) {
+				*name = self->u.object.data.ptr[index].name;
+			}
+			if (name_len) {
+				*name_len = self->u.object.data.ptr[index].name_len;
+			}
+			ret = self->u.object.data.ptr[index].value;
+		}
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %d, %s, %d): %p in %s:%d %s",
+		__FUNCTION__, self, index, (name ? *name : NULL), (name_len ? name_len : 0), ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ size_t _yod_jvalue_object_count(yod_jvalue_t *self __ENV_CPARM)
+*/
+size_t _yod_jvalue_object_count(yod_jvalue_t *self __ENV_CPARM)
+{
+	size_t ret = 0;
+
+	if (!self) {
+		return (0);
+	}
+
+	if (self->flags & __JVN_LAZY) {
+		_yod_jvalue_mapped_read(self, NULL);
+	}
+
+	if (self->type == __JVT_OBJECT) {
+		ret = self->u.object.count;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p): %d in %s:%d %s",
+		__FUNCTION__, self, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ yod_jvalue_t *_yod_jvalue_object_init(size_t size, ...)
+*/
+yod_jvalue_t *_yod_jvalue_object_init(size_t size, ...)
+{
+	yod_jvalue_t *self = NULL;
+	yod_jvalue_t *value = NULL;
+	char *name = NULL;
+	size_t name_len = 0;
+	size_t index = 0;
+	size_t slots = 0;
+	size_t order = 0;
+	va_list args;
+	size_t i = 0;
+
+	self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t));
+	if (!self) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
+	}
+
+	slots = _yod_jvalue_object_slots(size);
+	order = slots ? size : 0;
+
+	self->type = __JVT_OBJECT;
+	self->flags = 0;
+	self->u.object.count = 0;
+	self->u.object.size = size;
+	self->u.object.data.ptr = (yod_jvalue_v *) calloc(1, (size + 1) * sizeof(yod_jvalue_v) + (slots + order) * sizeof(uint32_t));
+	if (!self->u.object.data.ptr) {
+		yod_jvalue_free(self);
+
+		YOD_STDLOG_ERROR("calloc failed");
+		return NULL;
+	}
+
+	self->u.object.data.ptr[size].name = NULL;
+	self->u.object.data.ptr[size].name_len = 0;
+	self->u.object.data.ptr[size].value = NULL;
+
+	if (slots) {
+		self->flags |= __JVN_INDEX | __JVN_ORDER;
+	}
+
+	self->parent = NULL;
+	self->_reserved.u.ptr = NULL;
+	self->_reserved.index = 0;
+
+	va_start(args, size);
+	for (i = 0; i < size; ++ i) {
+		name = va_arg(args, char *);
+		value = va_arg(args, yod_jvalue_t *);
+		if (_yod_jvalue_object_find(self, name, &index, 1) != 0) {
+			name_len = strlen(name);
+			self->u.object.data.ptr[index].name = name;
+			self->u.object.data.ptr[index].name_len = name_len;
+			self->u.object.data.ptr[index].value = value;
+			self->u.object.data.ptr[size].name_len += name_len + 1;
+		}
+		else {
+			if (self->u.object.data.ptr[index].value) {
+				yod_jvalue_free(self->u.object.data.ptr[index].value);
+			}
+			self->u.object.data.ptr[index].value = value;
+		}
+		if (value) {
+			value->parent = self;
+		}
+	}
+	va_end(args);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%d): %p in %s:%d %s",
+		__FUNCTION__, size, self, __ENV_TRACE3);
+#endif
+
+	return self;
+}
+/* }}} */
+
+
+/** {{{ yod_jvalue_t *_yod_jvalue_array_new(size_t size __ENV_CPARM)
+*/
+yod_jvalue_t *_yod_jvalue_array_new(size_t size __ENV_CPARM)
+{
+	yod_jvalue_t *self = NULL;
+
+	self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t));
+	if (!self) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
+	}
+
+	self->type = __JVT_ARRAY;
+	self->u.array.count = 0;
+	self->u.array.size = size;
+	self->u.array.data = calloc(size, sizeof(yod_jvalue_t *));
+	if (!self->u.array.data) {
+		free(self);
+
+		YOD_STDLOG_ERROR("calloc failed");
+		return NULL;
+	}
+
+	self->parent = NULL;
+	self->flags = 0;
+	self->_reserved.u.ptr = NULL;
+	self->_reserved.index = 0;
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%d): %p in %s:%d %s",
+		__FUNCTION__, size, self, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return self;
+}
+/* }}} */
+
+
+/** {{{ int _yod_jvalue_array_add(yod_jvalue_t *self, yod_jvalue_t *value __ENV_CPARM)
+*/
+int _yod_jvalue_array_add(yod_jvalue_t *self, yod_jvalue_t *value __ENV_CPARM)
+{
+	size_t index = 0;
+	int ret = 0;
+
+	if (!self) {
+		return (-1);
+	}
+
+	if (self->type != __JVT_ARRAY) {
+		YOD_STDLOG_WARN("illegal jvalue");
+		return (-1);
+	}
+
+	if (self->flags & __JVN_ARENA) {
+		YOD_STDLOG_WARN("read-only jvalue");
+		return (-1);
+	}
+
+	if (self->flags & __JVN_LAZY) {
+		_yod_jvalue_mapped_read(self, NULL);
+	}
+
+	if (self->u.array.count >= self->u.array.size) {
+		YOD_STDLOG_WARN("index overflow");
+		return (-1);
+	}
+
+	index = self->u.array.count ++;
+	if (self->u.array.data[index]) {
+		yod_jvalue_free(self->u.array.data[index]);
+	}
+	self->u.array.data[index] = value;
+
+	if (value) {
+		value->parent = self;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %d, %p): %d in %s:%d %s",
+		__FUNCTION__, self, index, value, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ int _yod_jvalue_array_set(yod_jvalue_t *self, size_t index, yod_jvalue_t *value __ENV_CPARM)
+*/
+int _yod_jvalue_array_set(yod_jvalue_t *self, size_t index, yod_jvalue_t *value __ENV_CPARM)
+{
+	int ret = 0;
+
+	if (!self) {
+		return (-1);
+	}
+
+	if (self->type != __JVT_ARRAY) {
+		YOD_STDLOG_WARN("illegal jvalue");
+		return (-1);
+	}
+
+	if (self->flags & __JVN_ARENA) {
+		YOD_STDLOG_WARN("read-only jvalue");
+		return (-1);
+	}
+
+	if (self->flags & __JVN_LAZY) {
+		_yod_jvalue_mapped_read(self, NULL);
+	}
+
+	if (index >= self->u.array.size) {
+		YOD_STDLOG_WARN("index overflow");
+		return (-1);
+	}
+
+	if (index >= self->u.array.count) {
+		self->u.array.count = index + 1;
+	}
+
+	if (self->u.array.data[index]) {
+		yod_jvalue_free(self->u.array.data[index]);
+	}
+	self->u.array.data[index] = value;
+
+	if (value) {
+		value->parent = self;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %d, %p): %d in %s:%d %s",
+		__FUNCTION__, self, index, value, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ yod_jvalue_t *_yod_jvalue_array_get(yod_jvalue_t *self, size_t index __ENV_CPARM)
+*/
+yod_jvalue_t *_yod_jvalue_array_get(yod_jvalue_t *self, size_t index __ENV_CPARM)
+{
+	yod_jvalue_t *ret = NULL;
+
+	if (!self) {
+		return NULL;
+	}
+
+	if (self->flags & __JVN_LAZY) {
+		_yod_jvalue_mapped_read(self, NULL);
+	}
+
+	if (self->type == __JVT_ARRAY) {
+		if (index < self->u.array.count) {
+			ret = self->u.array.data[index];
+		}
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %d): %p in %s:%d %s",
+		__FUNCTION__, self, index, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ size_t _yod_jvalue_array_count(yod_jvalue_t *self __ENV_CPARM)
+*/
+size_t _yod_jvalue_array_count(yod_jvalue_t *self __ENV_CPARM)
+{
+	size_t ret = 0;
+
+	if (!self) {
+		return (0);
+	}
+
+	if (self->flags & __JVN_LAZY) {
+		_yod_jvalue_mapped_read(self, NULL);
+	}
+
+	if (self->type == __JVT_ARRAY) {
+		ret = self->u.array.count;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p): %d in %s:%d %s",
+		__FUNCTION__, self, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ yod_jvalue_t *_yod_jvalue_array_init(size_t size, ...)
+*/
+yod_jvalue_t *_yod_jvalue_array_init(size_t size, ...)
+{
+	yod_jvalue_t *self = NULL;
+	yod_jvalue_t *value = NULL;
+	size_t index = 0;
+	va_list args;
+
+	self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t));
+	if (!self) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
+	}
+
+	self->type = __JVT_ARRAY;
+	self->u.array.count = size;
+	self->u.array.size = size;
+	self->u.array.data = calloc(size, sizeof(yod_jvalue_t *));
+	if (!self->u.array.data) {
+		free(self);
+
+		YOD_STDLOG_ERROR("calloc failed");
+		return NULL;
+	}
+
+	self->parent = NULL;
+	self->flags = 0;
+	self->_reserved.u.ptr = NULL;
+	self->_reserved.index = 0;
+
+	va_start(args, size);
+	for (index = 0; index < size; ++ index) {
+		value = va_arg(args, yod_jvalue_t *);
+		self->u.array.data[index] = value;
+		if (value) {
+			value->parent = self;
+		}
+	}
+	va_end(args);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%d): %p in %s:%d %s",
+		__FUNCTION__, size, self, __ENV_TRACE3);
+#endif
+
+	return self;
+}
+/* }}} */
+
+
+/** {{{ yod_jvalue_t *_yod_jvalue_string_new(char *str, size_t len __ENV_CPARM)
+*/
+yod_jvalue_t *_yod_jvalue_string_new(char *str, size_t len __ENV_CPARM)
+{
+	yod_jvalue_t *self = NULL;
+
+	self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t));
+	if (!self) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
+	}
+
+	if (len == (size_t) -1) {
+		len = str ? strlen(str) : 0;
+	}
+
+	self->type = __JVT_STRING;
+	self->u.string.ptr = (char *) malloc((len + 1)* sizeof(char));
+	if (!self->u.string.ptr) {
+		free(self);
+
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
+	}
+	memcpy(self->u.string.ptr, str, len);
+	self->u.string.ptr[len] = '\0';
+	self->u.string.len = len;
+
+	self->parent = NULL;
+	self->flags = 0;
+	self->_reserved.u.ptr = NULL;
+	self->_reserved.index = 0;
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %d): %p in %s:%d %s",
+		__FUNCTION__, str, len, self, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return self;
+}
+/* }}} */
+
+
+/** {{{ int _yod_jvalue_string_set(yod_jvalue_t *self, char *str, size_t len __ENV_CPARM)
+*/
+int _yod_jvalue_string_set(yod_jvalue_t *self, char *str, size_t len __ENV_CPARM)
+{
+	if (!self) {
+		return (-1);
+	}
+
+	if (self->type != __JVT_STRING) {
+		YOD_STDLOG_WARN("illegal jvalue");
+		return (-1);
+	}
+
+	if (self->flags & __JVN_ARENA) {
+		YOD_STDLOG_WARN("read-only jvalue");
+		return (-1);
+	}
+
+	if (self->u.string.ptr && !(self->flags & __JVN_BORROW)) {
+		free(self->u.string.ptr);
+	}
+	self->flags &= ~ __JVN_BORROW;
+
+	self->u.string.ptr = (char *) malloc((len + 1) * sizeof(char));
+	if (!self->u.string.ptr) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return (-1);
+	}
+	memcpy(self->u.string.ptr, str, len);
+	self->u.string.ptr[len] = '\0';
+	self->u.string.len = len;
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p, %d) in %s:%d %s",
+		__FUNCTION__, self, str, len, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (0);
+}
+/* }}} */
+
+
+/** {{{ char *_yod_jvalue_string_get(yod_jvalue_t *self, size_t *len __ENV_CPARM)
+*/
+char *_yod_jvalue_string_get(yod_jvalue_t *self, size_t *len __ENV_CPARM)
+{
+	char *ret = NULL;
+
+	if (!self) {
+		return NULL;
+	}
+
+	if (self->type == __JVT_STRING) {
+		ret = self->u.string.ptr;
+		if (len) {
+			*len = self->u.string.len;
+		}
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %d): %p in %s:%d %s",
+		__FUNCTION__, self, (len ? *len : 0), ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ yod_jvalue_t *_yod_jvalue_integer_new(int64_t num __ENV_CPARM)
+*/
+yod_jvalue_t *_yod_jvalue_integer_new(int64_t num __ENV_CPARM)
+{
+	yod_jvalue_t *self = NULL;
+
+	self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t));
+	if (!self) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
+	}
+
+	self->type = __JVT_INTEGER;
+	self->u.ival = num;
+
+	self->parent = NULL;
+	self->flags = 0;
+	self->_reserved.u.ptr = NULL;
+	self->_reserved.index = 0;
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%ld): %p in %s:%d %s",
+		__FUNCTION__, (ulong) num, self, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return self;
+}
+/* }}} */
+
+
+/** {{{ int _yod_jvalue_integer_set(yod_jvalue_t *self, int64_t num __ENV_CPARM)
+*/
+int _yod_jvalue_integer_set(yod_jvalue_t *self, int64_t num __ENV_CPARM)
+{
+	if (!self) {
+		return (-1);
+	}
+
+	if (self->type != __JVT_INTEGER) {
+		YOD_STDLOG_WARN("illegal jvalue");
+		return (-1);
+	}
+	self->u.ival = num;
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %ld) in %s:%d %s",
+		__FUNCTION__, self, (ulong) num, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (0);
+}
+/* }}} */
+
+
+/** {{{ int64_t _yod_jvalue_integer_get(yod_jvalue_t *self __ENV_CPARM)
+*/
+int64_t _yod_jvalue_integer_get(yod_jvalue_t *self __ENV_CPARM)
+{
+	int64_t ret = 0;
+
+	if (!self) {
+		return (0);
+	}
+
+	if (self->type == __JVT_INTEGER) {
+		ret = self->u.ival;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p): %ld in %s:%d %s",
+		__FUNCTION__, self, (ulong) ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ yod_jvalue_t *_yod_jvalue_double_new(double dval __ENV_CPARM)
+*/
+yod_jvalue_t *_yod_jvalue_double_new(double dval __ENV_CPARM)
+{
+	yod_jvalue_t *self = NULL;
+
+	self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t));
+	if (!self) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
+	}
+
+	self->type = __JVT_DOUBLE;
+	self->u.dval = dval;
+
+	self->parent = NULL;
+	self->flags = 0;
+	self->_reserved.u.ptr = NULL;
+	self->_reserved.index = 0;
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%lf): %p in %s:%d %s",
+		__FUNCTION__, dval, self, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return self;
+}
+/* }}} */
+
+
+/** {{{ int _yod_jvalue_double_set(yod_jvalue_t *self, double dval __ENV_CPARM)
+*/
+int _yod_jvalue_double_set(yod_jvalue_t *self, double dval __ENV_CPARM)
+{
+	if (!self) {
+		return (-1);
+	}
+
+	if (self->type != __JVT_DOUBLE) {
+		YOD_STDLOG_WARN("illegal jvalue");
+		return (-1);
+	}
+	self->u.dval = dval;
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lf) in %s:%d %s",
+		__FUNCTION__, self, dval, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (0);
+}
+/* }}} */
+
+
+/** {{{ double _yod_jvalue_double_get(yod_jvalue_t *self __ENV_CPARM)
+*/
+double _yod_jvalue_double_get(yod_jvalue_t *self __ENV_CPARM)
+{
+	double ret = 0;
+
+	if (!self) {
+		return (0);
+	}
+
+	if (self->type == __JVT_DOUBLE) {
+		ret = self->u.dval;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p): %lf in %s:%d %s",
+		__FUNCTION__, self, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ yod_jvalue_t *_yod_jvalue_boolean_new(int bval __ENV_CPARM)
+*/
+yod_jvalue_t *_yod_jvalue_boolean_new(int bval __ENV_CPARM)
+{
+	yod_jvalue_t *self = NULL;
+
+	self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t));
+	if (!self) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
+	}
+
+	self->type = __JVT_BOOLEAN;
+	self->u.bval = bval;
+
+	self->parent = NULL;
+	self->flags = 0;
+	self->_reserved.u.ptr = NULL;
+	self->_reserved.index = 0;
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%d): %p in %s:%d %s",
+		__FUNCTION__, bval, self, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return self;
+}
+/* }}} */
+
+
+/** {{{ int _yod_jvalue_boolean_set(yod_jvalue_t *self, int bval __ENV_CPARM)
+*/
+int _yod_jvalue_boolean_set(yod_jvalue_t *self, int bval __ENV_CPARM)
+{
+	if (!self) {
+		return (-1);
+	}
+
+	if (self->type != __JVT_BOOLEAN) {
+		YOD_STDLOG_WARN("illegal jvalue");
+		return (-1);
+	}
+	self->u.bval = bval;
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %d) in %s:%d %s",
+		__FUNCTION__, self, bval, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (0);
+}
+/* }}} */
+
+
+/** {{{ size_t _yod_jvalue_boolean_get(yod_jvalue_t *self __ENV_CPARM)
+*/
+int _yod_jvalue_boolean_get(yod_jvalue_t *self __ENV_CPARM)
+{
+	int ret = 0;
+
+	if (!self) {
+		return (0);
+	}
+
+	if (self->type == __JVT_BOOLEAN) {
+		ret = self->u.bval;
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p): %d in %s:%d %s",
+		__FUNCTION__, self, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ static int _yod_jvalue_decode_run(yod_jvalue_d *ctx, const char *data, size_t len, int last, char *err)
+*/
+static int _yod_jvalue_decode_run(yod_jvalue_d *ctx, const char *data, size_t len, int last, char *err)
+{
+	yod_jvalue_t *top = ctx->top;
+	yod_jvalue_t *root = ctx->root;
+	yod_jvalue_t *parent = NULL;
+	long num_digits = ctx->num_digits;
+	long num_e = ctx->num_e;
+	int64_t num_fraction = ctx->num_fraction;
+	uint32_t curr_line = ctx->line;
+	uint32_t curr_col = ctx->col;
+	const char *jptr, *jend, *jnum, *jrun;
+	size_t run_len = 0;
+	size_t lazy = 0;
+	byte uc_b1, uc_b2, uc_b3, uc_b4;
+	uint32_t uc1, uc2;
+	char *str = NULL;
+	size_t str_len = ctx->str_len;
+	long flags = ctx->flags;
+	int ret = 0;
+
+	jend = (data + len);
+	jnum = NULL;
+
+	if (ctx->num_pos != YOD_JVALUE_DECODE_NOPOS) {
+		jnum = data + ctx->num_pos - 1;
+	}
+
+	if (flags & __JVF_STRING) {
+		str = ctx->buf;
+	}
+
+	for (jptr = data + ctx->pos; ; ++ jptr) {
+		char b;
+
+		if (jptr == jend && !last) {
+			goto e_suspend;
+		}
+
+		b = (jptr == jend ? 0 : *jptr);
+		++ curr_col;
+
+		/* string */
+		if (flags & __JVF_STRING) {
+			if (!b) {
+				if (err) {
+					snprintf(err, 255, "Unexpected EOF in string (at %d:%d) in %s:%d %s",
+						curr_line, curr_col, __ENV_TRACE3);
+				}
+				goto e_failed;
+			}
+
+			if (str_len > YOD_JVALUE_MAX_SIZE) {
+				if (err) {
+					snprintf(err, 255, "Too long (caught overflow) (at %d:%d) in %s:%d %s",
+						curr_line, curr_col, __ENV_TRACE3);
+				}
+				goto e_failed;
+			}
+
+			/* room for the longest escape plus the terminator */
+			if (str_len + 5 > ctx->buf_size) {
+				if ((str = _yod_jvalue_decode_grow(ctx->buf, &ctx->buf_size, str_len + 5)) == NULL) {
+					goto e_failed;
+				}
+				ctx->buf = str;
+			}
+
+			/* copy a run of plain characters at once */
+			if (!(flags & (__JVF_NEED_QUOTE | __JVF_ESCAPED)) && b != '"' && b != '\\') {
+				jrun = yod_jvalue_scan_plain__(jptr + 1, jend);
+
+				run_len = (size_t) (jrun - jptr);
+				if (str_len + run_len + 5 > ctx->buf_size) {
+					if ((str = _yod_jvalue_decode_grow(ctx->buf, &ctx->buf_size, str_len + run_len + 5)) == NULL) {
+						goto e_failed;
+					}
+					ctx->buf = str;
+				}
+
+				memcpy(str + str_len, jptr, run_len);
+				str_len += run_len;
+
+				curr_col += (uint32_t) (run_len - 1);
+				jptr = jrun - 1;
+				continue;
+			}
+
+			if (flags & __JVF_ESCAPED) {
+				/* a surrogate pair is read at once */
+				if (b == 'u' && !last && jend - jptr < 11) {
+					-- curr_col;
+					goto e_suspend;
+				}
+
+				flags &= ~ __JVF_ESCAPED;
+
+				switch (b) {
+					case 'b':
+						str[str_len] = '\b';
+						++ str_len;
+						break;
+
+					case 'f':
+						str[str_len] = '\f';
+						++ str_len;
+						break;
+
+					case 'n':
+						str[str_len] = '\n';
+						++ str_len;
+						break;
+
+					case 'r':
+						str[str_len] = '\r';
+						++ str_len;
+						break;
+
+					case 't':
+						str[str_len] = '\t';
+						++ str_len;
+						break;
+
+					case 'u':
+
+						if (jend - jptr < 5 || 
+							(uc_b1 = yod_common_hex2byte(*++ jptr)) == 0xFF ||
+							(uc_b2 = yod_common_hex2byte(*++ jptr)) == 0xFF ||
+							(uc_b3 = yod_common_hex2byte(*++ jptr)) == 0xFF ||
+							(uc_b4 = yod_common_hex2byte(*++ jptr)) == 0xFF)
+						{
+							if (err) {
+								snprintf(err, 255, "Invalid character value `%c` (at %d:%d) in %s:%d %s",
+									b, curr_line, curr_col, __ENV_TRACE3);
+							}
+							goto e_failed;
+						}
+
+						uc_b1 = (uc_b1 << 4) | uc_b2;
+						uc_b2 = (uc_b3 << 4) | uc_b4;
+						uc1 = (uc_b1 << 8) | uc_b2;
+
+						if ((uc1 & 0xF800) == 0xD800) {
+							if (jend - jptr < 7 || (*++ jptr) != '\\' || (*++ jptr) != 'u' ||
+								(uc_b1 = yod_common_hex2byte(*++ jptr)) == 0xFF ||
+								(uc_b2 = yod_common_hex2byte(*++ jptr)) == 0xFF ||
+								(uc_b3 = yod_common_hex2byte(*++ jptr)) == 0xFF ||
+								(uc_b4 = yod_common_hex2byte(*++ jptr)) == 0xFF)
+							{
+								if (err) {
+									snprintf(err, 255, "Invalid character value `%c` (at %d:%d) in %s:%d %s",
+										b, curr_line, curr_col, __ENV_TRACE3);
+								}
+								goto e_failed;
+							}
+
+							uc_b1 = (uc_b1 << 4) | uc_b2;
+							uc_b2 = (uc_b3 << 4) | uc_b4;
+							uc2 = (uc_b1 << 8) | uc_b2;
+
+							uc1 = 0x010000 | ((uc1 & 0x3FF) << 10) | (uc2 & 0x3FF);
+						}
+
+						if (sizeof(char) >= sizeof(uint32_t) || (uc1 <= 0x7F)) {
+							str[str_len] = (char) uc1;
+							++ str_len;
+							break;
+						}
+
+						if (uc1 <= 0x7FF) {
+							str[str_len++] = (char) (0xC0 | (uc1 >> 6));
+							str[str_len++] = (char) (0x80 | (uc1 & 0x3F));
+							break;
+						}
+
+						if (uc1 <= 0xFFFF) {
+							str[str_len++] = (char) (0xE0 | (uc1 >> 12));
+							str[str_len++] = (char) (0x80 | ((uc1 >> 6) & 0x3F));
+							str[str_len++] = (char) (0x80 | (uc1 & 0x3F));
+							break;
+						}
+
+						str[str_len++] = (char) (0xF0 | (uc1 >> 18));
+						str[str_len++] = (char) (0x80 | ((uc1 >> 12) & 0x3F));
+						str[str_len++] = (char) (0x80 | ((uc1 >> 6) & 0x3F));
+						str[str_len++] = (char) (0x80 | (uc1 & 0x3F));
+
+						break;
+
+					default:
+						str[str_len] = b;
+						++ str_len;
+				};
+
+				continue;
+			}
+
+			if (b == '\\') {
+				flags |= __JVF_ESCAPED;
+				continue;
+			}
+
+			if (flags & __JVF_NEED_QUOTE) {
+				if (b == '"') {
+					if (err) {
+						snprintf(err, 255, "Unexpected `%c` in comment opening sequence (at %d:%d) in %s:%d %s",
+							(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
+					}
+					goto e_failed;
+				}
+
+				if (b == ' ' || b == '\t' || b == '\r' || b == '\n' || b == ',' || b == ']' || b == '}') {
+					flags |= __JVF_REPROC;
+				}
+				else if (top->type == __JVT_OBJECT && b == ':') {
+					flags |= __JVF_REPROC;
+				}
+			}
+
+			if ((b == '"') || (flags & __JVF_REPROC)) {
+				str[str_len] = '\0';
+
+				flags &= ~ __JVF_STRING;
+				str = NULL;
+
+				if (flags & __JVF_REPROC) {
+					flags &= ~ (__JVF_NEED_QUOTE | __JVF_REPROC);
+
+					-- curr_col;
+					-- jptr;
+				}
+
+				switch (top->type) {
+					case __JVT_OBJECT:
+						if (!_yod_jvalue_decode_push(ctx, NULL, ctx->buf, str_len)) {
+							goto e_failed;
+						}
+
+						flags |= __JVF_SEEK_VALUE | __JVF_NEED_COLON;
+						continue;
+
+					case __JVT_STRING:
+						if (ctx->func) {
+							/* only valid until the event returns */
+							top->u.string.ptr = ctx->buf;
+						}
+						else if ((ctx->opts & __JVD_INSITU) && b == '"') {
+							/* unescaping never grows a string, so it fits back
+							 * into its own source ending on the closing quote */
+							top->u.string.ptr = (char *) jptr - str_len;
+							memcpy(top->u.string.ptr, ctx->buf, str_len + 1);
+							top->flags |= __JVN_BORROW;
+						}
+						else {
+							if ((top->u.string.ptr = (char *) _yod_jvalue_decode_alloc(ctx, str_len + 1)) == NULL) {
+								goto e_failed;
+							}
+							memcpy(top->u.string.ptr, ctx->buf, str_len + 1);
+						}
+						top->u.string.len = str_len;
+						flags |= __JVF_NEXT;
+						break;
+
+					default:
+						break;
+				};
+			}
+			else {
+				str[str_len] = b;
+				++ str_len;
+				continue;
+			}
+		}
+
+		/* comment */
+		if (flags & (__JVF_LINE_COMMENT | __JVF_BLOCK_COMMENT)) {
+			if (flags & __JVF_LINE_COMMENT) {
+				if (b == '\r' || b == '\n' || !b) {
+					flags &= ~ __JVF_LINE_COMMENT;
+					-- jptr;  /* so null can be reproc'd */
+					if (b == '\n') {
+						++ curr_line;
+						curr_col = 0;
+					}
+				}
+				continue;
+			}
+
+			if (flags & __JVF_BLOCK_COMMENT) {
+				if (!b) {
 					if (err) {
-						snprintf(err, 255, "Unexpected EOF in string (at %d:%d) in %s:%d %s",
+						snprintf(err, 255, "Unexpected EOF in block comment (at %d:%d) in %s:%d %s",
 							curr_line, curr_col, __ENV_TRACE3);
 					}
 					goto e_failed;
 				}
 
-				if (str_len > YOD_JVALUE_MAX_SIZE) {
+				if (b == '*' && !last && jptr + 1 == jend) {
+					-- curr_col;
+					goto e_suspend;
+				}
+
+				if (b == '*' && jptr < (jend - 1) && jptr[1] == '/') {
+					flags &= ~ __JVF_BLOCK_COMMENT;
+					++ jptr;  /* skip closing sequence */
+				}
+				else if (b == '\n') {
+					++ curr_line;
+					curr_col = 0;
+				}
+
+				continue;
+			}
+		}
+		else if (b == '/') {
+			if (!(flags & (__JVF_SEEK_VALUE | __JVF_DONE)) && top->type != __JVT_OBJECT) {
+				if (err) {
+					snprintf(err, 255, "Comment not allowed here (at %d:%d) in %s:%d %s",
+						curr_line, curr_col, __ENV_TRACE3);
+				}
+				goto e_failed;
+			}
+
+			if (!last && jptr + 1 == jend) {
+				-- curr_col;
+				goto e_suspend;
+			}
+
+			if (++ jptr == jend) {
+				if (err) {
+					snprintf(err, 255, "EOF unexpected (at %d:%d) in %s:%d %s",
+						curr_line, curr_col, __ENV_TRACE3);
+				}
+
+				goto e_failed;
+			}
+
+			switch (b = *jptr) {
+				case '/':
+					flags |= __JVF_LINE_COMMENT;
+					continue;
+
+				case '*':
+					flags |= __JVF_BLOCK_COMMENT;
+					continue;
+
+				default:
+					if (top && (top->type == __JVT_ARRAY || top->type == __JVT_OBJECT)) {
+						if (!_yod_jvalue_decode_new(ctx, &top, &root, __JVT_STRING)) {
+							goto e_failed;
+						}
+
+						str = ctx->buf;
+						str_len = 0;
+						
+						flags = (flags & ~__JVF_SEEK_VALUE) | __JVF_STRING | __JVF_NEED_QUOTE;
+
+						curr_col -= 2;
+						jptr -= 2;
+						continue;
+					}
+
 					if (err) {
-						snprintf(err, 255, "Too long (caught overflow) (at %d:%d) in %s:%d %s",
-							curr_line, curr_col, __ENV_TRACE3);
+						snprintf(err, 255, "Unexpected `%c` in comment opening sequence (at %d:%d) in %s:%d %s",
+							(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
 					}
 					goto e_failed;
-				}
+			};
+		}
+
+		if (flags & __JVF_DONE) {
+			if (!b) {
+				break;
+			}
+
+			switch (b) {
+				case '\n':
+				case ' ':
+				case '\t':
+				case '\r':
+					jptr = _yod_jvalue_decode_space(jptr, jend, b, &curr_line, &curr_col);
+					continue;
+
+				default:
+					if (err) {
+						snprintf(err, 255, "Trailing garbage: `%c` (at %d:%d) in %s:%d %s",
+							(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
+					}
+					goto e_failed;
+			};
+		}
+
+		if (flags & __JVF_SEEK_VALUE) {
+			switch (b)
+			{
+				case '\n':
+				case ' ':
+				case '\t':
+				case '\r':
+					jptr = _yod_jvalue_decode_space(jptr, jend, b, &curr_line, &curr_col);
+					continue;
+
+				case ']':
+
+					if (top && top->type == __JVT_ARRAY) {
+						flags = (flags & ~ (__JVF_NEED_COMMA | __JVF_SEEK_VALUE)) | __JVF_NEXT;
+					}
+					else {
+						if (err) {
+							snprintf(err, 255, "Unexpected ] (at %d:%d) in %s:%d %s",
+								curr_line, curr_col, __ENV_TRACE3);
+						}
+						goto e_failed;
+					}
+
+					break;
+
+				default:
 
-				if (flags & __JVF_ESCAPED) {
-					flags &= ~ __JVF_ESCAPED;
+					if (flags & __JVF_NEED_COMMA) {
+						if (b == ',') {
+							flags &= ~ __JVF_NEED_COMMA;
+							continue;
+						}
+						else {
+							if (err) {
+								snprintf(err, 255, "Expected , before `%c` (at %d:%d) in %s:%d %s",
+									(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
+							}
+							goto e_failed;
+						}
+					}
+
+					if (flags & __JVF_NEED_COLON) {
+						if (b == ':') {
+							flags &= ~ __JVF_NEED_COLON;
+							continue;
+						}
+						else {
+							if (err) {
+								snprintf(err, 255, "Expected : before `%c` (at %d:%d) in %s:%d %s",
+									(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
+							}
+							goto e_failed;
+						}
+					}
+
+					/* true, false and null are matched at once */
+					if (!last && jend - jptr < 5 && (b == 't' || b == 'f' || b == 'n')) {
+						-- curr_col;
+						goto e_suspend;
+					}
+
+					flags &= ~ __JVF_SEEK_VALUE;
 
 					switch (b) {
-						case 'b':
-							if (!first_pass) {
-								str[str_len] = '\b';
+						case '{':
+
+							if (!_yod_jvalue_decode_new(ctx, &top, &root, __JVT_OBJECT)) {
+								goto e_failed;
 							}
-							++ str_len;
-							break;
 
-						case 'f':
-							if (!first_pass) {
-								str[str_len] = '\f';
+							if (ctx->func && (ctx->stop = _yod_jvalue_decode_emit(ctx, top, __JVE_BEGIN)) != 0) {
+								goto e_stop;
 							}
-							++ str_len;
-							break;
 
-						case 'n':
-							if (!first_pass) {
-								str[str_len] = '\n';
+							/* left empty until first used, the closing } comes next */
+							if (ctx->doc && top->parent && (lazy = _yod_jvalue_decode_lazy(ctx, top, (size_t) (jptr - data))) > 0) {
+								jptr = data + lazy - 1;
 							}
-							++ str_len;
-							break;
+							continue;
 
-						case 'r':
-							if (!first_pass) {
-								str[str_len] = '\r';
+						case '[':
+
+							if (!_yod_jvalue_decode_new(ctx, &top, &root, __JVT_ARRAY)) {
+								goto e_failed;
 							}
-							++ str_len;
-							break;
 
-						case 't':
-							if (!first_pass) {
-								str[str_len] = '\t';
+							if (ctx->func && (ctx->stop = _yod_jvalue_decode_emit(ctx, top, __JVE_BEGIN)) != 0) {
+								goto e_stop;
 							}
-							++ str_len;
-							break;
 
-						case 'u':
+							flags |= __JVF_SEEK_VALUE;
 
-							if (jend - jptr < 4 || 
-								(uc_b1 = yod_common_hex2byte(*++ jptr)) == 0xFF ||
-								(uc_b2 = yod_common_hex2byte(*++ jptr)) == 0xFF ||
-								(uc_b3 = yod_common_hex2byte(*++ jptr)) == 0xFF ||
-								(uc_b4 = yod_common_hex2byte(*++ jptr)) == 0xFF)
-							{
-								if (err) {
-									snprintf(err, 255, "Invalid character value `%c` (at %d:%d) in %s:%d %s",
-										b, curr_line, curr_col, __ENV_TRACE3);
-								}
+							if (ctx->doc && top->parent && (lazy = _yod_jvalue_decode_lazy(ctx, top, (size_t) (jptr - data))) > 0) {
+								jptr = data + lazy - 1;
+							}
+							continue;
+
+						case '"':
+
+							if (!_yod_jvalue_decode_new(ctx, &top, &root, __JVT_STRING)) {
 								goto e_failed;
 							}
 
-							uc_b1 = (uc_b1 << 4) | uc_b2;
-							uc_b2 = (uc_b3 << 4) | uc_b4;
-							uc1 = (uc_b1 << 8) | uc_b2;
-
-							if ((uc1 & 0xF800) == 0xD800) {
-								if (jend - jptr < 6 || (*++ jptr) != '\\' || (*++ jptr) != 'u' ||
-									(uc_b1 = yod_common_hex2byte(*++ jptr)) == 0xFF ||
-									(uc_b2 = yod_common_hex2byte(*++ jptr)) == 0xFF ||
-									(uc_b3 = yod_common_hex2byte(*++ jptr)) == 0xFF ||
-									(uc_b4 = yod_common_hex2byte(*++ jptr)) == 0xFF)
-								{
-									if (err) {
-										snprintf(err, 255, "Invalid character value `%c` (at %d:%d) in %s:%d %s",
-											b, curr_line, curr_col, __ENV_TRACE3);
-									}
+							str = ctx->buf;
+							str_len = 0;
+
+							flags |= __JVF_STRING;
+							continue;
+
+						case 't':
+
+							if ((jend - jptr) > 3 && *(jptr + 1) == 'r' && *(jptr + 2) == 'u' && *(jptr + 3) == 'e') {
+								if (!_yod_jvalue_decode_new(ctx, &top, &root, __JVT_BOOLEAN)) {
 									goto e_failed;
 								}
 
-								uc_b1 = (uc_b1 << 4) | uc_b2;
-								uc_b2 = (uc_b3 << 4) | uc_b4;
-								uc2 = (uc_b1 << 8) | uc_b2;
+								top->u.bval = 1;
 
-								uc1 = 0x010000 | ((uc1 & 0x3FF) << 10) | (uc2 & 0x3FF);
-							}
+								flags |= __JVF_NEXT;
 
-							if (sizeof(char) >= sizeof(uint32_t) || (uc1 <= 0x7F)) {
-								if (!first_pass) {
-									str[str_len] = (char) uc1;
+								jptr += 3;
+							}
+							else {
+								if (!_yod_jvalue_decode_new(ctx, &top, &root, __JVT_STRING)) {
+									goto e_failed;
 								}
-								++ str_len;
-								break;
+
+								str = ctx->buf;
+								str_len = 0;
+								
+								flags |= __JVF_STRING | __JVF_NEED_QUOTE;
+
+								-- curr_col;
+								-- jptr;
+								continue;
 							}
+							break;
 
-							if (uc1 <= 0x7FF) {
-								if (!first_pass) {
-									str[str_len++] = (char) (0xC0 | (uc1 >> 6));
-									str[str_len++] = (char) (0x80 | (uc1 & 0x3F));
+						case 'f':
+
+							if ((jend - jptr) > 4 && *(jptr + 1) == 'a' && *(jptr + 2) == 'l' && *(jptr + 3) == 's' && *(jptr + 4) == 'e') {
+								if (!_yod_jvalue_decode_new(ctx, &top, &root, __JVT_BOOLEAN)) {
+									goto e_failed;
 								}
-								else {
-									str_len += 2;
+
+								flags |= __JVF_NEXT;
+
+								jptr += 4;
+							}
+							else {
+								if (!_yod_jvalue_decode_new(ctx, &top, &root, __JVT_STRING)) {
+									goto e_failed;
 								}
-								break;
+
+								str = ctx->buf;
+								str_len = 0;
+								
+								flags |= __JVF_STRING | __JVF_NEED_QUOTE;
+
+								-- curr_col;
+								-- jptr;
+								continue;
 							}
+							break;
+
+						case 'n':
 
-							if (uc1 <= 0xFFFF) {
-								if (!first_pass) {
-									str[str_len++] = (char) (0xE0 | (uc1 >> 12));
-									str[str_len++] = (char) (0x80 | ((uc1 >> 6) & 0x3F));
-									str[str_len++] = (char) (0x80 | (uc1 & 0x3F));
+							if ((jend - jptr) > 3 && *(jptr + 1) != 'u' && *(jptr + 2) != 'l' && *(jptr + 3) != 'l') {
+								if (!_yod_jvalue_decode_new(ctx, &top, &root, __JVT_NULL)) {
+									goto e_failed;
 								}
-								else {
-									str_len += 3;
+
+								flags |= __JVF_NEXT;
+
+								jptr += 3;
+							}
+							else {
+								if (!_yod_jvalue_decode_new(ctx, &top, &root, __JVT_STRING)) {
+									goto e_failed;
 								}
-								break;
+
+								str = ctx->buf;
+								str_len = 0;
+								
+								flags |= __JVF_STRING | __JVF_NEED_QUOTE;
+
+								-- curr_col;
+								-- jptr;
+								continue;
 							}
+							break;
+
+						default:
+
+							if (isdigit(b) || b == '-') {
+								if (!_yod_jvalue_decode_new(ctx, &top, &root, __JVT_INTEGER)) {
+									goto e_failed;
+								}
+
+								jnum = jptr - 1;
+
+								flags &= ~ (__JVF_NUM_NEGATIVE | __JVF_NUM_E | __JVF_NUM_E_GOT_SIGN | __JVF_NUM_E_NEGATIVE | __JVF_NUM_ZERO);
+
+								num_digits = 0;
+								num_fraction = 0;
+								num_e = 0;
+
+								if (b != '-') {
+									flags |= __JVF_REPROC;
+									break;
+								}
 
-							if (!first_pass) {
-								str[str_len++] = (char) (0xF0 | (uc1 >> 18));
-								str[str_len++] = (char) (0x80 | ((uc1 >> 12) & 0x3F));
-								str[str_len++] = (char) (0x80 | ((uc1 >> 6) & 0x3F));
-								str[str_len++] = (char) (0x80 | (uc1 & 0x3F));
+								flags |= __JVF_NUM_NEGATIVE;
+								continue;
 							}
 							else {
-								str_len += 4;
+								if (top && (top->type == __JVT_ARRAY || top->type == __JVT_OBJECT)) {
+									if (!_yod_jvalue_decode_new(ctx, &top, &root, __JVT_STRING)) {
+										goto e_failed;
+									}
+
+									str = ctx->buf;
+									str_len = 0;
+									
+									flags |= __JVF_STRING | __JVF_NEED_QUOTE;
+
+									-- curr_col;
+									-- jptr;
+									continue;
+								}
+
+								if (err) {
+									snprintf(err, 255, "Unexpected `%c` when seeking value (at %d:%d) in %s:%d %s",
+										(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
+								}
+								goto e_failed;
+							}
+					};
+			};
+		}
+		else {
+			switch (top->type)
+			{
+				case __JVT_OBJECT:
+
+					switch (b)
+					{
+						case '\n':
+						case ' ':
+						case '\t':
+						case '\r':
+							jptr = _yod_jvalue_decode_space(jptr, jend, b, &curr_line, &curr_col);
+							continue;
+
+						case '"':
+
+							if (flags & __JVF_NEED_COMMA) {
+								if (err) {
+									snprintf(err, 255, "Expected , before `\"` (at %d:%d) in %s:%d %s",
+										curr_line, curr_col, __ENV_TRACE3);
+								}
+								goto e_failed;
 							}
 
+							str = ctx->buf;
+							str_len = 0;
+
+							flags |= __JVF_STRING;
 							break;
 
-						default:
-							if (!first_pass) {
-								str[str_len] = b;
+						case '}':
+
+							flags = (flags & ~ __JVF_NEED_COMMA) | __JVF_NEXT;
+							break;
+
+						case ',':
+
+							if (flags & __JVF_NEED_COMMA) {
+								flags &= ~ __JVF_NEED_COMMA;
+								break;
 							}
-							++ str_len;
-					};
 
-					continue;
-				}
+						default:
+							if (flags & __JVF_NEED_COMMA) {
+								if (err) {
+									snprintf(err, 255, "Expected , before `%c` (at %d:%d) in %s:%d %s",
+										(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
+								}
+								goto e_failed;
+							}
 
-				if (b == '\\') {
-					flags |= __JVF_ESCAPED;
-					continue;
-				}
+							if (top && (top->type == __JVT_ARRAY || top->type == __JVT_OBJECT)) {
+								str = ctx->buf;
+								str_len = 0;
 
-				if (flags & __JVF_NEED_QUOTE) {
-					if (b == '"') {
-						if (err) {
-							snprintf(err, 255, "Unexpected `%c` in comment opening sequence (at %d:%d) in %s:%d %s",
-								(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
-						}
-						goto e_failed;
-					}
+								flags |= __JVF_STRING | __JVF_NEED_QUOTE;
 
-					if (b == ' ' || b == '\t' || b == '\r' || b == '\n' || b == ',' || b == ']' || b == '}') {
-						flags |= __JVF_REPROC;
-					}
-					else if (top->type == __JVT_OBJECT && b == ':') {
-						flags |= __JVF_REPROC;
-					}
-				}
+								-- curr_col;
+								-- jptr;
+							}
+							else {
+								if (err) {
+									snprintf(err, 255, "Unexpected `%c` in object (at %d:%d) in %s:%d %s",
+										(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
+								}
+								goto e_failed;
+							}
+							break;
+					};
 
-				if ((b == '"') || (flags & __JVF_REPROC)) {
-					if (!first_pass) {
-						str[str_len] = '\0';
-					}
+					break;
 
-					flags &= ~ __JVF_STRING;
-					str = NULL;
+				case __JVT_INTEGER:
+				case __JVT_DOUBLE:
 
-					if (flags & __JVF_REPROC) {
-						flags &= ~ (__JVF_NEED_QUOTE | __JVF_REPROC);
+					if (isdigit(b)) {
+						++ num_digits;
 
-						-- curr_col;
-						-- jptr;
-					}
+						if (top->type == __JVT_INTEGER || flags & __JVF_NUM_E) {
+							if (! (flags & __JVF_NUM_E)) {
+								if (flags & __JVF_NUM_ZERO) {
+									if (err) {
+										snprintf(err, 255, "Unexpected `0` before `%c` (at %d:%d) in %s:%d %s",
+											(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
+									}
+									goto e_failed;
+								}
 
-					switch (top->type) {
-						case __JVT_OBJECT:
-							if (!first_pass) {
-								_yod_jvalue_object_find(top, top->_reserved.u.str, &top->_reserved.index, 1);
-								top->u.object.data.ptr[top->_reserved.index].name = top->_reserved.u.str;
-								top->u.object.data.ptr[top->_reserved.index].name_len = str_len;
-								top->_reserved.u.str += str_len + 1;
+								if (num_digits == 1 && b == '0') {
+									flags |= __JVF_NUM_ZERO;
+								}
 							}
 							else {
-								top->u.object.data.num += str_len + 1;
+								flags |= __JVF_NUM_E_GOT_SIGN;
+								num_e = (num_e * 10) + (b - '0');
+								continue;
 							}
 
-							flags |= __JVF_SEEK_VALUE | __JVF_NEED_COLON;
+							top->u.ival = (top->u.ival * 10) + (b - '0');
 							continue;
+						}
 
-						case __JVT_STRING:
-							top->u.string.len = str_len;
-							flags |= __JVF_NEXT;
-							break;
-
-						default:
-							break;
-					};
-				}
-				else {
-					if (!first_pass) {
-						str[str_len] = b;
+						num_fraction = (num_fraction * 10) + (b - '0');
+						continue;
 					}
-					++ str_len;
-					continue;
-				}
-			}
 
-			/* comment */
-			if (flags & (__JVF_LINE_COMMENT | __JVF_BLOCK_COMMENT)) {
-				if (flags & __JVF_LINE_COMMENT) {
-					if (b == '\r' || b == '\n' || !b) {
-						flags &= ~ __JVF_LINE_COMMENT;
-						-- jptr;  /* so null can be reproc'd */
-						if (b == '\n') {
-							++ curr_line;
-							curr_col = 0;
-						}
-					}
-					continue;
-				}
+					if (b == '+' || b == '-') {
+						if ( (flags & __JVF_NUM_E) && !(flags & __JVF_NUM_E_GOT_SIGN)) {
+							flags |= __JVF_NUM_E_GOT_SIGN;
 
-				if (flags & __JVF_BLOCK_COMMENT) {
-					if (!b) {
-						if (err) {
-							snprintf(err, 255, "Unexpected EOF in block comment (at %d:%d) in %s:%d %s",
-								curr_line, curr_col, __ENV_TRACE3);
+							if (b == '-') {
+								flags |= __JVF_NUM_E_NEGATIVE;
+							}
+
+							continue;
 						}
-						goto e_failed;
 					}
+					else if (b == '.' && top->type == __JVT_INTEGER) {
+						if (!num_digits) {
+							if (err) {
+								snprintf(err, 255, "Expected digit before `.` (at %d:%d) in %s:%d %s",
+									curr_line, curr_col, __ENV_TRACE3);
+							}
+							goto e_failed;
+						}
 
-					if (b == '*' && jptr < (jend - 1) && jptr[1] == '/') {
-						flags &= ~ __JVF_BLOCK_COMMENT;
-						++ jptr;  /* skip closing sequence */
-					}
-					else if (b == '\n') {
-						++ curr_line;
-						curr_col = 0;
-					}
+						top->type = __JVT_DOUBLE;
+						top->u.dval = (double) top->u.ival;
 
-					continue;
-				}
-			}
-			else if (b == '/') {
-				if (!(flags & (__JVF_SEEK_VALUE | __JVF_DONE)) && top->type != __JVT_OBJECT) {
-					if (err) {
-						snprintf(err, 255, "Comment not allowed here (at %d:%d) in %s:%d %s",
-							curr_line, curr_col, __ENV_TRACE3);
+						num_digits = 0;
+						continue;
 					}
-					goto e_failed;
-				}
 
-				if (++ jptr == jend) {
-					if (err) {
-						snprintf(err, 255, "EOF unexpected (at %d:%d) in %s:%d %s",
-							curr_line, curr_col, __ENV_TRACE3);
-					}
+					if (!(flags & __JVF_NUM_E)) {
+						if (top->type == __JVT_DOUBLE) {
 
-					goto e_failed;
-				}
+							if (!num_digits) {
+								if (err) {
+									snprintf(err, 255, "Expected digit after `.` (at %d:%d) in %s:%d %s",
+										curr_line, curr_col, __ENV_TRACE3);
+								}
+								goto e_failed;
+							}
 
-				switch (b = *jptr) {
-					case '/':
-						flags |= __JVF_LINE_COMMENT;
-						continue;
+							top->u.dval += ((double) num_fraction) / (pow(10.0, (double) num_digits));
+						}
 
-					case '*':
-						flags |= __JVF_BLOCK_COMMENT;
-						continue;
+						if (b == 'e' || b == 'E') {
+							flags |= __JVF_NUM_E;
 
-					default:
-						if (top && (top->type == __JVT_ARRAY || top->type == __JVT_OBJECT)) {
-							if (!_yod_jvalue_decode_new(first_pass, &top, &root, &alloc, __JVT_STRING)) {
-								goto e_failed;
+							if (top->type == __JVT_INTEGER) {
+								top->type = __JVT_DOUBLE;
+								top->u.dval = (double) top->u.ival;
 							}
 
-							str = top->u.string.ptr;
-							str_len = 0;
-							
-							flags = (flags & ~__JVF_SEEK_VALUE) | __JVF_STRING | __JVF_NEED_QUOTE;
+							num_digits = 0;
+							flags &= ~ __JVF_NUM_ZERO;
 
-							curr_col -= 2;
-							jptr -= 2;
 							continue;
 						}
+					}
+					else {
+						if (!num_digits) {
+							if (err) {
+								snprintf(err, 255, "Expected digit after `e` (at %d:%d) in %s:%d %s",
+									curr_line, curr_col, __ENV_TRACE3);
+							}
+							goto e_failed;
+						}
 
-						if (err) {
-							snprintf(err, 255, "Unexpected `%c` in comment opening sequence (at %d:%d) in %s:%d %s",
-								(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
+						top->u.dval *= pow(10.0, (double)
+						(flags & __JVF_NUM_E_NEGATIVE ? - num_e : num_e));
+					}
+
+					if (flags & __JVF_NUM_E_NEGATIVE) {
+						if (top->type == __JVT_INTEGER) {
+							top->u.ival = - top->u.ival;
 						}
-						goto e_failed;
-				};
-			}
+						else {
+							top->u.dval = - top->u.dval;
+						}
+					}
 
-			if (flags & __JVF_DONE) {
-				if (!b) {
-					break;
-				}
+					if (b != ',' && jnum != NULL) {
+						flags &= ~ (__JVF_NUM_NEGATIVE | __JVF_NUM_ZERO | __JVF_NUM_E | __JVF_NUM_E_GOT_SIGN | __JVF_NUM_E_NEGATIVE);
 
-				switch (b) {
-					case '\n':
-						++ curr_line;
-						curr_col = 0;
+						top->type = __JVT_STRING;
+						str = ctx->buf;
+						str_len = 0;
 
-					case ' ':
-					case '\t':
-					case '\r':
+						flags |= __JVF_STRING | __JVF_NEED_QUOTE;
+
+						curr_col -= (uint32_t) (jptr - jnum);
+						jptr = jnum;
+						jnum = NULL;
 						continue;
+					}
 
-					default:
-						if (err) {
-							snprintf(err, 255, "Trailing garbage: `%c` (at %d:%d) in %s:%d %s",
-								(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
-						}
-						goto e_failed;
-				};
+					flags |= __JVF_NEXT | __JVF_REPROC;
+					break;
+
+				default:
+					break;
+			};
+		}
+
+		if (flags & __JVF_REPROC) {
+			flags &= ~ __JVF_REPROC;
+			-- curr_col;
+			-- jptr;
+		}
+
+		if (flags & __JVF_NEXT) {
+			flags = (flags & ~ __JVF_NEXT) | __JVF_NEED_COMMA;
+
+			/* nothing is reported past the root value */
+			if (ctx->func && !(flags & __JVF_DONE)) {
+				if ((ctx->stop = _yod_jvalue_decode_emit(ctx, top, (top->type == __JVT_OBJECT || top->type == __JVT_ARRAY) ? __JVE_END : __JVE_VALUE)) != 0) {
+					goto e_stop;
+				}
 			}
 
-			if (flags & __JVF_SEEK_VALUE) {
-				switch (b)
-				{
-					case '\n':
-						++ curr_line;
-						curr_col = 0;
+			if (!top->parent) {
+				/* root value done, it is closed once the input is */
+				flags |= __JVF_DONE;
+				continue;
+			}
+			parent = top->parent;
 
-					case ' ':
-					case '\t':
-					case '\r':
-						continue;
+			if (!_yod_jvalue_decode_end(ctx, top)) {
+				goto e_failed;
+			}
 
-					case ']':
+			if (parent->type == __JVT_ARRAY) {
+				flags |= __JVF_SEEK_VALUE;
+			}
 
-						if (top && top->type == __JVT_ARRAY) {
-							flags = (flags & ~ (__JVF_NEED_COMMA | __JVF_SEEK_VALUE)) | __JVF_NEXT;
+			if (ctx->func) {
+				/* reported already, only its key is left to drop */
+				_yod_jvalue_decode_drop(ctx, top);
+			}
+			else {
+				switch (parent->type) {
+					case __JVT_OBJECT:
+						/* the value of the last key, or a bare value without one */
+						if (ctx->count > parent->_reserved.index && !ctx->stack[ctx->count - 1].value) {
+							ctx->stack[ctx->count - 1].value = top;
+							break;
 						}
-						else {
-							if (err) {
-								snprintf(err, 255, "Unexpected ] (at %d:%d) in %s:%d %s",
-									curr_line, curr_col, __ENV_TRACE3);
-							}
+
+						if (!_yod_jvalue_decode_push(ctx, top, NULL, 0)) {
 							goto e_failed;
 						}
+						break;
 
+					case __JVT_ARRAY:
+						if (!_yod_jvalue_decode_push(ctx, top, NULL, 0)) {
+							goto e_failed;
+						}
 						break;
 
 					default:
+						break;
+				};
+			}
 
-						if (flags & __JVF_NEED_COMMA) {
-							if (b == ',') {
-								flags &= ~ __JVF_NEED_COMMA;
-								continue;
-							}
-							else {
-								if (err) {
-									snprintf(err, 255, "Expected , before `%c` (at %d:%d) in %s:%d %s",
-										(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
-								}
-								goto e_failed;
-							}
-						}
+			top = parent;
 
-						if (flags & __JVF_NEED_COLON) {
-							if (b == ':') {
-								flags &= ~ __JVF_NEED_COLON;
-								continue;
-							}
-							else {
-								if (err) {
-									snprintf(err, 255, "Expected : before `%c` (at %d:%d) in %s:%d %s",
-										(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
-								}
-								goto e_failed;
-							}
-						}
+			if ((++ parent->u.array.size) > YOD_JVALUE_MAX_SIZE) {
+				if (err) {
+					snprintf(err, 255, "Too long (caught overflow) (at %d:%d) in %s:%d %s",
+						curr_line, curr_col, __ENV_TRACE3);
+				}
+				goto e_failed;
+			}
 
-						flags &= ~ __JVF_SEEK_VALUE;
+			continue;
+		}
+	}
 
-						switch (b) {
-							case '{':
 
-								if (!_yod_jvalue_decode_new(first_pass, &top, &root, &alloc, __JVT_OBJECT)) {
-									goto e_failed;
-								}
-								continue;
+e_stop:
 
-							case '[':
+	/* the end of input or the event callback asked to stop */
+	ret = 1;
+	goto e_leave;
 
-								if (!_yod_jvalue_decode_new(first_pass, &top, &root, &alloc, __JVT_ARRAY)) {
-									goto e_failed;
-								}
+e_suspend:
 
-								flags |= __JVF_SEEK_VALUE;
-								continue;
+	/* more input is needed to go on from jptr, a number is kept from
+	 * its start since it turns into a bare string when not followed by , */
+	ctx->pos = (size_t) (jptr - data);
+	ctx->keep = ctx->pos;
+	ctx->num_pos = YOD_JVALUE_DECODE_NOPOS;
+
+	if (jnum && !(flags & (__JVF_SEEK_VALUE | __JVF_STRING | __JVF_DONE)) &&
+		(top->type == __JVT_INTEGER || top->type == __JVT_DOUBLE))
+	{
+		ctx->num_pos = (size_t) (jnum + 1 - data);
+		if (ctx->num_pos < ctx->keep) {
+			ctx->keep = ctx->num_pos;
+		}
+	}
+	goto e_leave;
 
-							case '"':
+e_failed:
 
-								if (!_yod_jvalue_decode_new(first_pass, &top, &root, &alloc, __JVT_STRING)) {
-									goto e_failed;
-								}
+	ret = -1;
 
-								str = top->u.string.ptr;
-								str_len = 0;
+e_leave:
 
-								flags |= __JVF_STRING;
-								continue;
+	ctx->top = top;
+	ctx->root = root;
+	ctx->flags = flags;
+	ctx->line = curr_line;
+	ctx->col = curr_col;
+	ctx->str_len = str_len;
+	ctx->num_digits = num_digits;
+	ctx->num_e = num_e;
+	ctx->num_fraction = num_fraction;
 
-							case 't':
+	return (ret);
+}
+/* }}} */
 
-								if ((jend - jptr) >= 3 && *(jptr + 1) == 'r' && *(jptr + 2) == 'u' && *(jptr + 3) == 'e') {
-									if (!_yod_jvalue_decode_new(first_pass, &top, &root, &alloc, __JVT_BOOLEAN)) {
-										goto e_failed;
-									}
 
-									top->u.bval = 1;
+/** {{{ static yod_jvalue_t *_yod_jvalue_decode_root(yod_jvalue_d *ctx)
+*/
+static yod_jvalue_t *_yod_jvalue_decode_root(yod_jvalue_d *ctx)
+{
+	yod_jvalue_t *root = ctx->root;
+	yod_jvalue_t *parent = NULL;
 
-									flags |= __JVF_NEXT;
+	/* a bare value opened after the root was done is never attached */
+	while (ctx->top != root) {
+		parent = ctx->top->parent;
+		yod_jvalue_free(ctx->top);
+		ctx->top = parent;
+	}
 
-									jptr += 3;
-								}
-								else {
-									if (!_yod_jvalue_decode_new(first_pass, &top, &root, &alloc, __JVT_STRING)) {
-										goto e_failed;
-									}
+	if (!_yod_jvalue_decode_end(ctx, root)) {
+		return NULL;
+	}
 
-									str = top->u.string.ptr;
-									str_len = 0;
-									
-									flags |= __JVF_STRING | __JVF_NEED_QUOTE;
+	/* the tree owns the arena now */
+	ctx->arena = NULL;
+	ctx->top = ctx->root = NULL;
 
-									-- curr_col;
-									-- jptr;
-									continue;
-								}
-								break;
+	return root;
+}
+/* }}} */
 
-							case 'f':
 
-								if ((jend - jptr) >= 4 && *(jptr + 1) == 'a' && *(jptr + 2) == 'l' && *(jptr + 3) == 's' && *(jptr + 4) == 'e') {
-									if (!_yod_jvalue_decode_new(first_pass, &top, &root, &alloc, __JVT_BOOLEAN)) {
-										goto e_failed;
-									}
+/** {{{ static void _yod_jvalue_decode_init(yod_jvalue_d *ctx, int opts)
+*/
+static void _yod_jvalue_decode_init(yod_jvalue_d *ctx, int opts)
+{
+	if (!yod_jvalue_scan_plain__) {
+		_yod_jvalue_scan_init();
+	}
 
-									flags |= __JVF_NEXT;
+	memset(ctx, 0, sizeof(yod_jvalue_d));
+	ctx->opts = opts;
 
-									jptr += 4;
-								}
-								else {
-									if (!_yod_jvalue_decode_new(first_pass, &top, &root, &alloc, __JVT_STRING)) {
-										goto e_failed;
-									}
+	_yod_jvalue_decode_clear(ctx);
+}
+/* }}} */
 
-									str = top->u.string.ptr;
-									str_len = 0;
-									
-									flags |= __JVF_STRING | __JVF_NEED_QUOTE;
 
-									-- curr_col;
-									-- jptr;
-									continue;
-								}
-								break;
+/** {{{ static int _yod_jvalue_decode_new(yod_jvalue_d *ctx, yod_jvalue_t **top, yod_jvalue_t **root, int type)
+*/
+static int _yod_jvalue_decode_new(yod_jvalue_d *ctx, yod_jvalue_t **top, yod_jvalue_t **root, int type)
+{
+	yod_jvalue_t *value = NULL;
 
-							case 'n':
+	if (ctx->spare) {
+		value = ctx->spare;
+		ctx->spare = value->parent;
+	}
+	else if ((value = (yod_jvalue_t *) _yod_jvalue_decode_alloc(ctx, sizeof(yod_jvalue_t))) == NULL) {
+		return (0);
+	}
 
-								if ((jend - jptr) >= 3 && *(jptr + 1) != 'u' && *(jptr + 2) != 'l' && *(jptr + 3) != 'l') {
-									if (!_yod_jvalue_decode_new(first_pass, &top, &root, &alloc, __JVT_NULL)) {
-										goto e_failed;
-									}
+	memset(value, 0, sizeof(yod_jvalue_t));
 
-									flags |= __JVF_NEXT;
+	if (ctx->arena) {
+		value->flags = __JVN_ARENA;
+	}
 
-									jptr += 3;
-								}
-								else {
-									if (!_yod_jvalue_decode_new(first_pass, &top, &root, &alloc, __JVT_STRING)) {
-										goto e_failed;
-									}
+	if (!*root) {
+		/* the arena root is its first allocation, see _yod_jvalue_free */
+		if (ctx->arena) {
+			value->flags |= __JVN_ROOT;
+		}
+		*root = value;
+	}
 
-									str = top->u.string.ptr;
-									str_len = 0;
-									
-									flags |= __JVF_STRING | __JVF_NEED_QUOTE;
+	value->type = type;
+	value->parent = *top;
 
-									-- curr_col;
-									-- jptr;
-									continue;
-								}
-								break;
+	/* members wait on ctx->stack until the container is closed,
+	 * an open object keeps the offset of its first name in count */
+	switch (type) {
+		case __JVT_OBJECT:
+			value->u.object.count = ctx->names_len;
+			value->_reserved.index = ctx->count;
+			break;
 
-							default:
+		case __JVT_ARRAY:
+			value->_reserved.index = ctx->count;
+			break;
 
-								if (isdigit(b) || b == '-') {
-									if (!_yod_jvalue_decode_new(first_pass, &top, &root, &alloc, __JVT_INTEGER)) {
-										goto e_failed;
-									}
+		default:
+			break;
+	};
+
+	*top = value;
+
+	return (1);
+}
+/* }}} */
+
+
+/** {{{ static int _yod_jvalue_decode_push(yod_jvalue_d *ctx, yod_jvalue_t *value, char *name, size_t name_len)
+*/
+static int _yod_jvalue_decode_push(yod_jvalue_d *ctx, yod_jvalue_t *value, char *name, size_t name_len)
+{
+	yod_jvalue_e *item = NULL;
+	void *ptr = NULL;
+
+	if ((ctx->count + 1) * sizeof(yod_jvalue_e) > ctx->stack_size) {
+		if ((ptr = _yod_jvalue_decode_grow(ctx->stack, &ctx->stack_size, (ctx->count + 1) * sizeof(yod_jvalue_e))) == NULL) {
+			return (0);
+		}
+		ctx->stack = (yod_jvalue_e *) ptr;
+	}
 
-									if (top->type == __JVT_STRING) {
-										str = top->u.string.ptr;
-										str_len = 0;
+	if (name) {
+		if (ctx->names_len + name_len + 1 > ctx->names_size) {
+			if ((ptr = _yod_jvalue_decode_grow(ctx->names, &ctx->names_size, ctx->names_len + name_len + 1)) == NULL) {
+				return (0);
+			}
+			ctx->names = (char *) ptr;
+		}
+	}
 
-										flags |= __JVF_STRING | __JVF_NEED_QUOTE;
+	item = ctx->stack + ctx->count ++;
+	item->name = ctx->names_len;
+	item->name_len = name ? name_len : YOD_JVALUE_DECODE_NONAME;
+	item->value = value;
 
-										-- curr_col;
-										-- jptr;
-										continue;
-									}
+	if (name) {
+		memcpy(ctx->names + ctx->names_len, name, name_len);
+		ctx->names[ctx->names_len + name_len] = '\0';
+		ctx->names_len += name_len + 1;
+	}
 
-									jnum = jptr - 1;
+	return (1);
+}
+/* }}} */
 
-									if (!first_pass) {
-										while (isdigit(b) || b == '+' || b == '-' || b == 'e' || b == 'E' || b == '.') {
-											++ curr_col;
-											if ( (++ jptr) == jend) {
-												b = '\0';
-												break;
-											}
 
-											b = *jptr;
-										}
+/** {{{ static int _yod_jvalue_decode_end(yod_jvalue_d *ctx, yod_jvalue_t *value)
+*/
+static int _yod_jvalue_decode_end(yod_jvalue_d *ctx, yod_jvalue_t *value)
+{
+	yod_jvalue_e *item = NULL;
+	yod_jvalue_v *data = NULL;
+	size_t count = 0;
+	size_t index = 0;
+	size_t data_len = 0;
+	size_t slot_len = 0;
+	size_t name_len = 0;
+	size_t name_off = 0;
+	char *name = NULL;
+	size_t i = 0;
+	size_t k = 0;
 
-										flags |= __JVF_NEXT | __JVF_REPROC;
-										break;
-									}
+	item = ctx->stack + value->_reserved.index;
+	count = ctx->count - value->_reserved.index;
 
-									flags &= ~ (__JVF_NUM_NEGATIVE | __JVF_NUM_E | __JVF_NUM_E_GOT_SIGN | __JVF_NUM_E_NEGATIVE | __JVF_NUM_ZERO);
+	switch (value->type) {
+		case __JVT_OBJECT:
 
-									num_digits = 0;
-									num_fraction = 0;
-									num_e = 0;
+			name_off = value->u.object.count;
+			name_len = ctx->names_len - name_off;
+			value->u.object.count = 0;
 
-									if (b != '-') {
-										flags |= __JVF_REPROC;
-										break;
-									}
+			if (count == 0) {
+				break;
+			}
 
-									flags |= __JVF_NUM_NEGATIVE;
-									continue;
-								}
-								else {
-									if (top && (top->type == __JVT_ARRAY || top->type == __JVT_OBJECT)) {
-										if (!_yod_jvalue_decode_new(first_pass, &top, &root, &alloc, __JVT_STRING)) {
-											goto e_failed;
-										}
-
-										str = top->u.string.ptr;
-										str_len = 0;
-										
-										flags |= __JVF_STRING | __JVF_NEED_QUOTE;
-
-										-- curr_col;
-										-- jptr;
-										continue;
-									}
+			data_len = (count + 1) * sizeof(yod_jvalue_v);
+			slot_len = _yod_jvalue_object_slots(count) * sizeof(uint32_t);
+			data = (yod_jvalue_v *) _yod_jvalue_decode_alloc(ctx, data_len + slot_len + name_len);
+			if (!data) {
+				return (0);
+			}
 
-									if (err) {
-										snprintf(err, 255, "Unexpected `%c` when seeking value (at %d:%d) in %s:%d %s",
-											(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
-									}
-									goto e_failed;
-								}
-						};
-				};
+			name = (char *) data + data_len + slot_len;
+			if (name_len > 0) {
+				memcpy(name, ctx->names + name_off, name_len);
 			}
-			else {
-				switch (top->type)
-				{
-					case __JVT_OBJECT:
 
-						switch (b)
-						{
-							case '\n':
-								++ curr_line;
-								curr_col = 0;
+			data[count].name = name;
+			data[count].name_len = name_len;
+			data[count].value = NULL;
 
-							case ' ':
-							case '\t':
-							case '\r':
-								continue;
+			value->u.object.data.ptr = data;
+			value->u.object.size = count;
+
+			if (slot_len) {
+				memset((char *) data + data_len, 0, slot_len);
+				value->flags |= __JVN_INDEX;
+			}
 
-							case '"':
+			/* a large sorted object is filled in document order and
+			 * sorted once, rather than shifted on every insert */
+			if (slot_len || (ctx->opts & __JVD_INSERT)) {
+				value->flags |= __JVN_INSERT;
+			}
 
-								if (flags & __JVF_NEED_COMMA) {
-									if (err) {
-										snprintf(err, 255, "Expected , before `\"` (at %d:%d) in %s:%d %s",
-											curr_line, curr_col, __ENV_TRACE3);
-									}
-									goto e_failed;
+			/* insert in document order, the last duplicate wins and a
+			 * value without a key replaces the value of the first member */
+			for (i = 0; i < count; ++ i, ++ item) {
+				if (item->name_len == YOD_JVALUE_DECODE_NONAME) {
+					if (value->u.object.count > 0) {
+						index = 0;
+						if (!(ctx->opts & __JVD_INSERT)) {
+							for (k = 1; k < value->u.object.count; ++ k) {
+								if (strcmp(data[k].name, data[index].name) < 0) {
+									index = k;
 								}
+							}
+						}
+						yod_jvalue_free(data[index].value);
+						data[index].value = item->value;
+					}
+					else {
+						yod_jvalue_free(item->value);
+					}
+					continue;
+				}
 
-								str = top->_reserved.u.str;
-								str_len = 0;
-
-								flags |= __JVF_STRING;
-								break;
+				name = (char *) data + data_len + slot_len + (item->name - name_off);
+				if (_yod_jvalue_object_find(value, name, &index, 1) == 0) {
+					yod_jvalue_free(data[index].value);
+				}
+				data[index].name = name;
+				data[index].name_len = item->name_len;
+				data[index].value = item->value;
+			}
 
-							case '}':
+			if (slot_len && !(ctx->opts & __JVD_INSERT)) {
+				value->flags &= ~ __JVN_INSERT;
+				_yod_jvalue_object_sort(value);
+			}
 
-								flags = (flags & ~ __JVF_NEED_COMMA) | __JVF_NEXT;
-								break;
+			ctx->names_len = name_off;
+			break;
 
-							case ',':
+		case __JVT_ARRAY:
 
-								if (flags & __JVF_NEED_COMMA) {
-									flags &= ~ __JVF_NEED_COMMA;
-									break;
-								}
+			if (count == 0) {
+				break;
+			}
 
-							default:
-								if (flags & __JVF_NEED_COMMA) {
-									if (err) {
-										snprintf(err, 255, "Expected , before `%c` (at %d:%d) in %s:%d %s",
-											(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
-									}
-									goto e_failed;
-								}
+			value->u.array.data = (yod_jvalue_t **) _yod_jvalue_decode_alloc(ctx, count * sizeof(yod_jvalue_t *));
+			if (!value->u.array.data) {
+				return (0);
+			}
 
-								if (top && (top->type == __JVT_ARRAY || top->type == __JVT_OBJECT)) {
-									str = top->_reserved.u.str;
-									str_len = 0;
+			for (i = 0; i < count; ++ i, ++ item) {
+				value->u.array.data[i] = item->value;
+			}
 
-									flags |= __JVF_STRING | __JVF_NEED_QUOTE;
+			value->u.array.count = count;
+			break;
 
-									-- curr_col;
-									-- jptr;
-								}
-								else {
-									if (err) {
-										snprintf(err, 255, "Unexpected `%c` in object (at %d:%d) in %s:%d %s",
-											(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
-									}
-									goto e_failed;
-								}
-								break;
-						};
+		default:
+			return (1);
+	};
 
-						break;
+	value->_reserved.index = 0;
+	ctx->count -= count;
 
-					case __JVT_INTEGER:
-					case __JVT_DOUBLE:
+	return (1);
+}
+/* }}} */
 
-						if (isdigit(b)) {
-							++ num_digits;
 
-							if (top->type == __JVT_INTEGER || flags & __JVF_NUM_E) {
-								if (! (flags & __JVF_NUM_E)) {
-									if (flags & __JVF_NUM_ZERO) {
-										if (err) {
-											snprintf(err, 255, "Unexpected `0` before `%c` (at %d:%d) in %s:%d %s",
-												(b ? b : '\1'), curr_line, curr_col, __ENV_TRACE3);
-										}
-										goto e_failed;
-									}
+/** {{{ static void _yod_jvalue_decode_clear(yod_jvalue_d *ctx)
+*/
+static void _yod_jvalue_decode_clear(yod_jvalue_d *ctx)
+{
+	yod_jvalue_t *parent = NULL;
+	size_t i = 0;
 
-									if (num_digits == 1 && b == '0') {
-										flags |= __JVF_NUM_ZERO;
-									}
-								}
-								else {
-									flags |= __JVF_NUM_E_GOT_SIGN;
-									num_e = (num_e * 10) + (b - '0');
-									continue;
-								}
+	/* a failed decode owns the stacked members and the open containers */
+	if (ctx->arena) {
+		_yod_jvalue_arena_free(ctx->arena);
+	}
+	else if (ctx->func) {
+		/* event nodes point into ctx->buf at most */
+		while (ctx->top) {
+			parent = ctx->top->parent;
+			free(ctx->top);
+			ctx->top = parent;
+		}
+	}
+	else {
+		for (i = 0; i < ctx->count; ++ i) {
+			yod_jvalue_free(ctx->stack[i].value);
+		}
 
-								top->u.ival = (top->u.ival * 10) + (b - '0');
-								continue;
-							}
+		while (ctx->top) {
+			parent = ctx->top->parent;
+			yod_jvalue_free(ctx->top);
+			ctx->top = parent;
+		}
+	}
 
-							num_fraction = (num_fraction * 10) + (b - '0');
-							continue;
-						}
+	ctx->arena = NULL;
+	ctx->top = NULL;
+	ctx->root = NULL;
+	ctx->count = 0;
+	ctx->names_len = 0;
+	ctx->tail_len = 0;
+	ctx->closed = 0;
+	ctx->stop = 0;
+
+	ctx->flags = __JVF_SEEK_VALUE;
+	ctx->line = 1;
+	ctx->col = 0;
+	ctx->str_len = 0;
+	ctx->num_digits = 0;
+	ctx->num_e = 0;
+	ctx->num_fraction = 0;
+	ctx->num_pos = YOD_JVALUE_DECODE_NOPOS;
+	ctx->pos = 0;
+	ctx->keep = 0;
+	ctx->total = 0;
+}
+/* }}} */
 
-						if (b == '+' || b == '-') {
-							if ( (flags & __JVF_NUM_E) && !(flags & __JVF_NUM_E_GOT_SIGN)) {
-								flags |= __JVF_NUM_E_GOT_SIGN;
 
-								if (b == '-') {
-									flags |= __JVF_NUM_E_NEGATIVE;
-								}
+/** {{{ static void _yod_jvalue_decode_free(yod_jvalue_d *ctx)
+*/
+static void _yod_jvalue_decode_free(yod_jvalue_d *ctx)
+{
+	yod_jvalue_t *value = NULL;
 
-								continue;
-							}
-						}
-						else if (b == '.' && top->type == __JVT_INTEGER) {
-							if (!num_digits) {
-								if (err) {
-									snprintf(err, 255, "Expected digit before `.` (at %d:%d) in %s:%d %s",
-										curr_line, curr_col, __ENV_TRACE3);
-								}
-								goto e_failed;
-							}
+	_yod_jvalue_decode_clear(ctx);
 
-							top->type = __JVT_DOUBLE;
-							top->u.dval = (double) top->u.ival;
+	while (ctx->spare) {
+		value = ctx->spare;
+		ctx->spare = value->parent;
+		free(value);
+	}
 
-							num_digits = 0;
-							continue;
-						}
+	if (ctx->stack) {
+		free(ctx->stack);
+	}
 
-						if (!(flags & __JVF_NUM_E)) {
-							if (top->type == __JVT_DOUBLE) {
+	if (ctx->names) {
+		free(ctx->names);
+	}
 
-								if (!num_digits) {
-									if (err) {
-										snprintf(err, 255, "Expected digit after `.` (at %d:%d) in %s:%d %s",
-											curr_line, curr_col, __ENV_TRACE3);
-									}
-									goto e_failed;
-								}
+	if (ctx->buf) {
+		free(ctx->buf);
+	}
 
-								top->u.dval += ((double) num_fraction) / (pow(10.0, (double) num_digits));
-							}
+	if (ctx->tail) {
+		free(ctx->tail);
+	}
+}
+/* }}} */
 
-							if (b == 'e' || b == 'E') {
-								flags |= __JVF_NUM_E;
 
-								if (top->type == __JVT_INTEGER) {
-									top->type = __JVT_DOUBLE;
-									top->u.dval = (double) top->u.ival;
-								}
+/** {{{ static int _yod_jvalue_decode_hold(yod_jvalue_d *ctx, const char *data, size_t len)
+*/
+static int _yod_jvalue_decode_hold(yod_jvalue_d *ctx, const char *data, size_t len)
+{
+	char *ptr = NULL;
 
-								num_digits = 0;
-								flags &= ~ __JVF_NUM_ZERO;
+	/* kept NUL terminated, the final pass may look one byte past it */
+	if (ctx->tail_len + len + 1 > ctx->tail_size) {
+		if ((ptr = _yod_jvalue_decode_grow(ctx->tail, &ctx->tail_size, ctx->tail_len + len + 1)) == NULL) {
+			return (0);
+		}
+		ctx->tail = ptr;
+	}
 
-								continue;
-							}
-						}
-						else {
-							if (!num_digits) {
-								if (err) {
-									snprintf(err, 255, "Expected digit after `e` (at %d:%d) in %s:%d %s",
-										curr_line, curr_col, __ENV_TRACE3);
-								}
-								goto e_failed;
-							}
+	memcpy(ctx->tail + ctx->tail_len, data, len);
+	ctx->tail_len += len;
+	ctx->tail[ctx->tail_len] = '\0';
 
-							top->u.dval *= pow(10.0, (double)
-							(flags & __JVF_NUM_E_NEGATIVE ? - num_e : num_e));
-						}
+	return (1);
+}
+/* }}} */
 
-						if (flags & __JVF_NUM_E_NEGATIVE) {
-							if (top->type == __JVT_INTEGER) {
-								top->u.ival = - top->u.ival;
-							}
-							else {
-								top->u.dval = - top->u.dval;
-							}
-						}
 
-						if (b != ',' && jnum != NULL) {
-							flags &= ~ (__JVF_NUM_NEGATIVE | __JVF_NUM_ZERO | __JVF_NUM_E | __JVF_NUM_E_GOT_SIGN | __JVF_NUM_E_NEGATIVE);
+/** {{{ static void _yod_jvalue_decode_move(yod_jvalue_d *ctx, size_t len)
+*/
+static void _yod_jvalue_decode_move(yod_jvalue_d *ctx, size_t len)
+{
+	ctx->pos -= len;
+	ctx->keep -= len;
 
-							top->type = __JVT_STRING;
-							str = top->u.string.ptr;
-							str_len = 0;
+	if (ctx->num_pos != YOD_JVALUE_DECODE_NOPOS) {
+		ctx->num_pos -= len;
+	}
+}
+/* }}} */
 
-							flags |= __JVF_STRING | __JVF_NEED_QUOTE;
 
-							curr_col -= (uint32_t) (jptr - jnum);
-							jptr = jnum;
-							jnum = NULL;
-							continue;
-						}
+/** {{{ static int _yod_jvalue_decode_emit(yod_jvalue_d *ctx, yod_jvalue_t *value, int event)
+*/
+static int _yod_jvalue_decode_emit(yod_jvalue_d *ctx, yod_jvalue_t *value, int event)
+{
+	yod_jvalue_t *parent = value->parent;
+	yod_jvalue_e *item = NULL;
+
+	/* a member of an object goes with the key pushed last */
+	if (parent && parent->type == __JVT_OBJECT && ctx->count > parent->_reserved.index) {
+		item = ctx->stack + ctx->count - 1;
+		if (!item->value) {
+			return ctx->func(event, ctx->names + item->name, item->name_len, value, ctx->arg __ENV_CARGS);
+		}
+	}
 
-						flags |= __JVF_NEXT | __JVF_REPROC;
-						break;
+	return ctx->func(event, NULL, 0, value, ctx->arg __ENV_CARGS);
+}
+/* }}} */
 
-					default:
-						break;
-				};
-			}
 
-			if (flags & __JVF_REPROC) {
-				flags &= ~ __JVF_REPROC;
-				-- curr_col;
-				-- jptr;
-			}
+/** {{{ static void _yod_jvalue_decode_drop(yod_jvalue_d *ctx, yod_jvalue_t *value)
+*/
+static void _yod_jvalue_decode_drop(yod_jvalue_d *ctx, yod_jvalue_t *value)
+{
+	yod_jvalue_t *parent = value->parent;
 
-			if (flags & __JVF_NEXT) {
-				flags = (flags & ~ __JVF_NEXT) | __JVF_NEED_COMMA;
+	if (parent->type == __JVT_OBJECT && ctx->count > parent->_reserved.index && !ctx->stack[ctx->count - 1].value) {
+		-- ctx->count;
+		ctx->names_len = ctx->stack[ctx->count].name;
+	}
 
-				if (!top->parent) {
-					/* root value done */
-					flags |= __JVF_DONE;
-					continue;
-				}
-				parent = top->parent;
+	value->parent = ctx->spare;
+	ctx->spare = value;
+}
+/* }}} */
 
-				if (parent->type == __JVT_ARRAY) {
-					flags |= __JVF_SEEK_VALUE;
-				}
 
-				if (!first_pass) {
-					switch (parent->type) {
-						case __JVT_OBJECT:
-							parent->u.object.data.ptr[parent->_reserved.index].value = top;
-							parent->_reserved.index = 0;
-							break;
+/** {{{ static void *_yod_jvalue_decode_alloc(yod_jvalue_d *ctx, size_t size)
+*/
+static void *_yod_jvalue_decode_alloc(yod_jvalue_d *ctx, size_t size)
+{
+	void *ret = NULL;
 
-						case __JVT_ARRAY:
-							parent->u.array.data[parent->u.array.count ++] = top;
-							break;
+	if (ctx->arena) {
+		ret = _yod_jvalue_arena_alloc(ctx->arena, size);
+	}
+	else {
+		ret = malloc(size);
+	}
 
-						default:
-							break;
-					};
-				}
+	if (!ret) {
+		YOD_STDLOG_ERROR("malloc failed");
+	}
 
-				if ((++ parent->u.array.size) > YOD_JVALUE_MAX_SIZE) {
-					if (err) {
-						snprintf(err, 255, "Too long (caught overflow) (at %d:%d) in %s:%d %s",
-							curr_line, curr_col, __ENV_TRACE3);
-					}
-					goto e_failed;
-				}
+	return ret;
+}
+/* }}} */
 
-				top = parent;
 
-				continue;
-			}
-		}
+/** {{{ static void *_yod_jvalue_decode_grow(void *ptr, size_t *size, size_t need)
+*/
+static void *_yod_jvalue_decode_grow(void *ptr, size_t *size, size_t need)
+{
+	size_t len = *size ? *size : YOD_JVALUE_DECODE_SIZE;
 
-		alloc = root;
+	while (len < need) {
+		len <<= 1;
 	}
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %d, %s): %p in %s:%d %s",
-		__FUNCTION__, data, len, err, root, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
+	if ((ptr = realloc(ptr, len)) == NULL) {
+		YOD_STDLOG_ERROR("realloc failed");
+		return NULL;
+	}
 
-	return root;
+	*size = len;
 
-e_failed:
+	return ptr;
+}
+/* }}} */
 
-	if (first_pass) {
-		alloc = root;
-	}
 
-	while (alloc) {
-		top = alloc->_reserved.u.ptr;
-		free(alloc);
-		alloc = top;
-	}
+/** {{{ static size_t _yod_jvalue_decode_lazy(yod_jvalue_d *ctx, yod_jvalue_t *value, size_t pos)
+*/
+static size_t _yod_jvalue_decode_lazy(yod_jvalue_d *ctx, yod_jvalue_t *value, size_t pos)
+{
+	yod_jvalue_i *entry = NULL;
 
-	if (!first_pass)	{
-		yod_jvalue_free(root);
+	/* a bracket the index does not know is read at once */
+	if ((entry = _yod_jvalue_mapped_find(ctx->doc, ctx->doc_off + pos)) == NULL) {
+		return (0);
 	}
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %d, %s): %p in %s:%d %s",
-		__FUNCTION__, data, len, err, NULL, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
+	value->flags |= __JVN_LAZY;
+	value->_reserved.u.ptr = entry;
 
-	return NULL;
+	return entry->close - ctx->doc_off;
 }
 /* }}} */
 
 
-/** {{{ yod_jvalue_t *_yod_jvalue_object_new(size_t size __ENV_CPARM)
+/** {{{ static const char *_yod_jvalue_decode_space(const char *jptr, const char *jend, char b, uint32_t *line, uint32_t *col)
 */
-yod_jvalue_t *_yod_jvalue_object_new(size_t size __ENV_CPARM)
+static const char *_yod_jvalue_decode_space(const char *jptr, const char *jend, char b, uint32_t *line, uint32_t *col)
 {
-	yod_jvalue_t *self = NULL;
+	const char *jrun = NULL;
 
-	self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t));
-	if (!self) {
-		YOD_STDLOG_ERROR("malloc failed");
-		return NULL;
+	/* b itself is already counted */
+	if (b == '\n') {
+		++ *line;
+		*col = 0;
 	}
 
-	self->type = __JVT_OBJECT;
-	self->u.object.count = 0;
-	self->u.object.size = size;
-	self->u.object.data.ptr = calloc((size + 1), sizeof(yod_jvalue_v));
-	if (!self->u.object.data.ptr) {
-		yod_jvalue_free(self);
+	/* jptr was stepped back to reprocess b, which comes round again */
+	if (*jptr != b) {
+		return jptr;
+	}
 
-		YOD_STDLOG_ERROR("calloc failed");
-		return NULL;
+	jrun = yod_jvalue_scan_space__(jptr + 1, jend);
+
+	while (++ jptr < jrun) {
+		if (*jptr == '\n') {
+			++ *line;
+			*col = 0;
+		}
+		else {
+			++ *col;
+		}
 	}
 
-	self->u.object.data.ptr[size].name = NULL;
-	self->u.object.data.ptr[size].name_len = 0;
-	self->u.object.data.ptr[size].value = NULL;
+	/* the caller steps onto jrun */
+	return jrun - 1;
+}
+/* }}} */
+
+
+/** {{{ static void _yod_jvalue_scan_init(void)
+*/
+static void _yod_jvalue_scan_init(void)
+{
+	const char *(*scan_plain) (const char *, const char *) = _yod_jvalue_scan_plain;
+	const char *(*scan_space) (const char *, const char *) = _yod_jvalue_scan_space;
 
-	self->parent = NULL;
-	self->_reserved.u.ptr = NULL;
-	self->_reserved.index = 0;
+#if (_YOD_JVALUE_SIMD)
+	__builtin_cpu_init();
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%d): %p in %s:%d %s",
-		__FUNCTION__, size, self, __ENV_TRACE);
-#else
-	__ENV_VOID
+	if (__builtin_cpu_supports("avx2")) {
+		scan_plain = _yod_jvalue_scan_plain_avx2;
+		scan_space = _yod_jvalue_scan_space_avx2;
+	}
+	else if (__builtin_cpu_supports("sse4.2")) {
+		scan_plain = _yod_jvalue_scan_plain_sse42;
+		scan_space = _yod_jvalue_scan_space_sse42;
+	}
 #endif
 
-	return self;
+	/* racing callers store the same pointers */
+	yod_jvalue_scan_space__ = scan_space;
+	yod_jvalue_scan_plain__ = scan_plain;
 }
 /* }}} */
 
 
-/** {{{ int _yod_jvalue_object_set(yod_jvalue_t *self, const char *name, yod_jvalue_t *value __ENV_CPARM)
+/** {{{ static const char *_yod_jvalue_scan_plain(const char *ptr, const char *end)
 */
-int _yod_jvalue_object_set(yod_jvalue_t *self, const char *name, yod_jvalue_t *value __ENV_CPARM)
+static const char *_yod_jvalue_scan_plain(const char *ptr, const char *end)
 {
-	size_t name_len = 0;
-	size_t index = 0;
-	int ret = 0;
-
-	if (!self || !name) {
-		return (-1);
+	while (ptr < end && *ptr != '"' && *ptr != '\\' && *ptr != '\0') {
+		++ ptr;
 	}
 
-	if (self->type != __JVT_OBJECT) {
-		YOD_STDLOG_WARN("illegal jvalue");
-		return (-1);
-	}
+	return ptr;
+}
+/* }}} */
 
-	if (_yod_jvalue_object_find(self, (char *) name, &index, 1) != 0) {
-		if (index >= self->u.object.size) {
-			YOD_STDLOG_WARN("index overflow");
-			return (-1);
-		}
-		name_len = strlen(name);;
-		self->u.object.data.ptr[index].name = (char *) name;
-		self->u.object.data.ptr[index].name_len = name_len;
-		self->u.object.data.ptr[index].value = value;
-		self->u.object.data.ptr[self->u.object.size].name_len += name_len + 1;
+
+/** {{{ static const char *_yod_jvalue_scan_space(const char *ptr, const char *end)
+*/
+static const char *_yod_jvalue_scan_space(const char *ptr, const char *end)
+{
+	while (ptr < end && (*ptr == ' ' || *ptr == '\t' || *ptr == '\r' || *ptr == '\n')) {
+		++ ptr;
 	}
-	else {
-		if (self->u.object.data.ptr[index].value) {
-			yod_jvalue_free(self->u.object.data.ptr[index].value);
+
+	return ptr;
+}
+/* }}} */
+
+
+#if (_YOD_JVALUE_SIMD)
+/** {{{ static const char *_yod_jvalue_scan_plain_sse42(const char *ptr, const char *end)
+*/
+__attribute__((target("sse4.2")))
+static const char *_yod_jvalue_scan_plain_sse42(const char *ptr, const char *end)
+{
+	const __m128i set = _mm_setr_epi8('"', '\\', '\0', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+	int i = 0;
+
+	while (end - ptr >= 16) {
+		i = _mm_cmpestri(set, 3, _mm_loadu_si128((const __m128i *) ptr), 16,
+			_SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+		if (i < 16) {
+			return ptr + i;
 		}
-		self->u.object.data.ptr[index].value = value;
+		ptr += 16;
 	}
 
-	if (value) {
-		value->parent = self;
-	}
+	return _yod_jvalue_scan_plain(ptr, end);
+}
+/* }}} */
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %s, %p): %d in %s:%d %s",
-		__FUNCTION__, self, name, value, ret, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
 
-	return ret;
+/** {{{ static const char *_yod_jvalue_scan_space_sse42(const char *ptr, const char *end)
+*/
+__attribute__((target("sse4.2")))
+static const char *_yod_jvalue_scan_space_sse42(const char *ptr, const char *end)
+{
+	const __m128i set = _mm_setr_epi8(' ', '\t', '\r', '\n', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+	int i = 0;
+
+	while (end - ptr >= 16) {
+		i = _mm_cmpestri(set, 4, _mm_loadu_si128((const __m128i *) ptr), 16,
+			_SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT);
+		if (i < 16) {
+			return ptr + i;
+		}
+		ptr += 16;
+	}
+
+	return _yod_jvalue_scan_space(ptr, end);
 }
 /* }}} */
 
 
-/** {{{ yod_jvalue_t *_yod_jvalue_object_get(yod_jvalue_t *self, const char *name __ENV_CPARM)
+/** {{{ static const char *_yod_jvalue_scan_plain_avx2(const char *ptr, const char *end)
 */
-yod_jvalue_t *_yod_jvalue_object_get(yod_jvalue_t *self, const char *name __ENV_CPARM)
+__attribute__((target("avx2")))
+static const char *_yod_jvalue_scan_plain_avx2(const char *ptr, const char *end)
 {
-	yod_jvalue_t *ret = NULL;
-	size_t index = 0;
-
-	if (!self) {
-		return NULL;
+	const __m256i quote = _mm256_set1_epi8('"');
+	const __m256i slash = _mm256_set1_epi8('\\');
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i data;
+	uint32_t mask = 0;
+
+	while (end - ptr >= 32) {
+		data = _mm256_loadu_si256((const __m256i *) ptr);
+		mask = (uint32_t) _mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(
+			_mm256_cmpeq_epi8(data, quote), _mm256_cmpeq_epi8(data, slash)), _mm256_cmpeq_epi8(data, zero)));
+		if (mask) {
+			return ptr + __builtin_ctz(mask);
+		}
+		ptr += 32;
 	}
 
-	if (self->type == __JVT_OBJECT) {
-		if (_yod_jvalue_object_find(self, (char *) name, &index, 0) == 0) {
-			ret = self->u.object.data.ptr[index].value;
+	return _yod_jvalue_scan_plain(ptr, end);
+}
+/* }}} */
+
+
+/** {{{ static const char *_yod_jvalue_scan_space_avx2(const char *ptr, const char *end)
+*/
+__attribute__((target("avx2")))
+static const char *_yod_jvalue_scan_space_avx2(const char *ptr, const char *end)
+{
+	const __m256i sp = _mm256_set1_epi8(' ');
+	const __m256i ht = _mm256_set1_epi8('\t');
+	const __m256i cr = _mm256_set1_epi8('\r');
+	const __m256i lf = _mm256_set1_epi8('\n');
+	__m256i data;
+	uint32_t mask = 0;
+
+	while (end - ptr >= 32) {
+		data = _mm256_loadu_si256((const __m256i *) ptr);
+		mask = ~ (uint32_t) _mm256_movemask_epi8(_mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(data, sp), _mm256_cmpeq_epi8(data, ht)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(data, cr), _mm256_cmpeq_epi8(data, lf))));
+		if (mask) {
+			return ptr + __builtin_ctz(mask);
 		}
+		ptr += 32;
 	}
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %s): %p in %s:%d %s",
-		__FUNCTION__, self, name, ret, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
-
-	return ret;
+	return _yod_jvalue_scan_space(ptr, end);
 }
 /* }}} */
+#endif
 
 
-/** {{{ yod_jvalue_t *_yod_jvalue_object_fetch(yod_jvalue_t *self, size_t index, char **name, size_t *name_len __ENV_CPARM)
+/** {{{ static yod_jvalue_a *_yod_jvalue_arena_new(size_t size)
 */
-yod_jvalue_t *_yod_jvalue_object_fetch(yod_jvalue_t *self, size_t index, char **name, size_t *name_len __ENV_CPARM)
+static yod_jvalue_a *_yod_jvalue_arena_new(size_t size)
 {
-	yod_jvalue_t *ret = NULL;
+	yod_jvalue_a *self = NULL;
 
-	if (!self) {
-		return NULL;
+	if (size < YOD_JVALUE_ARENA_SIZE) {
+		size = YOD_JVALUE_ARENA_SIZE;
 	}
 
-	if (self->type == __JVT_OBJECT) {
-		if (index < self->u.object.count) {
-			if (name) {
-				*name = self->u.object.data.ptr[index].name;
-			}
-			if (name_len) {
-				*name_len = self->u.object.data.ptr[index].name_len;
-			}
-			ret = self->u.object.data.ptr[index].value;
-		}
+	self = (yod_jvalue_a *) malloc(sizeof(yod_jvalue_a) + size);
+	if (!self) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return NULL;
 	}
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %d, %s, %d): %p in %s:%d %s",
-		__FUNCTION__, self, index, (name ? *name : NULL), (name_len ? name_len : 0), ret, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
+	self->next = NULL;
+	self->tail = self;
+	self->size = size;
+	self->used = 0;
 
-	return ret;
+	return self;
 }
 /* }}} */
 
 
-/** {{{ size_t _yod_jvalue_object_count(yod_jvalue_t *self __ENV_CPARM)
+/** {{{ static void *_yod_jvalue_arena_alloc(yod_jvalue_a *self, size_t size)
 */
-size_t _yod_jvalue_object_count(yod_jvalue_t *self __ENV_CPARM)
+static void *_yod_jvalue_arena_alloc(yod_jvalue_a *self, size_t size)
 {
-	size_t ret = 0;
+	yod_jvalue_a *chunk = self->tail;
+	void *ret = NULL;
 
-	if (!self) {
-		return (0);
-	}
+	size = YOD_JVALUE_ALIGN(size);
 
-	if (self->type == __JVT_OBJECT) {
-		ret = self->u.object.count;
+	if (chunk->used + size > chunk->size) {
+		chunk = _yod_jvalue_arena_new((chunk->size << 1) > size ? (chunk->size << 1) : size);
+		if (!chunk) {
+			return NULL;
+		}
+		self->tail->next = chunk;
+		self->tail = chunk;
 	}
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p): %d in %s:%d %s",
-		__FUNCTION__, self, ret, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
+	ret = (char *) (chunk + 1) + chunk->used;
+	chunk->used += size;
 
 	return ret;
 }
 /* }}} */
 
 
-/** {{{ yod_jvalue_t *_yod_jvalue_object_init(size_t size, ...)
+/** {{{ static void _yod_jvalue_arena_free(yod_jvalue_a *self)
 */
-yod_jvalue_t *_yod_jvalue_object_init(size_t size, ...)
+static void _yod_jvalue_arena_free(yod_jvalue_a *self)
 {
-	yod_jvalue_t *self = NULL;
-	yod_jvalue_t *value = NULL;
-	char *name = NULL;
-	size_t name_len = 0;
-	size_t index = 0;
-	va_list args;
-	size_t i = 0;
+	yod_jvalue_a *chunk = NULL;
 
-	self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t));
-	if (!self) {
-		YOD_STDLOG_ERROR("malloc failed");
-		return NULL;
+	while (self) {
+		chunk = self->next;
+		free(self);
+		self = chunk;
 	}
+}
+/* }}} */
 
-	self->type = __JVT_OBJECT;
-	self->u.object.count = 0;
-	self->u.object.size = size;
-	self->u.object.data.ptr = (yod_jvalue_v *) calloc((size + 1), sizeof(yod_jvalue_v));
-	if (!self->u.object.data.ptr) {
-		yod_jvalue_free(self);
 
-		YOD_STDLOG_ERROR("calloc failed");
+/** {{{ static yod_jvalue_m *_yod_jvalue_mapped_load(const char *file)
+*/
+static yod_jvalue_m *_yod_jvalue_mapped_load(const char *file)
+{
+	yod_jvalue_m *doc = NULL;
+	char cwd[256], path[256];
+	const char *data = NULL;
+
+	if (!file) {
+		errno = EINVAL;
+		YOD_STDLOG_WARN("invalid argument");
 		return NULL;
 	}
 
-	self->u.object.data.ptr[size].name = NULL;
-	self->u.object.data.ptr[size].name_len = 0;
-	self->u.object.data.ptr[size].value = NULL;
-
-	self->parent = NULL;
-	self->_reserved.u.ptr = NULL;
-	self->_reserved.index = 0;
-
-	va_start(args, size);
-	for (i = 0; i < size; ++ i) {
-		name = va_arg(args, char *);
-		value = va_arg(args, yod_jvalue_t *);
-		if (_yod_jvalue_object_find(self, name, &index, 1) != 0) {
-			name_len = strlen(name);
-			self->u.object.data.ptr[index].name = name;
-			self->u.object.data.ptr[index].name_len = name_len;
-			self->u.object.data.ptr[index].value = value;
-			self->u.object.data.ptr[size].name_len += name_len + 1;
-		}
-		else {
-			if (self->u.object.data.ptr[index].value) {
-				yod_jvalue_free(self->u.object.data.ptr[index].value);
-			}
-			self->u.object.data.ptr[index].value = value;
+	if (*file == '/' || *(file + 1) == ':') {
+		strcpy(path, file);
+	} else {
+		if (getcwd(cwd, sizeof(cwd)) == NULL) {
+			YOD_STDLOG_ERROR("getcwd failed");
+			return NULL;
 		}
-		if (value) {
-			value->parent = self;
+
+		if (snprintf(path, sizeof(path), "%s/%s", cwd, file) == -1) {
+			YOD_STDLOG_ERROR("snprintf failed");
+			return NULL;
 		}
 	}
-	va_end(args);
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%d): %p in %s:%d %s",
-		__FUNCTION__, size, self, __ENV_TRACE3);
-#endif
+	if ((doc = _yod_jvalue_mapped_open(path)) == NULL) {
+		return NULL;
+	}
 
-	return self;
+	/* Skip UTF-8 BOM */
+	data = doc->data;
+	if (doc->size >= 3 && ((byte) data[0]) == 0xEF && ((byte) data[1]) == 0xBB && ((byte) data[2]) == 0xBF) {
+		doc->start = 3;
+	}
+
+	return doc;
 }
 /* }}} */
 
 
-/** {{{ yod_jvalue_t *_yod_jvalue_array_new(size_t size __ENV_CPARM)
+/** {{{ static int _yod_jvalue_mapped_check(int event, const char *name, size_t name_len, yod_jvalue_t *value, void *arg __ENV_CPARM)
 */
-yod_jvalue_t *_yod_jvalue_array_new(size_t size __ENV_CPARM)
+static int _yod_jvalue_mapped_check(int event, const char *name, size_t name_len, yod_jvalue_t *value, void *arg __ENV_CPARM)
 {
-	yod_jvalue_t *self = NULL;
+	return (0);
+}
+/* }}} */
 
-	self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t));
+
+/** {{{ static yod_jvalue_m *_yod_jvalue_mapped_open(const char *path)
+*/
+static yod_jvalue_m *_yod_jvalue_mapped_open(const char *path)
+{
+	yod_jvalue_m *self = NULL;
+#ifdef _WIN32
+	LARGE_INTEGER size;
+#else
+	struct stat st;
+	int fd = -1;
+#endif
+
+	self = (yod_jvalue_m *) malloc(sizeof(yod_jvalue_m));
 	if (!self) {
 		YOD_STDLOG_ERROR("malloc failed");
 		return NULL;
 	}
+	memset(self, 0, sizeof(yod_jvalue_m));
 
-	self->type = __JVT_ARRAY;
-	self->u.array.count = 0;
-	self->u.array.size = size;
-	self->u.array.data = calloc(size, sizeof(yod_jvalue_t *));
-	if (!self->u.array.data) {
-		free(self);
+#ifdef _WIN32
+	self->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	self->map = NULL;
+	if (self->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(self->file, &size)) {
+		YOD_STDLOG_ERROR("open failed");
+		goto e_failed;
+	}
+	self->size = (size_t) size.QuadPart;
+	/* an empty file cannot be mapped, nor is it an error */
+	if (self->size == 0) {
+		goto e_failed;
+	}
+	self->map = CreateFileMapping(self->file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (self->map) {
+		self->data = (char *) MapViewOfFile(self->map, FILE_MAP_READ, 0, 0, 0);
+	}
+#else
+	fd = open(path, O_RDONLY);
+	if (fd == -1 || fstat(fd, &st) != 0) {
+		YOD_STDLOG_ERROR("open failed");
+		goto e_failed;
+	}
+	self->size = (size_t) st.st_size;
+	/* an empty file cannot be mapped, nor is it an error */
+	if (self->size == 0) {
+		goto e_failed;
+	}
+	/* pages are only read in as the decoder reaches them */
+	self->data = (char *) mmap(NULL, self->size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (self->data == MAP_FAILED) {
+		self->data = NULL;
+	}
+	close(fd);
+	fd = -1;
+#endif
 
-		YOD_STDLOG_ERROR("calloc failed");
-		return NULL;
+	if (!self->data) {
+		YOD_STDLOG_ERROR("mmap failed");
+		goto e_failed;
 	}
 
-	self->parent = NULL;
-	self->_reserved.u.ptr = NULL;
-	self->_reserved.index = 0;
+	return self;
+
+e_failed:
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%d): %p in %s:%d %s",
-		__FUNCTION__, size, self, __ENV_TRACE);
-#else
-	__ENV_VOID
+#ifndef _WIN32
+	if (fd != -1) {
+		close(fd);
+	}
 #endif
+	_yod_jvalue_mapped_free(self);
 
-	return self;
+	return NULL;
 }
 /* }}} */
 
 
-/** {{{ int _yod_jvalue_array_add(yod_jvalue_t *self, yod_jvalue_t *value __ENV_CPARM)
+/** {{{ static int _yod_jvalue_mapped_index(yod_jvalue_m *doc)
 */
-int _yod_jvalue_array_add(yod_jvalue_t *self, yod_jvalue_t *value __ENV_CPARM)
+static int _yod_jvalue_mapped_index(yod_jvalue_m *doc)
 {
-	size_t index = 0;
-	int ret = 0;
+	const char *jptr = doc->data + doc->start;
+	const char *jend = doc->data + doc->size;
+	size_t index_size = 0;
+	size_t *stack = NULL;
+	size_t stack_size = 0;
+	size_t depth = 0;
+	size_t i = 0;
+	void *ptr = NULL;
+	int ret = -1;
 
-	if (!self) {
-		return (-1);
+	if (!yod_jvalue_scan_plain__) {
+		_yod_jvalue_scan_init();
 	}
 
-	if (self->type != __JVT_ARRAY) {
-		YOD_STDLOG_WARN("illegal jvalue");
-		return (-1);
-	}
+	/* brackets pair up the same way the decoder reads them, those in
+	 * strings and comments aside; the index ends with the root */
+	for (; jptr < jend; ++ jptr) {
+		switch (*jptr) {
+			case '"':
+				++ jptr;
+				while ((jptr = yod_jvalue_scan_plain__(jptr, jend)) < jend && *jptr != '"') {
+					jptr += (*jptr == '\\' && jend - jptr > 1) ? 2 : 1;
+				}
+				if (jptr >= jend) {
+					goto e_done;
+				}
+				break;
 
-	if (self->u.array.count >= self->u.array.size) {
-		YOD_STDLOG_WARN("index overflow");
-		return (-1);
-	}
+			case '/':
+				if (jend - jptr > 1 && jptr[1] == '/') {
+					if ((jptr = memchr(jptr, '\n', jend - jptr)) == NULL) {
+						goto e_done;
+					}
+				}
+				else if (jend - jptr > 1 && jptr[1] == '*') {
+					for (jptr += 2; jptr < jend - 1 && !(jptr[0] == '*' && jptr[1] == '/'); ++ jptr);
+					if (jptr >= jend - 1) {
+						goto e_done;
+					}
+					++ jptr;
+				}
+				break;
 
-	index = self->u.array.count ++;
-	if (self->u.array.data[index]) {
-		yod_jvalue_free(self->u.array.data[index]);
-	}
-	self->u.array.data[index] = value;
+			case '{':
+			case '[':
+				if ((doc->count + 1) * sizeof(yod_jvalue_i) > index_size) {
+					if ((ptr = _yod_jvalue_decode_grow(doc->index, &index_size, (doc->count + 1) * sizeof(yod_jvalue_i))) == NULL) {
+						goto e_done;
+					}
+					doc->index = (yod_jvalue_i *) ptr;
+				}
+				if ((depth + 1) * sizeof(size_t) > stack_size) {
+					if ((ptr = _yod_jvalue_decode_grow(stack, &stack_size, (depth + 1) * sizeof(size_t))) == NULL) {
+						goto e_done;
+					}
+					stack = (size_t *) ptr;
+				}
+				doc->index[doc->count].open = (size_t) (jptr - doc->data);
+				doc->index[doc->count].close = 0;
+				stack[depth ++] = doc->count ++;
+				break;
 
-	if (value) {
-		value->parent = self;
+			case '}':
+			case ']':
+				if (depth == 0) {
+					goto e_done;
+				}
+				i = stack[-- depth];
+				if (doc->data[doc->index[i].open] != ((*jptr == '}') ? '{' : '[')) {
+					goto e_done;
+				}
+				doc->index[i].close = (size_t) (jptr - doc->data);
+				if (depth == 0) {
+					ret = 0;
+					goto e_done;
+				}
+				break;
+
+			default:
+				break;
+		};
 	}
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %d, %p): %d in %s:%d %s",
-		__FUNCTION__, self, index, value, ret, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
+e_done:
 
-	return ret;
+	if (stack) {
+		free(stack);
+	}
+
+	return (ret);
 }
 /* }}} */
 
 
-/** {{{ int _yod_jvalue_array_set(yod_jvalue_t *self, size_t index, yod_jvalue_t *value __ENV_CPARM)
+/** {{{ static yod_jvalue_i *_yod_jvalue_mapped_find(yod_jvalue_m *doc, size_t pos)
 */
-int _yod_jvalue_array_set(yod_jvalue_t *self, size_t index, yod_jvalue_t *value __ENV_CPARM)
+static yod_jvalue_i *_yod_jvalue_mapped_find(yod_jvalue_m *doc, size_t pos)
 {
-	int ret = 0;
+	size_t a = 0;
+	size_t b = doc->count;
+	size_t i = 0;
 
-	if (!self) {
-		return (-1);
+	while (a < b) {
+		i = a + ((b - a) >> 1);
+		if (doc->index[i].open == pos) {
+			return doc->index + i;
+		}
+		if (doc->index[i].open < pos) {
+			a = i + 1;
+		}
+		else {
+			b = i;
+		}
 	}
 
-	if (self->type != __JVT_ARRAY) {
-		YOD_STDLOG_WARN("illegal jvalue");
-		return (-1);
-	}
+	return NULL;
+}
+/* }}} */
 
-	if (index >= self->u.array.size) {
-		YOD_STDLOG_WARN("index overflow");
-		return (-1);
-	}
 
-	if (index >= self->u.array.count) {
-		self->u.array.count = index + 1;
-	}
+/** {{{ static int _yod_jvalue_mapped_read(yod_jvalue_t *self, char *err)
+*/
+static int _yod_jvalue_mapped_read(yod_jvalue_t *self, char *err)
+{
+	yod_jvalue_t *root = self;
+	yod_jvalue_t *value = NULL;
+	yod_jvalue_i *entry = NULL;
+	yod_jvalue_m *doc = NULL;
+	yod_jvalue_d ctx;
+	size_t start = 0;
+	size_t len = 0;
+	size_t i = 0;
 
-	if (self->u.array.data[index]) {
-		yod_jvalue_free(self->u.array.data[index]);
+	/* the document hangs off the root, the root level runs to the end
+	 * of the file so trailing input is treated as the decoder does */
+	while (!(root->flags & __JVN_MAPPED)) {
+		root = root->parent;
 	}
-	self->u.array.data[index] = value;
+	doc = (yod_jvalue_m *) root->_reserved.u.ptr;
 
-	if (value) {
-		value->parent = self;
+	if (self == root) {
+		start = doc->start;
+		len = doc->size - doc->start;
+	}
+	else {
+		entry = (yod_jvalue_i *) self->_reserved.u.ptr;
+		start = entry->open;
+		len = entry->close - entry->open + 1;
 	}
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %d, %p): %d in %s:%d %s",
-		__FUNCTION__, self, index, value, ret, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
+	self->flags &= ~ __JVN_LAZY;
 
-	return ret;
-}
-/* }}} */
+	_yod_jvalue_decode_init(&ctx, 0);
+	ctx.doc = doc;
+	ctx.doc_off = start;
 
+	if (_yod_jvalue_decode_run(&ctx, doc->data + start, len, 1, err) > 0) {
+		value = _yod_jvalue_decode_root(&ctx);
+	}
 
-/** {{{ yod_jvalue_t *_yod_jvalue_array_get(yod_jvalue_t *self, size_t index __ENV_CPARM)
-*/
-yod_jvalue_t *_yod_jvalue_array_get(yod_jvalue_t *self, size_t index __ENV_CPARM)
-{
-	yod_jvalue_t *ret = NULL;
+	_yod_jvalue_decode_free(&ctx);
 
-	if (!self) {
-		return NULL;
+	if (!value || value->type != self->type) {
+		YOD_STDLOG_WARN("mapped jvalue unreadable");
+		yod_jvalue_free(value);
+		return (-1);
 	}
 
-	if (self->type == __JVT_ARRAY) {
-		if (index < self->u.array.count) {
-			ret = self->u.array.data[index];
+	/* the members move over, nested containers stay lazy */
+	self->u = value->u;
+	self->flags |= value->flags & (__JVN_INDEX | __JVN_INSERT);
+
+	if (self->type == __JVT_OBJECT) {
+		for (i = 0; i < self->u.object.count; ++ i) {
+			if (self->u.object.data.ptr[i].value) {
+				self->u.object.data.ptr[i].value->parent = self;
+			}
+		}
+	}
+	else {
+		for (i = 0; i < self->u.array.count; ++ i) {
+			if (self->u.array.data[i]) {
+				self->u.array.data[i]->parent = self;
+			}
 		}
 	}
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %d): %p in %s:%d %s",
-		__FUNCTION__, self, index, ret, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
+	free(value);
 
-	return ret;
+	return (0);
 }
 /* }}} */
 
 
-/** {{{ size_t _yod_jvalue_array_count(yod_jvalue_t *self __ENV_CPARM)
+/** {{{ static void _yod_jvalue_mapped_free(yod_jvalue_m *doc)
 */
-size_t _yod_jvalue_array_count(yod_jvalue_t *self __ENV_CPARM)
+static void _yod_jvalue_mapped_free(yod_jvalue_m *doc)
 {
-	size_t ret = 0;
-
-	if (!self) {
-		return (0);
+	if (!doc) {
+		return;
 	}
 
-	if (self->type == __JVT_ARRAY) {
-		ret = self->u.array.count;
+#ifdef _WIN32
+	if (doc->data) {
+		UnmapViewOfFile(doc->data);
+	}
+	if (doc->map) {
+		CloseHandle(doc->map);
+	}
+	if (doc->file != INVALID_HANDLE_VALUE) {
+		CloseHandle(doc->file);
 	}
-
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p): %d in %s:%d %s",
-		__FUNCTION__, self, ret, __ENV_TRACE);
 #else
-	__ENV_VOID
+	if (doc->data) {
+		munmap(doc->data, doc->size);
+	}
 #endif
 
-	return ret;
+	if (doc->index) {
+		free(doc->index);
+	}
+
+	free(doc);
 }
 /* }}} */
 
 
-/** {{{ yod_jvalue_t *_yod_jvalue_array_init(size_t size, ...)
+/** {{{ static void _yod_jvalue_encode_init(yod_jvalue_w *enc, int mode)
 */
-yod_jvalue_t *_yod_jvalue_array_init(size_t size, ...)
+static void _yod_jvalue_encode_init(yod_jvalue_w *enc, int mode)
 {
-	yod_jvalue_t *self = NULL;
-	yod_jvalue_t *value = NULL;
-	size_t index = 0;
-	va_list args;
-
-	self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t));
-	if (!self) {
-		YOD_STDLOG_ERROR("malloc failed");
-		return NULL;
-	}
-
-	self->type = __JVT_ARRAY;
-	self->u.array.count = size;
-	self->u.array.size = size;
-	self->u.array.data = calloc(size, sizeof(yod_jvalue_t *));
-	if (!self->u.array.data) {
-		free(self);
-
-		YOD_STDLOG_ERROR("calloc failed");
-		return NULL;
-	}
-
-	self->parent = NULL;
-	self->_reserved.u.ptr = NULL;
-	self->_reserved.index = 0;
-
-	va_start(args, size);
-	for (index = 0; index < size; ++ index) {
-		value = va_arg(args, yod_jvalue_t *);
-		self->u.array.data[index] = value;
-		if (value) {
-			value->parent = self;
-		}
-	}
-	va_end(args);
-
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%d): %p in %s:%d %s",
-		__FUNCTION__, size, self, __ENV_TRACE3);
-#endif
+	memset(enc, 0, sizeof(yod_jvalue_w));
 
-	return self;
+	enc->mode = mode;
+	enc->stack = enc->frames;
+	enc->stack_size = sizeof(enc->frames);
 }
 /* }}} */
 
 
-/** {{{ yod_jvalue_t *_yod_jvalue_string_new(char *str, size_t len __ENV_CPARM)
+/** {{{ static int _yod_jvalue_encode_run(yod_jvalue_w *enc, yod_jvalue_t *self)
 */
-yod_jvalue_t *_yod_jvalue_string_new(char *str, size_t len __ENV_CPARM)
+static int _yod_jvalue_encode_run(yod_jvalue_w *enc, yod_jvalue_t *self)
 {
-	yod_jvalue_t *self = NULL;
+	yod_jvalue_t *value = self;
+	yod_jvalue_s *frame = NULL;
+	yod_jvalue_v *vitem = NULL;
+	uint64_t num = 0;
+	char tmp[32], *ptr, *dot;
+	int len = 0;
+
+	while (!enc->failed) {
+		if (!value) {
+			_yod_jvalue_encode_put(enc, "null", 4);
+		}
+		else {
+			if (value->flags & __JVN_LAZY) {
+				_yod_jvalue_mapped_read(value, NULL);
+			}
+			switch (value->type) {
+				case __JVT_OBJECT:
+					_yod_jvalue_encode_put(enc, "{", 1);
+					if (value->u.object.count == 0) {
+						_yod_jvalue_encode_put(enc, "}", 1);
+						break;
+					}
+					_yod_jvalue_encode_push(enc, value);
+					break;
 
-	self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t));
-	if (!self) {
-		YOD_STDLOG_ERROR("malloc failed");
-		return NULL;
-	}
+				case __JVT_ARRAY:
+					_yod_jvalue_encode_put(enc, "[", 1);
+					if (value->u.array.count == 0) {
+						_yod_jvalue_encode_put(enc, "]", 1);
+						break;
+					}
+					_yod_jvalue_encode_push(enc, value);
+					break;
 
-	if (len == (size_t) -1) {
-		len = str ? strlen(str) : 0;
-	}
+				case __JVT_STRING:
+					_yod_jvalue_encode_text(enc, value->u.string.ptr, value->u.string.len);
+					break;
 
-	self->type = __JVT_STRING;
-	self->u.string.ptr = (char *) malloc((len + 1)* sizeof(char));
-	if (!self->u.string.ptr) {
-		free(self);
+				case __JVT_INTEGER:
+					num = (value->u.ival < 0) ? (0 - (uint64_t) value->u.ival) : (uint64_t) value->u.ival;
+					ptr = tmp + sizeof(tmp);
+					do {
+						*-- ptr = "0123456789"[num % 10];
+					} while ((num /= 10) > 0);
+					if (value->u.ival < 0) {
+						*-- ptr = '-';
+					}
+					_yod_jvalue_encode_put(enc, ptr, tmp + sizeof(tmp) - ptr);
+					break;
 
-		YOD_STDLOG_ERROR("malloc failed");
-		return NULL;
-	}
-	memcpy(self->u.string.ptr, str, len);
-	self->u.string.ptr[len] = '\0';
-	self->u.string.len = len;
+				case __JVT_DOUBLE:
+#ifdef _WIN32
+					len = sprintf_s(tmp, sizeof(tmp) - 2, "%lg", value->u.dval);
+#else
+					len = snprintf(tmp, sizeof(tmp) - 2, "%lg", value->u.dval);
+#endif
+					if ((dot = strchr(tmp, ',')) != NULL) {
+						*dot = '.';
+					}
+					else if (!strchr(tmp, '.')) {
+						tmp[len ++] = '.';
+						tmp[len ++] = '0';
+					}
+					_yod_jvalue_encode_put(enc, tmp, len);
+					break;
+
+				case __JVT_BOOLEAN:
+					if (value->u.bval) {
+						_yod_jvalue_encode_put(enc, "true", 4);
+					}
+					else {
+						_yod_jvalue_encode_put(enc, "false", 5);
+					}
+					break;
 
-	self->parent = NULL;
-	self->_reserved.u.ptr = NULL;
-	self->_reserved.index = 0;
+				case __JVT_NULL:
+					_yod_jvalue_encode_put(enc, "null", 4);
+					break;
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %d): %p in %s:%d %s",
-		__FUNCTION__, str, len, self, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
+				default:
+					break;
+			};
+		}
 
-	return self;
+		/* next member of the innermost open container */
+		value = NULL;
+		while (enc->count > 0) {
+			frame = enc->stack + enc->count - 1;
+			if (frame->value->type == __JVT_OBJECT) {
+				if (frame->index == frame->value->u.object.count) {
+					_yod_jvalue_encode_put(enc, "}", 1);
+					-- enc->count;
+					continue;
+				}
+				if (frame->index > 0) {
+					_yod_jvalue_encode_put(enc, ",", 1);
+				}
+				vitem = frame->value->u.object.data.ptr + _yod_jvalue_object_at(frame->value, frame->index ++);
+				_yod_jvalue_encode_text(enc, vitem->name, vitem->name_len);
+				_yod_jvalue_encode_put(enc, ":", 1);
+				value = vitem->value;
+			}
+			else {
+				if (frame->index == frame->value->u.array.count) {
+					_yod_jvalue_encode_put(enc, "]", 1);
+					-- enc->count;
+					continue;
+				}
+				if (frame->index > 0) {
+					_yod_jvalue_encode_put(enc, ",", 1);
+				}
+				value = frame->value->u.array.data[frame->index ++];
+			}
+			break;
+		}
+
+		if (enc->count == 0) {
+			break;
+		}
+	}
+
+	return enc->failed ? (-1) : (0);
 }
 /* }}} */
 
 
-/** {{{ int _yod_jvalue_string_set(yod_jvalue_t *self, char *str, size_t len __ENV_CPARM)
+/** {{{ static void _yod_jvalue_encode_free(yod_jvalue_w *enc)
 */
-int _yod_jvalue_string_set(yod_jvalue_t *self, char *str, size_t len __ENV_CPARM)
+static void _yod_jvalue_encode_free(yod_jvalue_w *enc)
 {
-	if (!self) {
-		return (-1);
-	}
-
-	if (self->type != __JVT_STRING) {
-		YOD_STDLOG_WARN("illegal jvalue");
-		return (-1);
-	}
-	if (self->u.string.ptr) {
-		free(self->u.string.ptr);
+	if (enc->stack != enc->frames) {
+		free(enc->stack);
 	}
+	enc->stack = enc->frames;
 
-	self->u.string.ptr = (char *) malloc((len + 1) * sizeof(char));
-	if (!self->u.string.ptr) {
-		YOD_STDLOG_ERROR("malloc failed");
-		return (-1);
+	if (enc->data && (enc->mode == __JVW_GROW || enc->mode == __JVW_SINK)) {
+		free(enc->data);
 	}
-	memcpy(self->u.string.ptr, str, len);
-	self->u.string.ptr[len] = '\0';
-	self->u.string.len = len;
-
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %p, %d) in %s:%d %s",
-		__FUNCTION__, self, str, len, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
-
-	return (0);
+	enc->data = NULL;
 }
 /* }}} */
 
 
-/** {{{ char *_yod_jvalue_string_get(yod_jvalue_t *self, size_t *len __ENV_CPARM)
+/** {{{ static int _yod_jvalue_encode_push(yod_jvalue_w *enc, yod_jvalue_t *value)
 */
-char *_yod_jvalue_string_get(yod_jvalue_t *self, size_t *len __ENV_CPARM)
+static int _yod_jvalue_encode_push(yod_jvalue_w *enc, yod_jvalue_t *value)
 {
-	char *ret = NULL;
-
-	if (!self) {
-		return NULL;
-	}
+	yod_jvalue_s *stack = NULL;
+	size_t need = (enc->count + 1) * sizeof(yod_jvalue_s);
 
-	if (self->type == __JVT_STRING) {
-		ret = self->u.string.ptr;
-		if (len) {
-			*len = self->u.string.len;
+	if (need > enc->stack_size) {
+		if (enc->stack == enc->frames) {
+			if ((stack = (yod_jvalue_s *) malloc(enc->stack_size << 1)) == NULL) {
+				YOD_STDLOG_ERROR("malloc failed");
+			}
+			else {
+				memcpy(stack, enc->frames, enc->stack_size);
+				enc->stack_size <<= 1;
+			}
+		}
+		else {
+			stack = _yod_jvalue_decode_grow(enc->stack, &enc->stack_size, need);
+		}
+		if (!stack) {
+			enc->failed = 1;
+			return (-1);
 		}
+		enc->stack = stack;
 	}
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %d): %p in %s:%d %s",
-		__FUNCTION__, self, (len ? *len : 0), ret, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
+	enc->stack[enc->count].value = value;
+	enc->stack[enc->count].index = 0;
+	++ enc->count;
 
-	return ret;
+	return (0);
 }
 /* }}} */
 
 
-/** {{{ yod_jvalue_t *_yod_jvalue_integer_new(int64_t num __ENV_CPARM)
+/** {{{ static void _yod_jvalue_encode_put(yod_jvalue_w *enc, const char *str, size_t len)
 */
-yod_jvalue_t *_yod_jvalue_integer_new(int64_t num __ENV_CPARM)
+static void _yod_jvalue_encode_put(yod_jvalue_w *enc, const char *str, size_t len)
 {
-	yod_jvalue_t *self = NULL;
+	char *ptr = NULL;
 
-	self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t));
-	if (!self) {
-		YOD_STDLOG_ERROR("malloc failed");
-		return NULL;
+	if (enc->mode == __JVW_COUNT) {
+		enc->len += len;
+		return;
 	}
 
-	self->type = __JVT_INTEGER;
-	self->u.ival = num;
-
-	self->parent = NULL;
-	self->_reserved.u.ptr = NULL;
-	self->_reserved.index = 0;
-
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%ld): %p in %s:%d %s",
-		__FUNCTION__, (ulong) num, self, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
-
-	return self;
+	if ((ptr = _yod_jvalue_encode_reserve(enc, len)) != NULL) {
+		memcpy(ptr, str, len);
+		enc->len += len;
+	}
 }
 /* }}} */
 
 
-/** {{{ int _yod_jvalue_integer_set(yod_jvalue_t *self, int64_t num __ENV_CPARM)
+/** {{{ static void _yod_jvalue_encode_text(yod_jvalue_w *enc, char *str, size_t len)
 */
-int _yod_jvalue_integer_set(yod_jvalue_t *self, int64_t num __ENV_CPARM)
+static void _yod_jvalue_encode_text(yod_jvalue_w *enc, char *str, size_t len)
 {
-	if (!self) {
-		return (-1);
-	}
+	size_t need = len * 6 + 2;
+	char *ptr = NULL;
 
-	if (self->type != __JVT_INTEGER) {
-		YOD_STDLOG_WARN("illegal jvalue");
-		return (-1);
+	if (enc->mode == __JVW_COUNT) {
+		enc->len += _yod_jvalue_encode_strlen(str, len) + 2;
+		return;
 	}
-	self->u.ival = num;
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %ld) in %s:%d %s",
-		__FUNCTION__, self, (ulong) num, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
+	/* worst case escaping when it fits, the exact size otherwise */
+	if (enc->mode != __JVW_BUFFER && enc->len + need > enc->size) {
+		need = _yod_jvalue_encode_strlen(str, len) + 2;
+	}
 
-	return (0);
+	if ((ptr = _yod_jvalue_encode_reserve(enc, need)) != NULL) {
+		need = 0;
+		ptr[need ++] = '\"';
+		need += _yod_jvalue_encode_string(str, len, ptr + need);
+		ptr[need ++] = '\"';
+		enc->len += need;
+	}
 }
 /* }}} */
 
 
-/** {{{ int64_t _yod_jvalue_integer_get(yod_jvalue_t *self __ENV_CPARM)
+/** {{{ static char *_yod_jvalue_encode_reserve(yod_jvalue_w *enc, size_t need)
 */
-int64_t _yod_jvalue_integer_get(yod_jvalue_t *self __ENV_CPARM)
+static char *_yod_jvalue_encode_reserve(yod_jvalue_w *enc, size_t need)
 {
-	int64_t ret = 0;
+	char *data = NULL;
 
-	if (!self) {
-		return (0);
+	if (enc->failed) {
+		return NULL;
 	}
 
-	if (self->type == __JVT_INTEGER) {
-		ret = self->u.ival;
+	/* the caller's buffer is trusted to be large enough */
+	if (enc->mode == __JVW_BUFFER || enc->len + need <= enc->size) {
+		return enc->data + enc->len;
 	}
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p): %ld in %s:%d %s",
-		__FUNCTION__, self, (ulong) ret, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
+	if (enc->mode == __JVW_SINK) {
+		if (_yod_jvalue_encode_flush(enc) != 0) {
+			return NULL;
+		}
+		if (need <= enc->size) {
+			return enc->data;
+		}
+	}
 
-	return ret;
+	if ((data = _yod_jvalue_decode_grow(enc->data, &enc->size, enc->len + need)) == NULL) {
+		enc->failed = 1;
+		return NULL;
+	}
+	enc->data = data;
+
+	return enc->data + enc->len;
 }
 /* }}} */
 
 
-/** {{{ yod_jvalue_t *_yod_jvalue_double_new(double dval __ENV_CPARM)
+/** {{{ static int _yod_jvalue_encode_flush(yod_jvalue_w *enc)
 */
-yod_jvalue_t *_yod_jvalue_double_new(double dval __ENV_CPARM)
+static int _yod_jvalue_encode_flush(yod_jvalue_w *enc)
 {
-	yod_jvalue_t *self = NULL;
-
-	self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t));
-	if (!self) {
-		YOD_STDLOG_ERROR("malloc failed");
-		return NULL;
+	if (enc->len > 0) {
+		if (enc->func(enc->data, enc->len, enc->arg __ENV_CARGS) != 0) {
+			enc->failed = 1;
+			return (-1);
+		}
+		enc->len = 0;
 	}
 
-	self->type = __JVT_DOUBLE;
-	self->u.dval = dval;
-
-	self->parent = NULL;
-	self->_reserved.u.ptr = NULL;
-	self->_reserved.index = 0;
-
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%lf): %p in %s:%d %s",
-		__FUNCTION__, dval, self, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
-
-	return self;
+	return (0);
 }
 /* }}} */
 
 
-/** {{{ int _yod_jvalue_double_set(yod_jvalue_t *self, double dval __ENV_CPARM)
+/** {{{ static int _yod_jvalue_encode_sink(yod_jvalue_t *self, yod_jvalue_sink_fn func, void *arg, int (*run) (yod_jvalue_w *, yod_jvalue_t *))
 */
-int _yod_jvalue_double_set(yod_jvalue_t *self, double dval __ENV_CPARM)
+static int _yod_jvalue_encode_sink(yod_jvalue_t *self, yod_jvalue_sink_fn func, void *arg, int (*run) (yod_jvalue_w *, yod_jvalue_t *))
 {
-	if (!self) {
+	yod_jvalue_w enc;
+	int ret = -1;
+
+	_yod_jvalue_encode_init(&enc, __JVW_SINK);
+	enc.func = func;
+	enc.arg = arg;
+
+	if ((enc.data = (char *) malloc(YOD_JVALUE_ENCODE_SIZE * sizeof(char))) == NULL) {
+		YOD_STDLOG_ERROR("malloc failed");
 		return (-1);
 	}
+	enc.size = YOD_JVALUE_ENCODE_SIZE;
 
-	if (self->type != __JVT_DOUBLE) {
-		YOD_STDLOG_WARN("illegal jvalue");
-		return (-1);
+	if (run(&enc, self) == 0) {
+		ret = _yod_jvalue_encode_flush(&enc);
 	}
-	self->u.dval = dval;
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %lf) in %s:%d %s",
-		__FUNCTION__, self, dval, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
+	_yod_jvalue_encode_free(&enc);
 
-	return (0);
+	return (ret);
 }
 /* }}} */
 
 
-/** {{{ double _yod_jvalue_double_get(yod_jvalue_t *self __ENV_CPARM)
+/** {{{ static int _yod_jvalue_pack_run(yod_jvalue_w *enc, yod_jvalue_t *self)
 */
-double _yod_jvalue_double_get(yod_jvalue_t *self __ENV_CPARM)
+static int _yod_jvalue_pack_run(yod_jvalue_w *enc, yod_jvalue_t *self)
 {
-	double ret = 0;
+	yod_jvalue_t *value = self;
+	yod_jvalue_s *frame = NULL;
+	yod_jvalue_v *vitem = NULL;
+	uint64_t num = 0;
+	byte tmp[9];
+	int len = 0;
+
+	while (!enc->failed) {
+		if (!value) {
+			_yod_jvalue_encode_put(enc, "\xc0", 1);
+		}
+		else {
+			if (value->flags & __JVN_LAZY) {
+				_yod_jvalue_mapped_read(value, NULL);
+			}
+			switch (value->type) {
+				case __JVT_OBJECT:
+					_yod_jvalue_pack_head(enc, __JVT_OBJECT, value->u.object.count);
+					if (value->u.object.count > 0) {
+						_yod_jvalue_encode_push(enc, value);
+					}
+					break;
 
-	if (!self) {
-		return (0);
-	}
+				case __JVT_ARRAY:
+					_yod_jvalue_pack_head(enc, __JVT_ARRAY, value->u.array.count);
+					if (value->u.array.count > 0) {
+						_yod_jvalue_encode_push(enc, value);
+					}
+					break;
+
+				case __JVT_STRING:
+					_yod_jvalue_pack_head(enc, __JVT_STRING, value->u.string.len);
+					_yod_jvalue_encode_put(enc, value->u.string.ptr, value->u.string.len);
+					break;
+
+				case __JVT_INTEGER:
+					/* the shortest of fixint, uint 8-64 and int 8-64 */
+					num = (uint64_t) value->u.ival;
+					if (value->u.ival >= 0) {
+						if (value->u.ival < 0x80) {
+							tmp[0] = (byte) num;
+							len = 0;
+						}
+						else if (value->u.ival <= 0xFF) {
+							tmp[0] = 0xcc;
+							len = 1;
+						}
+						else if (value->u.ival <= 0xFFFF) {
+							tmp[0] = 0xcd;
+							len = 2;
+						}
+						else if (value->u.ival <= 0xFFFFFFFFLL) {
+							tmp[0] = 0xce;
+							len = 4;
+						}
+						else {
+							tmp[0] = 0xcf;
+							len = 8;
+						}
+					}
+					else {
+						if (value->u.ival >= -32) {
+							tmp[0] = (byte) num;
+							len = 0;
+						}
+						else if (value->u.ival >= -0x80) {
+							tmp[0] = 0xd0;
+							len = 1;
+						}
+						else if (value->u.ival >= -0x8000) {
+							tmp[0] = 0xd1;
+							len = 2;
+						}
+						else if (value->u.ival >= -0x80000000LL) {
+							tmp[0] = 0xd2;
+							len = 4;
+						}
+						else {
+							tmp[0] = 0xd3;
+							len = 8;
+						}
+					}
+					_yod_jvalue_pack_set(tmp + 1, num, len);
+					_yod_jvalue_encode_put(enc, (char *) tmp, len + 1);
+					break;
+
+				case __JVT_DOUBLE:
+					memcpy(&num, &value->u.dval, 8);
+					tmp[0] = 0xcb;
+					_yod_jvalue_pack_set(tmp + 1, num, 8);
+					_yod_jvalue_encode_put(enc, (char *) tmp, 9);
+					break;
+
+				case __JVT_BOOLEAN:
+					_yod_jvalue_encode_put(enc, value->u.bval ? "\xc3" : "\xc2", 1);
+					break;
+
+				case __JVT_NULL:
+					_yod_jvalue_encode_put(enc, "\xc0", 1);
+					break;
+
+				default:
+					break;
+			};
+		}
+
+		/* next member of the innermost open container */
+		value = NULL;
+		while (enc->count > 0) {
+			frame = enc->stack + enc->count - 1;
+			if (frame->value->type == __JVT_OBJECT) {
+				if (frame->index == frame->value->u.object.count) {
+					-- enc->count;
+					continue;
+				}
+				vitem = frame->value->u.object.data.ptr + _yod_jvalue_object_at(frame->value, frame->index ++);
+				_yod_jvalue_pack_head(enc, __JVT_STRING, vitem->name_len);
+				_yod_jvalue_encode_put(enc, vitem->name, vitem->name_len);
+				value = vitem->value;
+			}
+			else {
+				if (frame->index == frame->value->u.array.count) {
+					-- enc->count;
+					continue;
+				}
+				value = frame->value->u.array.data[frame->index ++];
+			}
+			break;
+		}
 
-	if (self->type == __JVT_DOUBLE) {
-		ret = self->u.dval;
+		if (enc->count == 0) {
+			break;
+		}
 	}
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p): %lf in %s:%d %s",
-		__FUNCTION__, self, ret, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
-
-	return ret;
+	return enc->failed ? (-1) : (0);
 }
 /* }}} */
 
 
-/** {{{ yod_jvalue_t *_yod_jvalue_boolean_new(int bval __ENV_CPARM)
+/** {{{ static void _yod_jvalue_pack_head(yod_jvalue_w *enc, int type, size_t len)
 */
-yod_jvalue_t *_yod_jvalue_boolean_new(int bval __ENV_CPARM)
+static void _yod_jvalue_pack_head(yod_jvalue_w *enc, int type, size_t len)
 {
-	yod_jvalue_t *self = NULL;
+	byte tmp[5];
+	int size = 0;
 
-	self = (yod_jvalue_t *) malloc(sizeof(yod_jvalue_t));
-	if (!self) {
-		YOD_STDLOG_ERROR("malloc failed");
-		return NULL;
-	}
-
-	self->type = __JVT_BOOLEAN;
-	self->u.bval = bval;
+	switch (type) {
+		case __JVT_OBJECT:
+			tmp[0] = (len < 16) ? (0x80 | len) : (len <= 0xFFFF) ? 0xde : 0xdf;
+			size = (len < 16) ? 0 : (len <= 0xFFFF) ? 2 : 4;
+			break;
 
-	self->parent = NULL;
-	self->_reserved.u.ptr = NULL;
-	self->_reserved.index = 0;
+		case __JVT_ARRAY:
+			tmp[0] = (len < 16) ? (0x90 | len) : (len <= 0xFFFF) ? 0xdc : 0xdd;
+			size = (len < 16) ? 0 : (len <= 0xFFFF) ? 2 : 4;
+			break;
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%d): %p in %s:%d %s",
-		__FUNCTION__, bval, self, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
+		default:
+			if ((uint64_t) len > 0xFFFFFFFFULL) {
+				YOD_STDLOG_WARN("string too long");
+				enc->failed = 1;
+				return;
+			}
+			tmp[0] = (len < 32) ? (0xa0 | len) : (len <= 0xFF) ? 0xd9 : (len <= 0xFFFF) ? 0xda : 0xdb;
+			size = (len < 32) ? 0 : (len <= 0xFF) ? 1 : (len <= 0xFFFF) ? 2 : 4;
+			break;
+	};
 
-	return self;
+	_yod_jvalue_pack_set(tmp + 1, (uint64_t) len, size);
+	_yod_jvalue_encode_put(enc, (char *) tmp, size + 1);
 }
 /* }}} */
 
 
-/** {{{ int _yod_jvalue_boolean_set(yod_jvalue_t *self, int bval __ENV_CPARM)
+/** {{{ static void _yod_jvalue_pack_set(byte *data, uint64_t num, int size)
 */
-int _yod_jvalue_boolean_set(yod_jvalue_t *self, int bval __ENV_CPARM)
+static void _yod_jvalue_pack_set(byte *data, uint64_t num, int size)
 {
-	if (!self) {
-		return (-1);
-	}
-
-	if (self->type != __JVT_BOOLEAN) {
-		YOD_STDLOG_WARN("illegal jvalue");
-		return (-1);
+	/* big-endian, unlike yod_common_set_uint* */
+	while (size > 0) {
+		data[-- size] = (byte) (num & 0xFF);
+		num >>= 8;
 	}
-	self->u.bval = bval;
-
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %d) in %s:%d %s",
-		__FUNCTION__, self, bval, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
-
-	return (0);
 }
 /* }}} */
 
 
-/** {{{ size_t _yod_jvalue_boolean_get(yod_jvalue_t *self __ENV_CPARM)
+/** {{{ static uint64_t _yod_jvalue_pack_get(const byte *data, int size)
 */
-int _yod_jvalue_boolean_get(yod_jvalue_t *self __ENV_CPARM)
+static uint64_t _yod_jvalue_pack_get(const byte *data, int size)
 {
-	int ret = 0;
-
-	if (!self) {
-		return (0);
-	}
+	uint64_t ret = 0;
+	int i = 0;
 
-	if (self->type == __JVT_BOOLEAN) {
-		ret = self->u.bval;
+	for (i = 0; i < size; ++ i) {
+		ret = (ret << 8) | data[i];
 	}
 
-#if (_YOD_SYSTEM_DEBUG && _YOD_JVALUE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p): %d in %s:%d %s",
-		__FUNCTION__, self, ret, __ENV_TRACE);
-#else
-	__ENV_VOID
-#endif
-
 	return ret;
 }
 /* }}} */
 
 
-/** {{{ static int _yod_jvalue_decode_new(int first_pass, yod_jvalue_t **top, yod_jvalue_t** root, yod_jvalue_t **alloc, int type)
+/** {{{ static int _yod_jvalue_unpack_run(yod_jvalue_d *ctx, char *data, size_t len, char *err)
 */
-static int _yod_jvalue_decode_new(int first_pass, yod_jvalue_t **top, yod_jvalue_t** root, yod_jvalue_t **alloc, int type)
+static int _yod_jvalue_unpack_run(yod_jvalue_d *ctx, char *data, size_t len, char *err)
 {
+	byte *head = (byte *) data;
+	byte *jptr = (byte *) data;
+	byte *jend = (byte *) data + len;
+	yod_jvalue_t *parent = NULL;
 	yod_jvalue_t *value = NULL;
-	size_t data_len = 0;
-	size_t name_len = 0;
+	uint64_t num = 0;
+	size_t left = 0;
+	double dval = 0;
+	float fval = 0;
+	uint32_t u32 = 0;
+	int type = 0;
+	int size = 0;
+	int done = 0;
+	byte b = 0;
+
+	while (jptr < jend) {
+		head = jptr;
+		b = *jptr ++;
+		size = 0;
+
+		/* the type, then the width of its length or number */
+		if (b <= 0x7f) {
+			type = __JVT_INTEGER;
+			num = b;
+		}
+		else if (b <= 0x8f) {
+			type = __JVT_OBJECT;
+			num = b & 0x0f;
+		}
+		else if (b <= 0x9f) {
+			type = __JVT_ARRAY;
+			num = b & 0x0f;
+		}
+		else if (b <= 0xbf) {
+			type = __JVT_STRING;
+			num = b & 0x1f;
+		}
+		else if (b >= 0xe0) {
+			type = __JVT_INTEGER;
+			num = (uint64_t) (int64_t) (int8_t) b;
+		}
+		else {
+			switch (b) {
+				case 0xc0:
+					type = __JVT_NULL;
+					break;
 
-	if (!first_pass) {
-		value = *top = *alloc;
-		*alloc = (*alloc)->_reserved.u.ptr;
+				case 0xc2:
+				case 0xc3:
+					type = __JVT_BOOLEAN;
+					break;
 
-		if (!*root) {
-			*root = value;
-		}
+				/* bin is read as a string */
+				case 0xc4:
+				case 0xd9:
+					type = __JVT_STRING;
+					size = 1;
+					break;
 
-		switch (value->type) {
-			case __JVT_OBJECT:
+				case 0xc5:
+				case 0xda:
+					type = __JVT_STRING;
+					size = 2;
+					break;
 
-				if (value->u.object.size == 0) {
+				case 0xc6:
+				case 0xdb:
+					type = __JVT_STRING;
+					size = 4;
 					break;
-				}
 
-				data_len = (value->u.object.size + 1) * sizeof(yod_jvalue_v);
-				name_len = value->u.object.data.num;
-				value->u.object.data.ptr = (yod_jvalue_v *) malloc(data_len + name_len);
-				if (!value->u.object.data.ptr) {
-					YOD_STDLOG_ERROR("malloc failed");
-					return (0);
-				}
+				case 0xca:
+					type = __JVT_DOUBLE;
+					size = 4;
+					break;
 
-				value->_reserved.u.str = (char *) value->u.object.data.ptr + data_len;
-				value->_reserved.index = 0;
-				value->u.object.count = 0;
+				case 0xcb:
+					type = __JVT_DOUBLE;
+					size = 8;
+					break;
 
-				value->u.object.data.ptr[value->u.object.size].name = value->_reserved.u.str;
-				value->u.object.data.ptr[value->u.object.size].name_len = name_len;
-				value->u.object.data.ptr[value->u.object.size].value = NULL;
-				break;
+				case 0xcc:
+				case 0xcd:
+				case 0xce:
+				case 0xcf:
+					type = __JVT_INTEGER;
+					size = 1 << (b - 0xcc);
+					break;
 
-			case __JVT_ARRAY:
+				case 0xd0:
+				case 0xd1:
+				case 0xd2:
+				case 0xd3:
+					type = __JVT_INTEGER;
+					size = 1 << (b - 0xd0);
+					break;
 
-				if (value->u.array.size == 0) {
+				case 0xdc:
+				case 0xdd:
+					type = __JVT_ARRAY;
+					size = (b == 0xdc) ? 2 : 4;
 					break;
-				}
 
-				value->u.array.data = (yod_jvalue_t **) malloc(value->u.array.size * sizeof(yod_jvalue_t *));
-				if (!value->u.array.data) {
-					YOD_STDLOG_ERROR("malloc failed");
-					return (0);
+				case 0xde:
+				case 0xdf:
+					type = __JVT_OBJECT;
+					size = (b == 0xde) ? 2 : 4;
+					break;
+
+				default:
+					if (err) {
+						snprintf(err, 255, "Unsupported type 0x%02x (at %d) in %s:%d %s",
+							b, (int) (head - (byte *) data), __ENV_TRACE3);
+					}
+					return (-1);
+			};
+
+			if (jend - jptr < size) {
+				goto e_eof;
+			}
+			num = _yod_jvalue_pack_get(jptr, size);
+			jptr += size;
+
+			/* int 8-32 are sign extended, uint 64 past int64 turns double */
+			if (b >= 0xd0 && b <= 0xd2 && (num >> (size * 8 - 1))) {
+				num |= ~ ((((uint64_t) 1) << (size * 8)) - 1);
+			}
+			else if (b == 0xcf && (num >> 63)) {
+				type = __JVT_DOUBLE;
+				dval = (double) num;
+			}
+			else if (b == 0xca) {
+				u32 = (uint32_t) num;
+				memcpy(&fval, &u32, 4);
+				dval = (double) fval;
+			}
+			else if (b == 0xcb) {
+				memcpy(&dval, &num, 8);
+			}
+		}
+
+		if (type == __JVT_STRING && (uint64_t) (jend - jptr) < num) {
+			goto e_eof;
+		}
+
+		/* a key, the values of an object come in odd places */
+		if (ctx->top && ctx->top->type == __JVT_OBJECT && !(ctx->top->u.object.size & 1)) {
+			if (type != __JVT_STRING) {
+				if (err) {
+					snprintf(err, 255, "Key is not a string (at %d) in %s:%d %s",
+						(int) (head - (byte *) data), __ENV_TRACE3);
 				}
+				return (-1);
+			}
+			if (!_yod_jvalue_decode_push(ctx, NULL, (char *) jptr, (size_t) num)) {
+				return (-1);
+			}
+			jptr += num;
+			-- ctx->top->u.object.size;
+			continue;
+		}
+
+		if ((type == __JVT_OBJECT && num > (YOD_JVALUE_MAX_SIZE >> 1)) ||
+			(type == __JVT_ARRAY && num > YOD_JVALUE_MAX_SIZE))
+		{
+			if (err) {
+				snprintf(err, 255, "Too long (at %d) in %s:%d %s",
+					(int) (head - (byte *) data), __ENV_TRACE3);
+			}
+			return (-1);
+		}
+
+		if (!_yod_jvalue_decode_new(ctx, &ctx->top, &ctx->root, type)) {
+			return (-1);
+		}
+		value = ctx->top;
 
-				value->u.array.count = 0;
+		/* an open container counts down what it still waits for */
+		switch (type) {
+			case __JVT_OBJECT:
+				value->u.object.size = (size_t) num * 2;
 				break;
 
-			case __JVT_STRING:
+			case __JVT_ARRAY:
+				value->u.array.size = (size_t) num;
+				break;
 
-				value->u.string.ptr = (char *) malloc((value->u.string.len + 1) * sizeof(char));
-				if (!value->u.string.ptr) {
-					YOD_STDLOG_ERROR("malloc failed");
-					return (0);
+			case __JVT_STRING:
+				/* moved over its own header, which leaves room for the \0 */
+				if (ctx->opts & __JVD_INSITU) {
+					memmove(head, jptr, (size_t) num);
+					value->u.string.ptr = (char *) head;
+					value->flags |= __JVN_BORROW;
+				}
+				else {
+					if ((value->u.string.ptr = (char *) _yod_jvalue_decode_alloc(ctx, (size_t) num + 1)) == NULL) {
+						return (-1);
+					}
+					memcpy(value->u.string.ptr, jptr, (size_t) num);
 				}
+				value->u.string.ptr[num] = '\0';
+				value->u.string.len = (size_t) num;
+				jptr += num;
+				break;
+
+			case __JVT_INTEGER:
+				value->u.ival = (int64_t) num;
+				break;
+
+			case __JVT_DOUBLE:
+				value->u.dval = dval;
+				break;
 
-				value->u.string.len = 0;
+			case __JVT_BOOLEAN:
+				value->u.bval = (b == 0xc3);
 				break;
 
 			default:
 				break;
 		};
 
-		return (1);
+		if ((type == __JVT_OBJECT || type == __JVT_ARRAY) && num > 0) {
+			continue;
+		}
+
+		/* the value is complete, so may be the containers around it */
+		while ((parent = ctx->top->parent) != NULL) {
+			value = ctx->top;
+			if (!_yod_jvalue_decode_end(ctx, value)) {
+				return (-1);
+			}
+
+			if (value->type == __JVT_ARRAY) {
+				value->u.array.size = value->u.array.count;
+			}
+
+			if (parent->type == __JVT_OBJECT) {
+				ctx->stack[ctx->count - 1].value = value;
+				left = -- parent->u.object.size;
+			}
+			else {
+				if (!_yod_jvalue_decode_push(ctx, value, NULL, 0)) {
+					return (-1);
+				}
+				left = -- parent->u.array.size;
+			}
+
+			ctx->top = parent;
+			if (left > 0) {
+				break;
+			}
+		}
+
+		if (!parent) {
+			done = 1;
+			break;
+		}
 	}
 
-	if ((value = (yod_jvalue_t *) calloc(1, sizeof(yod_jvalue_t))) == NULL) {
-		YOD_STDLOG_ERROR("calloc failed");
-		return (0);
+	if (!done) {
+		goto e_eof;
 	}
 
-	if (!*root) {
-		*root = value;
+	if (jptr < jend) {
+		if (err) {
+			snprintf(err, 255, "Unexpected data after the value (at %d) in %s:%d %s",
+				(int) (jptr - (byte *) data), __ENV_TRACE3);
+		}
+		return (-1);
 	}
 
-	value->type = type;
-	value->parent = *top;
+	return (1);
 
-	if (*alloc) {
-		(*alloc)->_reserved.u.ptr = value;
-	}
+e_eof:
 
-	*alloc = *top = value;
+	if (err) {
+		snprintf(err, 255, "EOF unexpected (at %d) in %s:%d %s",
+			(int) len, __ENV_TRACE3);
+	}
 
-	return (1);
+	return (-1);
 }
 /* }}} */
 
@@ -2675,6 +5170,8 @@ static size_t _yod_jvalue_encode_strlen(char *str, size_t len)
 			case '\r':
 			case '\t':
 				ret += 2;
+				break;
+
 			default:
 				++ ret;
 				break;
@@ -2690,17 +5187,57 @@ static size_t _yod_jvalue_encode_strlen(char *str, size_t len)
 */
 static int _yod_jvalue_object_find(yod_jvalue_t *self, char *name, size_t *index, int force)
 {
-	size_t i, a, b;
+	yod_jvalue_v *data = self->u.object.data.ptr;
+	uint32_t *slots = NULL;
+	uint32_t *order = NULL;
+	uint32_t hash = 0;
+	size_t mask = 0;
+	size_t s = 0;
+	size_t i, k, a, b;
 	int ret = -1;
 
+	if (self->flags & (__JVN_INDEX | __JVN_INSERT)) {
+		hash = _yod_jvalue_object_hash(name);
+	}
+
 	a = i = 0;
-	if (self->u.object.count > 0) {
+	if (self->flags & __JVN_INDEX) {
+		slots = (uint32_t *) (data + self->u.object.size + 1);
+		mask = _yod_jvalue_object_slots(self->u.object.size) - 1;
+		if (self->flags & __JVN_ORDER) {
+			order = slots + mask + 1;
+		}
+		for (s = hash & mask; slots[s] != 0; s = (s + 1) & mask) {
+			i = slots[s] - 1;
+			if (data[i].hash == hash && strcmp(name, data[i].name) == 0) {
+				if (index) {
+					*index = i;
+				}
+				return (0);
+			}
+		}
+	}
+	else if (self->flags & __JVN_INSERT) {
+		for (i = 0; i < self->u.object.count; ++ i) {
+			if (data[i].hash == hash && strcmp(name, data[i].name) == 0) {
+				if (index) {
+					*index = i;
+				}
+				return (0);
+			}
+		}
+	}
+
+	/* sorted objects look up by binary search, with an index only
+	 * the place of a new key is */
+	if (!(self->flags & __JVN_INSERT) && (force || !slots) && self->u.object.count > 0) {
 		b = self->u.object.count - 1;
 		while (a <= b) {
 			i = (a + b) / 2;
-			if ((ret = strcmp(name, self->u.object.data.ptr[i].name)) == 0) {
+			k = order ? order[i] : i;
+			if ((ret = strcmp(name, data[k].name)) == 0) {
 				if (index) {
-					*index = i;
+					*index = k;
 				}
 				break;
 			}
@@ -2720,10 +5257,33 @@ static int _yod_jvalue_object_find(yod_jvalue_t *self, char *name, size_t *index
 	if (ret != 0 && force != 0) {
 		i = self->u.object.count;
 		if (i < self->u.object.size) {
-			for (; i > a; -- i) {
-				self->u.object.data.ptr[i].name = self->u.object.data.ptr[i - 1].name;
-				self->u.object.data.ptr[i].name_len = self->u.object.data.ptr[i - 1].name_len;
-				self->u.object.data.ptr[i].value = self->u.object.data.ptr[i - 1].value;
+			if (order) {
+				/* the new member goes last, only its place in the order moves */
+				memmove(order + a + 1, order + a, (i - a) * sizeof(uint32_t));
+				order[a] = (uint32_t) i;
+			}
+			else if (!(self->flags & __JVN_INSERT)) {
+				for (; i > a; -- i) {
+					data[i].name = data[i - 1].name;
+					data[i].name_len = data[i - 1].name_len;
+					data[i].hash = data[i - 1].hash;
+					data[i].value = data[i - 1].value;
+				}
+
+				/* members behind the new one moved up */
+				if (slots && a < self->u.object.count) {
+					for (b = 0; b <= mask; ++ b) {
+						if (slots[b] > a) {
+							++ slots[b];
+						}
+					}
+				}
+			}
+
+			data[i].name = name;
+			data[i].hash = hash;
+			if (slots) {
+				slots[s] = (uint32_t) (i + 1);
 			}
 			++ self->u.object.count;
 		}
@@ -2735,3 +5295,99 @@ static int _yod_jvalue_object_find(yod_jvalue_t *self, char *name, size_t *index
 	return ret;
 }
 /* }}} */
+
+
+/** {{{ static uint32_t _yod_jvalue_object_hash(const char *name)
+*/
+static uint32_t _yod_jvalue_object_hash(const char *name)
+{
+	uint32_t hash = 2166136261U;
+
+	/* FNV-1a, keys compare as C strings so hash as them too */
+	while (*name) {
+		hash ^= (byte) *name ++;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+/* }}} */
+
+
+/** {{{ static size_t _yod_jvalue_object_slots(size_t size)
+*/
+static size_t _yod_jvalue_object_slots(size_t size)
+{
+	size_t slots = YOD_JVALUE_INDEX_MIN;
+
+	if (size < YOD_JVALUE_INDEX_MIN) {
+		return (0);
+	}
+
+	/* at most half full */
+	while (slots < size * 2) {
+		slots <<= 1;
+	}
+
+	return slots;
+}
+/* }}} */
+
+
+/** {{{ static void _yod_jvalue_object_index(yod_jvalue_t *self)
+*/
+static void _yod_jvalue_object_index(yod_jvalue_t *self)
+{
+	yod_jvalue_v *data = self->u.object.data.ptr;
+	uint32_t *slots = (uint32_t *) (data + self->u.object.size + 1);
+	size_t mask = _yod_jvalue_object_slots(self->u.object.size) - 1;
+	size_t i, s;
+
+	memset(slots, 0, (mask + 1) * sizeof(uint32_t));
+
+	for (i = 0; i < self->u.object.count; ++ i) {
+		for (s = data[i].hash & mask; slots[s] != 0; s = (s + 1) & mask);
+		slots[s] = (uint32_t) (i + 1);
+	}
+}
+/* }}} */
+
+
+/** {{{ static size_t _yod_jvalue_object_at(yod_jvalue_t *self, size_t index)
+*/
+static size_t _yod_jvalue_object_at(yod_jvalue_t *self, size_t index)
+{
+	uint32_t *order = NULL;
+
+	/* the member at a sorted position, members of an ordered
+	 * object stay where they were added */
+	if (self->flags & __JVN_ORDER) {
+		order = (uint32_t *) (self->u.object.data.ptr + self->u.object.size + 1);
+		return order[_yod_jvalue_object_slots(self->u.object.size) + index];
+	}
+
+	return index;
+}
+/* }}} */
+
+
+/** {{{ static void _yod_jvalue_object_sort(yod_jvalue_t *self)
+*/
+static void _yod_jvalue_object_sort(yod_jvalue_t *self)
+{
+	qsort(self->u.object.data.ptr, self->u.object.count, sizeof(yod_jvalue_v), _yod_jvalue_object_cmp);
+
+	if (self->flags & __JVN_INDEX) {
+		_yod_jvalue_object_index(self);
+	}
+}
+/* }}} */
+
+
+/** {{{ static int _yod_jvalue_object_cmp(const void *a, const void *b)
+*/
+static int _yod_jvalue_object_cmp(const void *a, const void *b)
+{
+	return strcmp(((const yod_jvalue_v *) a)->name, ((const yod_jvalue_v *) b)->name);
+}
+/* }}} */
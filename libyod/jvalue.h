@@ -7,6 +7,9 @@
 /* yod_jvalue_t */
 typedef struct _yod_jvalue_t 									yod_jvalue_t;
 
+/* yod_jdecoder_t */
+typedef struct _yod_jvalue_d 									yod_jdecoder_t;
+
 
 enum
 {
@@ -31,18 +34,87 @@ enum
 #define __JVT_NULL												YOD_JVALUE_TYPE_NULL
 
 
+enum
+{
+	YOD_JVALUE_DECODE_ARENA = 0x01,
+	YOD_JVALUE_DECODE_INSERT = 0x02,
+	YOD_JVALUE_DECODE_INSITU = 0x04
+};
+
+
+enum
+{
+	YOD_JVALUE_OBJECT_SORTED = 0x00,
+	YOD_JVALUE_OBJECT_INSERT = 0x01
+};
+
+
+enum
+{
+	YOD_JVALUE_FEED_ERROR = -1,
+	YOD_JVALUE_FEED_MORE = 0,
+	YOD_JVALUE_FEED_DONE = 1
+};
+
+
+enum
+{
+	YOD_JVALUE_EVENT_VALUE,
+	YOD_JVALUE_EVENT_BEGIN,
+	YOD_JVALUE_EVENT_END
+};
+
+
+#define __JVD_ARENA 											YOD_JVALUE_DECODE_ARENA
+#define __JVD_INSERT 											YOD_JVALUE_DECODE_INSERT
+#define __JVD_INSITU 											YOD_JVALUE_DECODE_INSITU
+#define __JVD_FEED_ERROR 										YOD_JVALUE_FEED_ERROR
+#define __JVD_FEED_MORE 										YOD_JVALUE_FEED_MORE
+#define __JVD_FEED_DONE 										YOD_JVALUE_FEED_DONE
+
+#define __JVO_SORTED 											YOD_JVALUE_OBJECT_SORTED
+#define __JVO_INSERT 											YOD_JVALUE_OBJECT_INSERT
+
+#define __JVE_VALUE 											YOD_JVALUE_EVENT_VALUE
+#define __JVE_BEGIN 											YOD_JVALUE_EVENT_BEGIN
+#define __JVE_END 												YOD_JVALUE_EVENT_END
+
+
+/* yod_jvalue_fn, value is only valid during the call */
+typedef int (*yod_jvalue_fn) (int event, const char *name, size_t name_len, yod_jvalue_t *value, void *arg __ENV_CPARM);
+
+/* yod_jvalue_sink_fn, non-zero stops the write */
+typedef int (*yod_jvalue_sink_fn) (const char *data, size_t len, void *arg __ENV_CPARM);
+
+
 #define yod_jvalue_new() 										_yod_jvalue_new(__ENV_ARGS)
 #define yod_jvalue_free(x) 										_yod_jvalue_free(x __ENV_CARGS)
 
 #define yod_jvalue_type(x) 										_yod_jvalue_type(x __ENV_CARGS)
 #define yod_jvalue_clone(x) 									_yod_jvalue_clone(x __ENV_CARGS)
 #define yod_jvalue_load(f, e) 									_yod_jvalue_load(f, e __ENV_CARGS)
+#define yod_jvalue_load_lazy(f, e) 								_yod_jvalue_load_lazy(f, e __ENV_CARGS)
 #define yod_jvalue_dump(x) 										_yod_jvalue_dump(x __ENV_CARGS)
+#define yod_jvalue_write(x, f, a) 								_yod_jvalue_write(x, f, a __ENV_CARGS)
 
 #define yod_jvalue_encode(d, x) 								_yod_jvalue_encode(d, x __ENV_CARGS)
 #define yod_jvalue_decode(d, l, e) 								_yod_jvalue_decode(d, l, e __ENV_CARGS)
+#define yod_jvalue_decode_ex(d, l, e, o) 						_yod_jvalue_decode_ex(d, l, e, o __ENV_CARGS)
+#define yod_jvalue_decode_arena(d, l, e) 						_yod_jvalue_decode_ex(d, l, e, __JVD_ARENA __ENV_CARGS)
+#define yod_jvalue_parse(d, l, f, a, e) 						_yod_jvalue_parse(d, l, f, a, e __ENV_CARGS)
+
+#define yod_jvalue_pack(x, l) 									_yod_jvalue_pack(x, l __ENV_CARGS)
+#define yod_jvalue_pack_write(x, f, a) 							_yod_jvalue_pack_write(x, f, a __ENV_CARGS)
+#define yod_jvalue_unpack(d, l, e) 								_yod_jvalue_unpack(d, l, e, 0 __ENV_CARGS)
+#define yod_jvalue_unpack_ex(d, l, e, o) 						_yod_jvalue_unpack(d, l, e, o __ENV_CARGS)
+
+#define yod_jdecoder_new(o) 									_yod_jvalue_decoder_new(o __ENV_CARGS)
+#define yod_jdecoder_free(x) 									_yod_jvalue_decoder_free(x __ENV_CARGS)
+#define yod_jdecoder_feed(x, d, l, e) 							_yod_jvalue_decoder_feed(x, d, l, e __ENV_CARGS)
+#define yod_jdecoder_end(x, e) 									_yod_jvalue_decoder_end(x, e __ENV_CARGS)
 
 #define yod_jobject_new(z) 										_yod_jvalue_object_new(z __ENV_CARGS)
+#define yod_jobject_new_ex(z, o) 								_yod_jvalue_object_new_ex(z, o __ENV_CARGS)
 #define yod_jobject_set(x, k, v) 								_yod_jvalue_object_set(x, k, v __ENV_CARGS)
 #define yod_jobject_get(x, k) 									_yod_jvalue_object_get(x, k __ENV_CARGS)
 #define yod_jobject_fetch(x, i, k, l) 							_yod_jvalue_object_fetch(x, i, k, l __ENV_CARGS)
@@ -94,13 +166,32 @@ void _yod_jvalue_free(yod_jvalue_t *self __ENV_CPARM);
 int _yod_jvalue_type(yod_jvalue_t *self __ENV_CPARM);
 yod_jvalue_t *_yod_jvalue_clone(yod_jvalue_t *self __ENV_CPARM);
 yod_jvalue_t *_yod_jvalue_load(const char *file, char *err __ENV_CPARM);
+/* a lazy tree keeps its file mapped and reads each container on first use,
+ * so it is not safe to share between threads until fully read */
+yod_jvalue_t *_yod_jvalue_load_lazy(const char *file, char *err __ENV_CPARM);
 char *_yod_jvalue_dump(yod_jvalue_t *self __ENV_CPARM);
+int _yod_jvalue_write(yod_jvalue_t *self, yod_jvalue_sink_fn func, void *arg __ENV_CPARM);
 
 size_t _yod_jvalue_encode(char *data, yod_jvalue_t *self __ENV_CPARM);
+/* __JVD_INSITU leaves strings in data, which must outlive the tree */
 yod_jvalue_t *_yod_jvalue_decode(char *data, size_t len, char *err __ENV_CPARM);
+yod_jvalue_t *_yod_jvalue_decode_ex(char *data, size_t len, char *err, int opts __ENV_CPARM);
+int _yod_jvalue_parse(char *data, size_t len, yod_jvalue_fn func, void *arg, char *err __ENV_CPARM);
+
+/* msgpack, __JVD_INSITU as for decode */
+char *_yod_jvalue_pack(yod_jvalue_t *self, size_t *len __ENV_CPARM);
+int _yod_jvalue_pack_write(yod_jvalue_t *self, yod_jvalue_sink_fn func, void *arg __ENV_CPARM);
+yod_jvalue_t *_yod_jvalue_unpack(char *data, size_t len, char *err, int opts __ENV_CPARM);
+
+/* jdecoder */
+yod_jdecoder_t *_yod_jvalue_decoder_new(int opts __ENV_CPARM);
+void _yod_jvalue_decoder_free(yod_jdecoder_t *self __ENV_CPARM);
+int _yod_jvalue_decoder_feed(yod_jdecoder_t *self, const char *data, size_t len, char *err __ENV_CPARM);
+yod_jvalue_t *_yod_jvalue_decoder_end(yod_jdecoder_t *self, char *err __ENV_CPARM);
 
 /* jobject */
 yod_jvalue_t *_yod_jvalue_object_new(size_t size __ENV_CPARM);
+yod_jvalue_t *_yod_jvalue_object_new_ex(size_t size, int opts __ENV_CPARM);
 int _yod_jvalue_object_set(yod_jvalue_t *self, const char *name, yod_jvalue_t *value __ENV_CPARM);
 yod_jvalue_t *_yod_jvalue_object_get(yod_jvalue_t *self, const char *name __ENV_CPARM);
 yod_jvalue_t *_yod_jvalue_object_fetch(yod_jvalue_t *self, size_t index, char **name, size_t *name_len __ENV_CPARM);
@@ -11,6 +11,10 @@
 #define _YOD_RBTREE_DEBUG 										0
 #endif
 
+#define YOD_RBTREE_CHUNK_MIN 									32
+#define YOD_RBTREE_CHUNK_MAX 									4096
+#define YOD_RBTREE_CACHE_SIZE 									64
+
 
 /* yod_rbtree_v */
 typedef struct _yod_rbtree_v
@@ -29,23 +33,65 @@ typedef struct _yod_rbtree_v
 } yod_rbtree_v;
 
 
+/* yod_rbtree_x, the larger node of YOD_RBTREE_RANK and YOD_RBTREE_INTERVAL trees */
+typedef struct _yod_rbtree_x
+{
+	yod_rbtree_v node;
+
+	/* subtree size, kept with YOD_RBTREE_RANK */
+	ulong size;
+
+	/* interval end and subtree max end, kept with YOD_RBTREE_INTERVAL */
+	uint64_t high;
+	uint64_t max;
+} yod_rbtree_x;
+
+
+/* yod_rbtree_k, a chunk of nodes */
+typedef struct _yod_rbtree_k
+{
+	struct _yod_rbtree_k *next;
+	ulong size;
+
+	yod_rbtree_v nodes[1];
+} yod_rbtree_k;
+
+
+/* yod_rbtree_p, a node pool, free nodes are linked through next */
+typedef struct _yod_rbtree_p
+{
+	yod_rbtree_v *free;
+	yod_rbtree_k *chunks;
+	ulong size;
+	ulong count;
+} yod_rbtree_p;
+
+
 /* yod_rbtree_t */
 struct _yod_rbtree_t
 {
 	pthread_mutex_t lock;
 
 	ulong count;
+	ulong stamp;
 
 	yod_rbtree_v *root;
 	yod_rbtree_v *head;
 	yod_rbtree_v *tail;
-	yod_rbtree_v *curr;
+	yod_rbtree_i curr;
 	yod_rbtree_v *leaf;
 
+	/* YOD_RBTREE_SHARED draws nodes from the thread caches */
+	int flags;
+	yod_rbtree_p pool;
+
 	void (*vfree) (void * __ENV_CPARM);
 };
 
 
+#define YOD_RBTREE_AUGMENT 										(YOD_RBTREE_RANK | YOD_RBTREE_INTERVAL)
+
+#define yod_rbtree_ext(n) 										((yod_rbtree_x *) (n))
 #define yod_rbtree_is_red(n) 									((n) && (n)->color)
 #define yod_rbtree_is_black(n) 									((n) && !(n)->color)
 
@@ -53,13 +99,43 @@ struct _yod_rbtree_t
 #define yod_rbtree_right_rotate(x, n) 							_yod_rbtree_right_rotate(x, n __ENV_CARGS)
 
 
+static void _yod_rbtree_remove(yod_rbtree_t *self, yod_rbtree_v *node __ENV_CPARM);
+static uint64_t _yod_rbtree_max(yod_rbtree_v *node);
+static int _yod_rbtree_overlaps(yod_rbtree_t *self, yod_rbtree_v *node, uint64_t lo, uint64_t hi, yod_rbtree_ifn func, void *arg __ENV_CPARM);
 static void _yod_rbtree_left_rotate(yod_rbtree_t *self, yod_rbtree_v *node __ENV_CPARM);
 static void _yod_rbtree_right_rotate(yod_rbtree_t *self, yod_rbtree_v *node __ENV_CPARM);
+static void *_yod_rbtree_iter(yod_rbtree_i *iter, int forward, uint64_t *key);
+static yod_rbtree_v *_yod_rbtree_search(yod_rbtree_t *self, uint64_t key, int mode);
+static yod_rbtree_v *_yod_rbtree_alloc(yod_rbtree_t *self __ENV_CPARM);
+static void _yod_rbtree_release(yod_rbtree_t *self, yod_rbtree_v *node __ENV_CPARM);
+static int _yod_rbtree_grow(yod_rbtree_p *pool, ulong stride __ENV_CPARM);
+static yod_rbtree_p *_yod_rbtree_cache(__ENV_PARM);
+static void _yod_rbtree_cache_init(void);
+static void _yod_rbtree_cache_free(void *arg);
+static void _yod_rbtree_rotl(yod_rbtree_r *tree, yod_rbtree_n *node);
+static void _yod_rbtree_rotr(yod_rbtree_r *tree, yod_rbtree_n *node);
+static void _yod_rbtree_swap(yod_rbtree_r *tree, yod_rbtree_n *node, yod_rbtree_n *repl);
+
+
+/* yod_rbtree_pool__ */
+static yod_rbtree_p yod_rbtree_pool__ = {NULL, NULL, 0, 0};
+static pthread_mutex_t yod_rbtree_lock__ = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t yod_rbtree_once__ = PTHREAD_ONCE_INIT;
+static pthread_key_t yod_rbtree_key__;
 
 
 /** {{{ yod_rbtree_t *_yod_rbtree_new(void (*vfree) (void * __ENV_GPARM) __ENV_CPARM)
 */
 yod_rbtree_t *_yod_rbtree_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM)
+{
+	return _yod_rbtree_new_ex(vfree, 0 __ENV_CARGS);
+}
+/* }}} */
+
+
+/** {{{ yod_rbtree_t *_yod_rbtree_new_ex(void (*vfree) (void * __ENV_CPARM), int flags __ENV_CPARM)
+*/
+yod_rbtree_t *_yod_rbtree_new_ex(void (*vfree) (void * __ENV_CPARM), int flags __ENV_CPARM)
 {
 	yod_rbtree_t *self = NULL;
 
@@ -77,13 +153,27 @@ yod_rbtree_t *_yod_rbtree_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM)
 	}
 
 	self->count = 0;
+	self->stamp = 0;
 
 	self->root = NULL;
 	self->head = NULL;
 	self->tail = NULL;
-	self->curr = NULL;
+	self->curr.tree = self;
+	self->curr.node = NULL;
+
+	/* augmented nodes are larger and never come from the shared caches */
+	if (flags & YOD_RBTREE_AUGMENT) {
+		flags &= ~YOD_RBTREE_SHARED;
+	}
 
-	self->leaf = (yod_rbtree_v *) malloc(sizeof(yod_rbtree_v));
+	self->flags = flags;
+	self->pool.free = NULL;
+	self->pool.chunks = NULL;
+	self->pool.size = 0;
+	self->pool.count = 0;
+
+	/* the leaf is read as an augmented node by every tree */
+	self->leaf = (yod_rbtree_v *) malloc(sizeof(yod_rbtree_x));
 	if (!self->leaf) {
 		yod_rbtree_free(self);
 
@@ -98,14 +188,17 @@ yod_rbtree_t *_yod_rbtree_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM)
 	self->leaf->prev = NULL;
 	self->leaf->color = 0;
 	self->leaf->value = NULL;
+	yod_rbtree_ext(self->leaf)->size = 0;
+	yod_rbtree_ext(self->leaf)->high = 0;
+	yod_rbtree_ext(self->leaf)->max = 0;
 
 	self->root = self->leaf;
 
 	self->vfree = vfree;
 
 #if (_YOD_SYSTEM_DEBUG && _YOD_RBTREE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p): %p in %s:%d %s",
-		__FUNCTION__, vfree, self, __ENV_TRACE);
+	yod_stdlog_debug(NULL, "%s(%p, %d): %p in %s:%d %s",
+		__FUNCTION__, vfree, flags, self, __ENV_TRACE);
 #else
 	__ENV_VOID
 #endif
@@ -120,6 +213,8 @@ yod_rbtree_t *_yod_rbtree_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM)
 void _yod_rbtree_free(yod_rbtree_t *self __ENV_CPARM)
 {
 	yod_rbtree_v *node = NULL;
+	yod_rbtree_v *temp = NULL;
+	yod_rbtree_k *chunk = NULL;
 
 	if (!self) {
 		return;
@@ -133,12 +228,18 @@ void _yod_rbtree_free(yod_rbtree_t *self __ENV_CPARM)
 #endif
 
 	pthread_mutex_lock(&self->lock);
-	for (node = self->head; node != NULL; node = self->curr) {
-		self->curr = node->next;
+	for (node = self->head; node != NULL; node = temp) {
+		temp = node->next;
 		if (self->vfree) {
 			self->vfree(node->value __ENV_CARGS);
 		}
-		free(node);
+		if (self->flags & YOD_RBTREE_SHARED) {
+			_yod_rbtree_release(self, node __ENV_CARGS);
+		}
+	}
+	while ((chunk = self->pool.chunks) != NULL) {
+		self->pool.chunks = chunk->next;
+		free(chunk);
 	}
 	if (self->leaf) {
 		free(self->leaf);
@@ -153,11 +254,20 @@ void _yod_rbtree_free(yod_rbtree_t *self __ENV_CPARM)
 /** {{{ int _yod_rbtree_add(yod_rbtree_t *self, uint64_t key, void *value, int force __ENV_CPARM)
 */
 int _yod_rbtree_add(yod_rbtree_t *self, uint64_t key, void *value, int force __ENV_CPARM)
+{
+	return _yod_rbtree_add_interval(self, key, key, value, force __ENV_CARGS);
+}
+/* }}} */
+
+
+/** {{{ int _yod_rbtree_add_interval(yod_rbtree_t *self, uint64_t key, uint64_t high, void *value, int force __ENV_CPARM)
+*/
+int _yod_rbtree_add_interval(yod_rbtree_t *self, uint64_t key, uint64_t high, void *value, int force __ENV_CPARM)
 {
 	yod_rbtree_v *p, *node = NULL;
 	int ret = 0;
 
-	if (!self) {
+	if (!self || high < key) {
 		return (-1);
 	}
 
@@ -177,15 +287,24 @@ int _yod_rbtree_add(yod_rbtree_t *self, uint64_t key, void *value, int force __E
 				self->vfree(node->value __ENV_CARGS);
 			}
 			node->value = value;
+
+			/* the end may change, refresh the max ends up to the root */
+			if ((self->flags & YOD_RBTREE_INTERVAL) && yod_rbtree_ext(node)->high != high) {
+				yod_rbtree_ext(node)->high = high;
+				for (p = node;; p = p->parent) {
+					yod_rbtree_ext(p)->max = _yod_rbtree_max(p);
+					if (p == self->root) {
+						break;
+					}
+				}
+			}
 			goto e_return;
 		}
 	}
 
-	node = (yod_rbtree_v *) malloc(sizeof(yod_rbtree_v));
+	node = _yod_rbtree_alloc(self __ENV_CARGS);
 	if (!node) {
 		ret = -1;
-
-		YOD_STDLOG_ERROR("malloc failed");
 		goto e_return;
 	}
 
@@ -200,6 +319,11 @@ int _yod_rbtree_add(yod_rbtree_t *self, uint64_t key, void *value, int force __E
 
 	node->color = 1; /* red */
 	node->value = value;
+	if (self->flags & YOD_RBTREE_AUGMENT) {
+		yod_rbtree_ext(node)->size = 1;
+		yod_rbtree_ext(node)->high = high;
+		yod_rbtree_ext(node)->max = high;
+	}
 
 	++ self->count;
 
@@ -218,6 +342,12 @@ int _yod_rbtree_add(yod_rbtree_t *self, uint64_t key, void *value, int force __E
 
 		for (p = self->root; p != self->leaf;) {
 			node->parent = p;
+			if (self->flags & YOD_RBTREE_RANK) {
+				++ yod_rbtree_ext(p)->size;
+			}
+			if ((self->flags & YOD_RBTREE_INTERVAL) && yod_rbtree_ext(p)->max < high) {
+				yod_rbtree_ext(p)->max = high;
+			}
 			p = (node->key < p->key) ? p->left : p->right;
 		}
 
@@ -301,8 +431,7 @@ e_return:
 int _yod_rbtree_del(yod_rbtree_t *self, uint64_t key __ENV_CPARM)
 {
 	yod_rbtree_v *node = NULL;
-	yod_rbtree_v *p, *t, *w;
-	byte color = 0;
+	yod_rbtree_v *p = NULL;
 	int ret = 0;
 
 	if (!self || !self->root) {
@@ -324,168 +453,7 @@ int _yod_rbtree_del(yod_rbtree_t *self, uint64_t key __ENV_CPARM)
 		goto e_return;
 	}
 
-	-- self->count;
-
-	{
-		if (node == self->head) {
-			self->head = node->next;
-		}
-		if (node == self->tail) {
-			self->tail = node->prev;
-		}
-		if (node == self->curr) {
-			self->curr = node->next;
-		}
-		if (node->next) {
-			node->next->prev = node->prev;
-		}
-		if (node->prev) {
-			node->prev->next = node->next;
-		}
-		if (self->vfree) {
-			self->vfree(node->value __ENV_CARGS);
-		}
-	}
-
-	if (node->left == self->leaf) {
-		p = node->right;
-		t = node;
-	}
-	else if (node->right == self->leaf) {
-		p = node->left;
-		t = node;
-	} else {
-		t = node->right;
-		while (t->left != self->leaf) {
-			t = t->left;
-		}
-		if (t->left != self->leaf) {
-			p = t->left;
-		} else {
-			p = t->right;
-		}
-	}
-
-	if (t == self->root) {
-		self->root = p;
-		p->color = 0; /* black */
-
-		free(node);
-		goto e_return;
-	}
-
-	color = t->color;
-
-	if (t == t->parent->left) {
-		t->parent->left = p;
-	} else {
-		t->parent->right = p;
-	}
-
-	if (t == node) {
-		p->parent = t->parent;
-	}
-	else {
-		if (t->parent == node) {
-			p->parent = t;
-		} else {
-			p->parent = t->parent;
-		}
-
-		t->left = node->left;
-		t->right = node->right;
-		t->parent = node->parent;
-		t->color = node->color;
-
-		if (node == self->root) {
-			self->root = t;
-		}
-		else {
-			if (node == node->parent->left) {
-				node->parent->left = t;
-			} else {
-				node->parent->right = t;
-			}
-		}
-
-		if (t->left != self->leaf) {
-			t->left->parent = t;
-		}
-
-		if (t->right != self->leaf) {
-			t->right->parent = t;
-		}
-	}
-
-	free(node);
-
-	if (color) {
-		goto e_return;
-	}
-
-	/* a delete fixup */
-	while (p != self->root && !p->color) {
-		if (p == p->parent->left) {
-			w = p->parent->right;
-
-			if (w->color) {
-				w->color = 0; /* black */
-				p->parent->color = 1; /* red */
-				yod_rbtree_left_rotate(self, p->parent);
-				w = p->parent->right;
-			}
-
-			if (!w->left->color && !w->right->color) {
-				w->color = 1; /* red */
-				p = p->parent;
-			}
-			else {
-				if (!w->right->color) {
-					w->left->color = 0; /* black */
-					w->color = 1; /* red */
-					yod_rbtree_right_rotate(self, w);
-					w = p->parent->right;
-				}
-				w->color = p->parent->color;
-				p->parent->color = 0; /* black */
-				w->right->color = 0; /* black */
-				yod_rbtree_left_rotate(self, p->parent);
-				p = self->root;
-			}
-
-		} else {
-			w = p->parent->left;
-
-			if (w->color) {
-				w->color = 0; /* black */
-				p->parent->color = 1; /* red */
-				yod_rbtree_right_rotate(self, p->parent);
-				w = p->parent->left;
-			}
-
-			if (!w->left->color && !w->right->color) {
-				w->color = 1; /* red */
-				p = p->parent;
-			}
-			else {
-				if (!w->left->color) {
-					w->right->color = 0; /* black */
-					w->color = 1; /* red */
-					yod_rbtree_left_rotate(self, w);
-					w = p->parent->left;
-				}
-				w->color = p->parent->color;
-				p->parent->color = 0; /* black */
-				w->left->color = 0; /* black */
-				yod_rbtree_right_rotate(self, p->parent);
-				p = self->root;
-			}
-		}
-	}
-
-	if (p != NULL) {
-		p->color = 0; /* black */
-	}
+	_yod_rbtree_remove(self, node __ENV_CARGS);
 
 e_return:
 
@@ -567,13 +535,8 @@ void *_yod_rbtree_head(yod_rbtree_t *self, uint64_t *key __ENV_CPARM)
 	}
 
 	pthread_mutex_lock(&self->lock);
-	if (self->head) {
-		self->curr = self->head;
-		if (key) {
-			*key = self->curr->key;
-		}
-		value = self->curr->value;
-	}
+	self->curr.node = NULL;
+	value = _yod_rbtree_iter(&self->curr, 1, key);
 	pthread_mutex_unlock(&self->lock);
 
 #if (_YOD_SYSTEM_DEBUG && _YOD_RBTREE_DEBUG)
@@ -599,13 +562,8 @@ void *_yod_rbtree_tail(yod_rbtree_t *self, uint64_t *key __ENV_CPARM)
 	}
 
 	pthread_mutex_lock(&self->lock);
-	if (self->tail) {
-		self->curr = self->tail;
-		if (key) {
-			*key = self->curr->key;
-		}
-		value = self->curr->value;
-	}
+	self->curr.node = NULL;
+	value = _yod_rbtree_iter(&self->curr, 0, key);
 	pthread_mutex_unlock(&self->lock);
 
 #if (_YOD_SYSTEM_DEBUG && _YOD_RBTREE_DEBUG)
@@ -631,12 +589,8 @@ void *_yod_rbtree_next(yod_rbtree_t *self, uint64_t *key __ENV_CPARM)
 	}
 
 	pthread_mutex_lock(&self->lock);
-	if (self->curr && self->curr->next) {
-		self->curr = self->curr->next;
-		if (key) {
-			*key = self->curr->key;
-		}
-		value = self->curr->value;
+	if (self->curr.node) {
+		value = _yod_rbtree_iter(&self->curr, 1, key);
 	}
 	pthread_mutex_unlock(&self->lock);
 
@@ -663,12 +617,8 @@ void *_yod_rbtree_prev(yod_rbtree_t *self, uint64_t *key __ENV_CPARM)
 	}
 
 	pthread_mutex_lock(&self->lock);
-	if (self->curr && self->curr->prev) {
-		self->curr = self->curr->prev;
-		if (key) {
-			*key = self->curr->key;
-		}
-		value = self->curr->value;
+	if (self->curr.node) {
+		value = _yod_rbtree_iter(&self->curr, 0, key);
 	}
 	pthread_mutex_unlock(&self->lock);
 
@@ -684,61 +634,936 @@ void *_yod_rbtree_prev(yod_rbtree_t *self, uint64_t *key __ENV_CPARM)
 /* }}} */
 
 
-/** {{{ static void _yod_rbtree_left_rotate(yod_rbtree_t *self, yod_rbtree_v *node __ENV_CPARM)
+/** {{{ void *_yod_rbtree_iter_head(yod_rbtree_t *self, yod_rbtree_i *iter, uint64_t *key __ENV_CPARM)
 */
-static void _yod_rbtree_left_rotate(yod_rbtree_t *self, yod_rbtree_v *node __ENV_CPARM)
+void *_yod_rbtree_iter_head(yod_rbtree_t *self, yod_rbtree_i *iter, uint64_t *key __ENV_CPARM)
 {
-	yod_rbtree_v  *p = NULL;
+	void *value = NULL;
 
-	if (!self) {
-		return;
+	if (!self || !iter) {
+		return NULL;
 	}
 
-	p = node->right;
-	node->right = p->left;
-	if (p->left != self->leaf) {
-		p->left->parent = node;
-	}
-	p->parent = node->parent;
-	if (node == self->root) {
-		self->root = p;
-	} else if (node == node->parent->left) {
-		node->parent->left = p;
-	} else {
-		node->parent->right = p;
-	}
-	p->left = node;
-	node->parent = p;
+	iter->tree = self;
+	iter->node = NULL;
+
+	pthread_mutex_lock(&self->lock);
+	value = _yod_rbtree_iter(iter, 1, key);
+	pthread_mutex_unlock(&self->lock);
 
 #if (_YOD_SYSTEM_DEBUG && _YOD_RBTREE_DEBUG)
-	yod_stdlog_debug(NULL, "%s(%p, %lu) in %s:%d %s",
-		__FUNCTION__, self, (ulong) (node ? node->key : -1), __ENV_TRACE);
+	yod_stdlog_debug(NULL, "%s(%p, %p, %lu): %p in %s:%d %s",
+		__FUNCTION__, self, iter, (ulong) (key ? *key : 0), value, __ENV_TRACE);
 #else
 	__ENV_VOID
 #endif
 
+	return value;
 }
 /* }}} */
 
 
-/** {{{ static void _yod_rbtree_right_rotate(yod_rbtree_t *self, yod_rbtree_v *node __ENV_CPARM)
+/** {{{ void *_yod_rbtree_iter_tail(yod_rbtree_t *self, yod_rbtree_i *iter, uint64_t *key __ENV_CPARM)
 */
-static void _yod_rbtree_right_rotate(yod_rbtree_t *self, yod_rbtree_v *node __ENV_CPARM)
+void *_yod_rbtree_iter_tail(yod_rbtree_t *self, yod_rbtree_i *iter, uint64_t *key __ENV_CPARM)
 {
-	yod_rbtree_v  *p = NULL;
+	void *value = NULL;
 
-	if (!self) {
-		return;
+	if (!self || !iter) {
+		return NULL;
 	}
 
-	p = node->left;
-	node->left = p->right;
-	if (p->right != self->leaf) {
-		p->right->parent = node;
-	}
-	p->parent = node->parent;
-	if (node == self->root) {
-		self->root = p;
+	iter->tree = self;
+	iter->node = NULL;
+
+	pthread_mutex_lock(&self->lock);
+	value = _yod_rbtree_iter(iter, 0, key);
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_RBTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p, %lu): %p in %s:%d %s",
+		__FUNCTION__, self, iter, (ulong) (key ? *key : 0), value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_rbtree_iter_next(yod_rbtree_i *iter, uint64_t *key __ENV_CPARM)
+*/
+void *_yod_rbtree_iter_next(yod_rbtree_i *iter, uint64_t *key __ENV_CPARM)
+{
+	void *value = NULL;
+
+	if (!iter || !iter->tree || !iter->node) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&iter->tree->lock);
+	value = _yod_rbtree_iter(iter, 1, key);
+	pthread_mutex_unlock(&iter->tree->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_RBTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu): %p in %s:%d %s",
+		__FUNCTION__, iter, (ulong) (key ? *key : 0), value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_rbtree_iter_prev(yod_rbtree_i *iter, uint64_t *key __ENV_CPARM)
+*/
+void *_yod_rbtree_iter_prev(yod_rbtree_i *iter, uint64_t *key __ENV_CPARM)
+{
+	void *value = NULL;
+
+	if (!iter || !iter->tree || !iter->node) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&iter->tree->lock);
+	value = _yod_rbtree_iter(iter, 0, key);
+	pthread_mutex_unlock(&iter->tree->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_RBTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu): %p in %s:%d %s",
+		__FUNCTION__, iter, (ulong) (key ? *key : 0), value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ int _yod_rbtree_visit(yod_rbtree_t *self, yod_rbtree_fn func, void *arg __ENV_CPARM)
+*/
+int _yod_rbtree_visit(yod_rbtree_t *self, yod_rbtree_fn func, void *arg __ENV_CPARM)
+{
+	yod_rbtree_v *node = NULL;
+	int ret = 0;
+
+	if (!self || !func) {
+		return (-1);
+	}
+
+	/* func must not call back into the tree */
+	pthread_mutex_lock(&self->lock);
+	for (node = self->head; ret == 0 && node != NULL; node = node->next) {
+		ret = func(node->key, node->value, arg __ENV_CARGS);
+	}
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_RBTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %p, %p): %d in %s:%d %s",
+		__FUNCTION__, self, func, arg, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_rbtree_bound(yod_rbtree_t *self, uint64_t key, uint64_t *rkey, int mode __ENV_CPARM)
+*/
+void *_yod_rbtree_bound(yod_rbtree_t *self, uint64_t key, uint64_t *rkey, int mode __ENV_CPARM)
+{
+	yod_rbtree_v *node = NULL;
+	void *value = NULL;
+
+	if (!self || !self->root) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&self->lock);
+	node = _yod_rbtree_search(self, key, mode);
+
+	/* next/prev continue from the node found */
+	self->curr.node = node;
+	if (node) {
+		self->curr.key = node->key;
+		self->curr.stamp = self->stamp;
+		if (rkey) {
+			*rkey = node->key;
+		}
+		value = node->value;
+	}
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_RBTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu, %d): %p in %s:%d %s",
+		__FUNCTION__, self, (ulong) key, mode, value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ int _yod_rbtree_range(yod_rbtree_t *self, uint64_t lo, uint64_t hi, yod_rbtree_fn func, void *arg __ENV_CPARM)
+*/
+int _yod_rbtree_range(yod_rbtree_t *self, uint64_t lo, uint64_t hi, yod_rbtree_fn func, void *arg __ENV_CPARM)
+{
+	yod_rbtree_v *node = NULL;
+	int ret = 0;
+
+	if (!self || !func) {
+		return (-1);
+	}
+
+	/* visits [lo, hi), func must not call back into the tree */
+	pthread_mutex_lock(&self->lock);
+	node = _yod_rbtree_search(self, lo, YOD_RBTREE_LOWER);
+	for (; ret == 0 && node != NULL && node->key < hi; node = node->next) {
+		ret = func(node->key, node->value, arg __ENV_CARGS);
+	}
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_RBTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu, %lu, %p, %p): %d in %s:%d %s",
+		__FUNCTION__, self, (ulong) lo, (ulong) hi, func, arg, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ long _yod_rbtree_rank(yod_rbtree_t *self, uint64_t key __ENV_CPARM)
+*/
+long _yod_rbtree_rank(yod_rbtree_t *self, uint64_t key __ENV_CPARM)
+{
+	yod_rbtree_v *p = NULL;
+	long ret = 0;
+
+	if (!self || !(self->flags & YOD_RBTREE_RANK)) {
+		return (-1);
+	}
+
+	/* number of keys less than key */
+	pthread_mutex_lock(&self->lock);
+	for (p = self->root; p != self->leaf;) {
+		if (p->key < key) {
+			ret += yod_rbtree_ext(p->left)->size + 1;
+			p = p->right;
+		} else {
+			p = p->left;
+		}
+	}
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_RBTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu): %ld in %s:%d %s",
+		__FUNCTION__, self, (ulong) key, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ void *_yod_rbtree_select(yod_rbtree_t *self, ulong index, uint64_t *key __ENV_CPARM)
+*/
+void *_yod_rbtree_select(yod_rbtree_t *self, ulong index, uint64_t *key __ENV_CPARM)
+{
+	yod_rbtree_v *p = NULL;
+	void *value = NULL;
+
+	if (!self || !(self->flags & YOD_RBTREE_RANK)) {
+		return NULL;
+	}
+
+	/* the index-th smallest key, counting from 0 */
+	pthread_mutex_lock(&self->lock);
+	for (p = self->root; p != self->leaf;) {
+		if (index < yod_rbtree_ext(p->left)->size) {
+			p = p->left;
+		} else if (index > yod_rbtree_ext(p->left)->size) {
+			index -= yod_rbtree_ext(p->left)->size + 1;
+			p = p->right;
+		} else {
+			break;
+		}
+	}
+
+	/* next/prev continue from the node found */
+	self->curr.node = (p != self->leaf) ? p : NULL;
+	if (self->curr.node) {
+		self->curr.key = p->key;
+		self->curr.stamp = self->stamp;
+		if (key) {
+			*key = p->key;
+		}
+		value = p->value;
+	}
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_RBTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu): %p in %s:%d %s",
+		__FUNCTION__, self, index, value, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return value;
+}
+/* }}} */
+
+
+/** {{{ int _yod_rbtree_del_interval(yod_rbtree_t *self, uint64_t lo, uint64_t hi __ENV_CPARM)
+*/
+int _yod_rbtree_del_interval(yod_rbtree_t *self, uint64_t lo, uint64_t hi __ENV_CPARM)
+{
+	yod_rbtree_v *node = NULL;
+	int ret = 0;
+
+	if (!self || !self->root) {
+		return (-1);
+	}
+
+	pthread_mutex_lock(&self->lock);
+
+	/* equal starts are adjacent in the list */
+	node = _yod_rbtree_search(self, lo, YOD_RBTREE_LOWER);
+	for (; node && node->key == lo; node = node->next) {
+		/* plain trees hold point intervals */
+		if (((self->flags & YOD_RBTREE_INTERVAL) ? yod_rbtree_ext(node)->high : node->key) == hi) {
+			break;
+		}
+	}
+
+	if (node && node->key == lo) {
+		_yod_rbtree_remove(self, node __ENV_CARGS);
+	} else {
+		ret = -1;
+	}
+
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_RBTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu, %lu): %d in %s:%d %s",
+		__FUNCTION__, self, (ulong) lo, (ulong) hi, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ int _yod_rbtree_overlap(yod_rbtree_t *self, uint64_t lo, uint64_t hi, yod_rbtree_ifn func, void *arg __ENV_CPARM)
+*/
+int _yod_rbtree_overlap(yod_rbtree_t *self, uint64_t lo, uint64_t hi, yod_rbtree_ifn func, void *arg __ENV_CPARM)
+{
+	int ret = 0;
+
+	if (!self || !func || !(self->flags & YOD_RBTREE_INTERVAL)) {
+		return (-1);
+	}
+
+	/* visits [l, h] with l <= hi and h >= lo, func must not call back into the tree */
+	pthread_mutex_lock(&self->lock);
+	ret = _yod_rbtree_overlaps(self, self->root, lo, hi, func, arg __ENV_CARGS);
+	pthread_mutex_unlock(&self->lock);
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_RBTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu, %lu, %p, %p): %d in %s:%d %s",
+		__FUNCTION__, self, (ulong) lo, (ulong) hi, func, arg, ret, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return ret;
+}
+/* }}} */
+
+
+/** {{{ void _yod_rbtree_link(yod_rbtree_r *tree, yod_rbtree_n *node __ENV_CPARM)
+*/
+void _yod_rbtree_link(yod_rbtree_r *tree, yod_rbtree_n *node __ENV_CPARM)
+{
+	yod_rbtree_n **link = &tree->root;
+	yod_rbtree_n *p = NULL;
+	yod_rbtree_n *g = NULL;
+	yod_rbtree_n *u = NULL;
+
+	/* equal keys go right, after the ones already linked */
+	while (*link) {
+		p = *link;
+		link = (node->key < p->key) ? &p->left : &p->right;
+	}
+
+	node->left = NULL;
+	node->right = NULL;
+	node->parent = p;
+	node->color = 1; /* red */
+	*link = node;
+
+	if (!tree->head || node->key < tree->head->key) {
+		tree->head = node;
+	}
+	++ tree->count;
+
+	/* re-balance tree */
+	while ((p = node->parent) != NULL && p->color == 1) {
+		g = p->parent;
+		if (p == g->left) {
+			u = g->right;
+			if (u && u->color == 1) {
+				p->color = 0; /* black */
+				u->color = 0; /* black */
+				g->color = 1; /* red */
+				node = g;
+				continue;
+			}
+			if (node == p->right) {
+				_yod_rbtree_rotl(tree, p);
+				node = p;
+				p = node->parent;
+			}
+			p->color = 0; /* black */
+			g->color = 1; /* red */
+			_yod_rbtree_rotr(tree, g);
+		}
+		else {
+			u = g->left;
+			if (u && u->color == 1) {
+				p->color = 0; /* black */
+				u->color = 0; /* black */
+				g->color = 1; /* red */
+				node = g;
+				continue;
+			}
+			if (node == p->left) {
+				_yod_rbtree_rotr(tree, p);
+				node = p;
+				p = node->parent;
+			}
+			p->color = 0; /* black */
+			g->color = 1; /* red */
+			_yod_rbtree_rotl(tree, g);
+		}
+	}
+	tree->root->color = 0; /* black */
+
+	__ENV_VOID
+}
+/* }}} */
+
+
+/** {{{ void _yod_rbtree_unlink(yod_rbtree_r *tree, yod_rbtree_n *node __ENV_CPARM)
+*/
+void _yod_rbtree_unlink(yod_rbtree_r *tree, yod_rbtree_n *node __ENV_CPARM)
+{
+	yod_rbtree_n *x = NULL;
+	yod_rbtree_n *p = NULL;
+	yod_rbtree_n *t = NULL;
+	yod_rbtree_n *w = NULL;
+	byte color = node->color;
+
+	if (node == tree->head) {
+		tree->head = _yod_rbtree_succ(node __ENV_CARGS);
+	}
+	-- tree->count;
+
+	/* x takes the place of the node spliced out, p is its parent */
+	if (!node->left) {
+		x = node->right;
+		p = node->parent;
+		_yod_rbtree_swap(tree, node, x);
+	}
+	else if (!node->right) {
+		x = node->left;
+		p = node->parent;
+		_yod_rbtree_swap(tree, node, x);
+	}
+	else {
+		for (t = node->right; t->left; t = t->left);
+		color = t->color;
+		x = t->right;
+		if (t->parent == node) {
+			p = t;
+		} else {
+			p = t->parent;
+			_yod_rbtree_swap(tree, t, x);
+			t->right = node->right;
+			t->right->parent = t;
+		}
+		_yod_rbtree_swap(tree, node, t);
+		t->left = node->left;
+		t->left->parent = t;
+		t->color = node->color;
+	}
+
+	if (color) {
+		return;
+	}
+
+	/* a delete fixup */
+	while (x != tree->root && (!x || x->color == 0)) {
+		if (x == p->left) {
+			w = p->right;
+			if (w->color == 1) {
+				w->color = 0; /* black */
+				p->color = 1; /* red */
+				_yod_rbtree_rotl(tree, p);
+				w = p->right;
+			}
+			if ((!w->left || !w->left->color) && (!w->right || !w->right->color)) {
+				w->color = 1; /* red */
+				x = p;
+				p = x->parent;
+			}
+			else {
+				if (!w->right || !w->right->color) {
+					w->left->color = 0; /* black */
+					w->color = 1; /* red */
+					_yod_rbtree_rotr(tree, w);
+					w = p->right;
+				}
+				w->color = p->color;
+				p->color = 0; /* black */
+				w->right->color = 0; /* black */
+				_yod_rbtree_rotl(tree, p);
+				x = tree->root;
+			}
+		}
+		else {
+			w = p->left;
+			if (w->color == 1) {
+				w->color = 0; /* black */
+				p->color = 1; /* red */
+				_yod_rbtree_rotr(tree, p);
+				w = p->left;
+			}
+			if ((!w->left || !w->left->color) && (!w->right || !w->right->color)) {
+				w->color = 1; /* red */
+				x = p;
+				p = x->parent;
+			}
+			else {
+				if (!w->left || !w->left->color) {
+					w->right->color = 0; /* black */
+					w->color = 1; /* red */
+					_yod_rbtree_rotl(tree, w);
+					w = p->left;
+				}
+				w->color = p->color;
+				p->color = 0; /* black */
+				w->left->color = 0; /* black */
+				_yod_rbtree_rotr(tree, p);
+				x = tree->root;
+			}
+		}
+	}
+
+	if (x) {
+		x->color = 0; /* black */
+	}
+}
+/* }}} */
+
+
+/** {{{ yod_rbtree_n *_yod_rbtree_lookup(yod_rbtree_r *tree, uint64_t key __ENV_CPARM)
+*/
+yod_rbtree_n *_yod_rbtree_lookup(yod_rbtree_r *tree, uint64_t key __ENV_CPARM)
+{
+	yod_rbtree_n *node = tree->root;
+
+	while (node && node->key != key) {
+		node = (key < node->key) ? node->left : node->right;
+	}
+
+	__ENV_VOID
+
+	return node;
+}
+/* }}} */
+
+
+/** {{{ yod_rbtree_n *_yod_rbtree_last(yod_rbtree_r *tree __ENV_CPARM)
+*/
+yod_rbtree_n *_yod_rbtree_last(yod_rbtree_r *tree __ENV_CPARM)
+{
+	yod_rbtree_n *node = tree->root;
+
+	while (node && node->right) {
+		node = node->right;
+	}
+
+	__ENV_VOID
+
+	return node;
+}
+/* }}} */
+
+
+/** {{{ yod_rbtree_n *_yod_rbtree_succ(yod_rbtree_n *node __ENV_CPARM)
+*/
+yod_rbtree_n *_yod_rbtree_succ(yod_rbtree_n *node __ENV_CPARM)
+{
+	yod_rbtree_n *p = NULL;
+
+	if (node->right) {
+		for (node = node->right; node->left; node = node->left);
+		return node;
+	}
+	while ((p = node->parent) != NULL && node == p->right) {
+		node = p;
+	}
+
+	__ENV_VOID
+
+	return p;
+}
+/* }}} */
+
+
+/** {{{ yod_rbtree_n *_yod_rbtree_pred(yod_rbtree_n *node __ENV_CPARM)
+*/
+yod_rbtree_n *_yod_rbtree_pred(yod_rbtree_n *node __ENV_CPARM)
+{
+	yod_rbtree_n *p = NULL;
+
+	if (node->left) {
+		for (node = node->left; node->right; node = node->right);
+		return node;
+	}
+	while ((p = node->parent) != NULL && node == p->left) {
+		node = p;
+	}
+
+	__ENV_VOID
+
+	return p;
+}
+/* }}} */
+
+
+/** {{{ static void _yod_rbtree_remove(yod_rbtree_t *self, yod_rbtree_v *node __ENV_CPARM)
+*/
+static void _yod_rbtree_remove(yod_rbtree_t *self, yod_rbtree_v *node __ENV_CPARM)
+{
+	yod_rbtree_v *p, *t, *w;
+	byte color = 0;
+
+	-- self->count;
+	++ self->stamp;
+
+	{
+		if (node == self->head) {
+			self->head = node->next;
+		}
+		if (node == self->tail) {
+			self->tail = node->prev;
+		}
+		if (node->next) {
+			node->next->prev = node->prev;
+		}
+		if (node->prev) {
+			node->prev->next = node->next;
+		}
+		if (self->vfree) {
+			self->vfree(node->value __ENV_CARGS);
+		}
+	}
+
+	if (node->left == self->leaf) {
+		p = node->right;
+		t = node;
+	}
+	else if (node->right == self->leaf) {
+		p = node->left;
+		t = node;
+	} else {
+		t = node->right;
+		while (t->left != self->leaf) {
+			t = t->left;
+		}
+		if (t->left != self->leaf) {
+			p = t->left;
+		} else {
+			p = t->right;
+		}
+	}
+
+	/* t leaves the tree, its ancestors shrink */
+	if (self->flags & YOD_RBTREE_RANK) {
+		for (w = t; w != self->root;) {
+			w = w->parent;
+			-- yod_rbtree_ext(w)->size;
+		}
+	}
+
+	if (t == self->root) {
+		self->root = p;
+		p->color = 0; /* black */
+
+		_yod_rbtree_release(self, node __ENV_CARGS);
+		return;
+	}
+
+	color = t->color;
+
+	if (t == t->parent->left) {
+		t->parent->left = p;
+	} else {
+		t->parent->right = p;
+	}
+
+	if (t == node) {
+		p->parent = t->parent;
+	}
+	else {
+		if (t->parent == node) {
+			p->parent = t;
+		} else {
+			p->parent = t->parent;
+		}
+
+		t->left = node->left;
+		t->right = node->right;
+		t->parent = node->parent;
+		t->color = node->color;
+		if (self->flags & YOD_RBTREE_RANK) {
+			yod_rbtree_ext(t)->size = yod_rbtree_ext(node)->size;
+		}
+
+		if (node == self->root) {
+			self->root = t;
+		}
+		else {
+			if (node == node->parent->left) {
+				node->parent->left = t;
+			} else {
+				node->parent->right = t;
+			}
+		}
+
+		if (t->left != self->leaf) {
+			t->left->parent = t;
+		}
+
+		if (t->right != self->leaf) {
+			t->right->parent = t;
+		}
+	}
+
+	/* max ends above the splice point may have dropped */
+	if (self->flags & YOD_RBTREE_INTERVAL) {
+		for (w = p->parent;; w = w->parent) {
+			yod_rbtree_ext(w)->max = _yod_rbtree_max(w);
+			if (w == self->root) {
+				break;
+			}
+		}
+	}
+
+	_yod_rbtree_release(self, node __ENV_CARGS);
+
+	if (color) {
+		return;
+	}
+
+	/* a delete fixup */
+	while (p != self->root && !p->color) {
+		if (p == p->parent->left) {
+			w = p->parent->right;
+
+			if (w->color) {
+				w->color = 0; /* black */
+				p->parent->color = 1; /* red */
+				yod_rbtree_left_rotate(self, p->parent);
+				w = p->parent->right;
+			}
+
+			if (!w->left->color && !w->right->color) {
+				w->color = 1; /* red */
+				p = p->parent;
+			}
+			else {
+				if (!w->right->color) {
+					w->left->color = 0; /* black */
+					w->color = 1; /* red */
+					yod_rbtree_right_rotate(self, w);
+					w = p->parent->right;
+				}
+				w->color = p->parent->color;
+				p->parent->color = 0; /* black */
+				w->right->color = 0; /* black */
+				yod_rbtree_left_rotate(self, p->parent);
+				p = self->root;
+			}
+
+		} else {
+			w = p->parent->left;
+
+			if (w->color) {
+				w->color = 0; /* black */
+				p->parent->color = 1; /* red */
+				yod_rbtree_right_rotate(self, p->parent);
+				w = p->parent->left;
+			}
+
+			if (!w->left->color && !w->right->color) {
+				w->color = 1; /* red */
+				p = p->parent;
+			}
+			else {
+				if (!w->left->color) {
+					w->right->color = 0; /* black */
+					w->color = 1; /* red */
+					yod_rbtree_left_rotate(self, w);
+					w = p->parent->left;
+				}
+				w->color = p->parent->color;
+				p->parent->color = 0; /* black */
+				w->left->color = 0; /* black */
+				yod_rbtree_right_rotate(self, p->parent);
+				p = self->root;
+			}
+		}
+	}
+
+	if (p != NULL) {
+		p->color = 0; /* black */
+	}
+}
+/* }}} */
+
+
+/** {{{ static uint64_t _yod_rbtree_max(yod_rbtree_v *node)
+*/
+static uint64_t _yod_rbtree_max(yod_rbtree_v *node)
+{
+	uint64_t max = yod_rbtree_ext(node)->high;
+
+	if (max < yod_rbtree_ext(node->left)->max) {
+		max = yod_rbtree_ext(node->left)->max;
+	}
+	if (max < yod_rbtree_ext(node->right)->max) {
+		max = yod_rbtree_ext(node->right)->max;
+	}
+
+	return max;
+}
+/* }}} */
+
+
+/** {{{ static int _yod_rbtree_overlaps(yod_rbtree_t *self, yod_rbtree_v *node, uint64_t lo, uint64_t hi, yod_rbtree_ifn func, void *arg __ENV_CPARM)
+*/
+static int _yod_rbtree_overlaps(yod_rbtree_t *self, yod_rbtree_v *node, uint64_t lo, uint64_t hi, yod_rbtree_ifn func, void *arg __ENV_CPARM)
+{
+	int ret = 0;
+
+	/* nothing below ends at or after lo */
+	if (node == self->leaf || yod_rbtree_ext(node)->max < lo) {
+		return (0);
+	}
+
+	ret = _yod_rbtree_overlaps(self, node->left, lo, hi, func, arg __ENV_CARGS);
+	if (ret != 0) {
+		return ret;
+	}
+
+	/* everything right of a start past hi starts past hi too */
+	if (node->key > hi) {
+		return (0);
+	}
+
+	if (yod_rbtree_ext(node)->high >= lo) {
+		ret = func(node->key, yod_rbtree_ext(node)->high, node->value, arg __ENV_CARGS);
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	return _yod_rbtree_overlaps(self, node->right, lo, hi, func, arg __ENV_CARGS);
+}
+/* }}} */
+
+
+/** {{{ static void _yod_rbtree_left_rotate(yod_rbtree_t *self, yod_rbtree_v *node __ENV_CPARM)
+*/
+static void _yod_rbtree_left_rotate(yod_rbtree_t *self, yod_rbtree_v *node __ENV_CPARM)
+{
+	yod_rbtree_v  *p = NULL;
+
+	if (!self) {
+		return;
+	}
+
+	p = node->right;
+	node->right = p->left;
+	if (p->left != self->leaf) {
+		p->left->parent = node;
+	}
+	p->parent = node->parent;
+	if (node == self->root) {
+		self->root = p;
+	} else if (node == node->parent->left) {
+		node->parent->left = p;
+	} else {
+		node->parent->right = p;
+	}
+	p->left = node;
+	node->parent = p;
+
+	if (self->flags & YOD_RBTREE_RANK) {
+		yod_rbtree_ext(p)->size = yod_rbtree_ext(node)->size;
+		yod_rbtree_ext(node)->size = yod_rbtree_ext(node->left)->size + yod_rbtree_ext(node->right)->size + 1;
+	}
+	if (self->flags & YOD_RBTREE_INTERVAL) {
+		yod_rbtree_ext(p)->max = yod_rbtree_ext(node)->max;
+		yod_rbtree_ext(node)->max = _yod_rbtree_max(node);
+	}
+
+#if (_YOD_SYSTEM_DEBUG && _YOD_RBTREE_DEBUG)
+	yod_stdlog_debug(NULL, "%s(%p, %lu) in %s:%d %s",
+		__FUNCTION__, self, (ulong) (node ? node->key : -1), __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+}
+/* }}} */
+
+
+/** {{{ static void _yod_rbtree_right_rotate(yod_rbtree_t *self, yod_rbtree_v *node __ENV_CPARM)
+*/
+static void _yod_rbtree_right_rotate(yod_rbtree_t *self, yod_rbtree_v *node __ENV_CPARM)
+{
+	yod_rbtree_v  *p = NULL;
+
+	if (!self) {
+		return;
+	}
+
+	p = node->left;
+	node->left = p->right;
+	if (p->right != self->leaf) {
+		p->right->parent = node;
+	}
+	p->parent = node->parent;
+	if (node == self->root) {
+		self->root = p;
 	} else if (node == node->parent->right) {
 		node->parent->right = p;
 	} else {
@@ -747,6 +1572,15 @@ static void _yod_rbtree_right_rotate(yod_rbtree_t *self, yod_rbtree_v *node __EN
 	p->right = node;
 	node->parent = p;
 
+	if (self->flags & YOD_RBTREE_RANK) {
+		yod_rbtree_ext(p)->size = yod_rbtree_ext(node)->size;
+		yod_rbtree_ext(node)->size = yod_rbtree_ext(node->left)->size + yod_rbtree_ext(node->right)->size + 1;
+	}
+	if (self->flags & YOD_RBTREE_INTERVAL) {
+		yod_rbtree_ext(p)->max = yod_rbtree_ext(node)->max;
+		yod_rbtree_ext(node)->max = _yod_rbtree_max(node);
+	}
+
 #if (_YOD_SYSTEM_DEBUG && _YOD_RBTREE_DEBUG)
 	yod_stdlog_debug(NULL, "%s(%p, %lu) in %s:%d %s",
 		__FUNCTION__, self, (ulong) (node ? node->key : -1), __ENV_TRACE);
@@ -757,6 +1591,340 @@ static void _yod_rbtree_right_rotate(yod_rbtree_t *self, yod_rbtree_v *node __EN
 /* }}} */
 
 
+/** {{{ static void *_yod_rbtree_iter(yod_rbtree_i *iter, int forward, uint64_t *key)
+*/
+static void *_yod_rbtree_iter(yod_rbtree_i *iter, int forward, uint64_t *key)
+{
+	yod_rbtree_t *self = iter->tree;
+	yod_rbtree_v *node = NULL;
+	yod_rbtree_v *p = NULL;
+
+	if (!iter->node) {
+		node = forward ? self->head : self->tail;
+	}
+	else if (iter->stamp == self->stamp) {
+		node = (yod_rbtree_v *) iter->node;
+		node = forward ? node->next : node->prev;
+	}
+	else {
+		/* lower bound of the saved key, then look for the node among equal keys */
+		node = _yod_rbtree_search(self, iter->key, YOD_RBTREE_LOWER);
+		p = node;
+		for (; node && node->key == iter->key; node = node->next) {
+			if (node == iter->node) {
+				break;
+			}
+		}
+
+		if (node && node == iter->node) {
+			node = forward ? node->next : node->prev;
+		} else if (forward) {
+			/* deleted, its place among equal keys is unknown, so they
+			 * are walked again rather than skipped */
+			node = p;
+		} else {
+			node = node ? node->prev : self->tail;
+		}
+	}
+
+	iter->node = node;
+	if (!node) {
+		return NULL;
+	}
+
+	iter->key = node->key;
+	iter->stamp = self->stamp;
+	if (key) {
+		*key = node->key;
+	}
+
+	return node->value;
+}
+/* }}} */
+
+
+/** {{{ static yod_rbtree_v *_yod_rbtree_search(yod_rbtree_t *self, uint64_t key, int mode)
+*/
+static yod_rbtree_v *_yod_rbtree_search(yod_rbtree_t *self, uint64_t key, int mode)
+{
+	yod_rbtree_v *node = NULL;
+	yod_rbtree_v *p = NULL;
+	int upper = (mode == YOD_RBTREE_UPPER || mode == YOD_RBTREE_FLOOR);
+
+	/* first node with key >= key (lower), or key > key (upper) */
+	for (p = self->root; p != self->leaf;) {
+		if (p->key < key || (upper && p->key == key)) {
+			p = p->right;
+		} else {
+			node = p;
+			p = p->left;
+		}
+	}
+
+	/* floor is the node before the upper bound */
+	if (mode == YOD_RBTREE_FLOOR) {
+		node = node ? node->prev : self->tail;
+	}
+
+	return node;
+}
+/* }}} */
+
+
+/** {{{ static yod_rbtree_v *_yod_rbtree_alloc(yod_rbtree_t *self __ENV_CPARM)
+*/
+static yod_rbtree_v *_yod_rbtree_alloc(yod_rbtree_t *self __ENV_CPARM)
+{
+	yod_rbtree_p *pool = &self->pool;
+	yod_rbtree_v *node = NULL;
+	ulong n = 0;
+
+	if (self->flags & YOD_RBTREE_SHARED) {
+		pool = _yod_rbtree_cache(__ENV_ARGS);
+		if (!pool) {
+			return NULL;
+		}
+
+		/* refill the thread cache in one batch */
+		if (!pool->free) {
+			pthread_mutex_lock(&yod_rbtree_lock__);
+			for (n = 0; n < YOD_RBTREE_CACHE_SIZE; ++n) {
+				if (!yod_rbtree_pool__.free && _yod_rbtree_grow(&yod_rbtree_pool__, sizeof(yod_rbtree_v) __ENV_CARGS) != 0) {
+					break;
+				}
+				node = yod_rbtree_pool__.free;
+				yod_rbtree_pool__.free = node->next;
+				-- yod_rbtree_pool__.count;
+				node->next = pool->free;
+				pool->free = node;
+				++ pool->count;
+			}
+			pthread_mutex_unlock(&yod_rbtree_lock__);
+		}
+	}
+	else if (!pool->free) {
+		_yod_rbtree_grow(pool, (self->flags & YOD_RBTREE_AUGMENT) ? sizeof(yod_rbtree_x) : sizeof(yod_rbtree_v) __ENV_CARGS);
+	}
+
+	node = pool->free;
+	if (!node) {
+		return NULL;
+	}
+	pool->free = node->next;
+	-- pool->count;
+
+	return node;
+}
+/* }}} */
+
+
+/** {{{ static void _yod_rbtree_release(yod_rbtree_t *self, yod_rbtree_v *node __ENV_CPARM)
+*/
+static void _yod_rbtree_release(yod_rbtree_t *self, yod_rbtree_v *node __ENV_CPARM)
+{
+	yod_rbtree_p *pool = &self->pool;
+	yod_rbtree_v *temp = NULL;
+	ulong n = 0;
+
+	if (self->flags & YOD_RBTREE_SHARED) {
+		pool = _yod_rbtree_cache(__ENV_ARGS);
+		if (!pool) {
+			/* no cache for this thread, hand the node back directly */
+			pthread_mutex_lock(&yod_rbtree_lock__);
+			node->next = yod_rbtree_pool__.free;
+			yod_rbtree_pool__.free = node;
+			++ yod_rbtree_pool__.count;
+			pthread_mutex_unlock(&yod_rbtree_lock__);
+			return;
+		}
+	}
+
+	node->next = pool->free;
+	pool->free = node;
+	++ pool->count;
+
+	/* keep the thread cache bounded, return a batch */
+	if ((self->flags & YOD_RBTREE_SHARED) && pool->count > (YOD_RBTREE_CACHE_SIZE << 1)) {
+		pthread_mutex_lock(&yod_rbtree_lock__);
+		for (n = 0; n < YOD_RBTREE_CACHE_SIZE; ++n) {
+			temp = pool->free;
+			pool->free = temp->next;
+			-- pool->count;
+			temp->next = yod_rbtree_pool__.free;
+			yod_rbtree_pool__.free = temp;
+			++ yod_rbtree_pool__.count;
+		}
+		pthread_mutex_unlock(&yod_rbtree_lock__);
+	}
+}
+/* }}} */
+
+
+/** {{{ static int _yod_rbtree_grow(yod_rbtree_p *pool, ulong stride __ENV_CPARM)
+*/
+static int _yod_rbtree_grow(yod_rbtree_p *pool, ulong stride __ENV_CPARM)
+{
+	yod_rbtree_k *chunk = NULL;
+	yod_rbtree_v *node = NULL;
+	ulong size = 0;
+	ulong i = 0;
+
+	/* chunks double up to YOD_RBTREE_CHUNK_MAX nodes */
+	size = pool->size ? (pool->size << 1) : YOD_RBTREE_CHUNK_MIN;
+	if (size > YOD_RBTREE_CHUNK_MAX) {
+		size = YOD_RBTREE_CHUNK_MAX;
+	}
+
+	/* nodes are stride bytes apart, a pool holds one kind */
+	chunk = (yod_rbtree_k *) malloc(sizeof(yod_rbtree_k) - sizeof(yod_rbtree_v) + size * stride);
+	if (!chunk) {
+		YOD_STDLOG_ERROR("malloc failed");
+		return (-1);
+	}
+
+	chunk->next = pool->chunks;
+	chunk->size = size;
+	pool->chunks = chunk;
+	pool->size = size;
+
+	/* hand out in address order */
+	for (i = size; i > 0; --i) {
+		node = (yod_rbtree_v *) ((char *) chunk->nodes + (i - 1) * stride);
+		node->next = pool->free;
+		pool->free = node;
+	}
+	pool->count += size;
+
+#if (_YOD_SYSTEM_DEBUG && (_YOD_RBTREE_DEBUG & 0x02))
+	yod_stdlog_debug(NULL, "%s(%p): {size=%lu, count=%lu} in %s:%d %s",
+		__FUNCTION__, pool, size, pool->count, __ENV_TRACE);
+#else
+	__ENV_VOID
+#endif
+
+	return (0);
+}
+/* }}} */
+
+
+/** {{{ static yod_rbtree_p *_yod_rbtree_cache(__ENV_PARM)
+*/
+static yod_rbtree_p *_yod_rbtree_cache(__ENV_PARM)
+{
+	yod_rbtree_p *cache = NULL;
+
+	pthread_once(&yod_rbtree_once__, _yod_rbtree_cache_init);
+
+	cache = (yod_rbtree_p *) pthread_getspecific(yod_rbtree_key__);
+	if (!cache) {
+		cache = (yod_rbtree_p *) calloc(1, sizeof(yod_rbtree_p));
+		if (!cache) {
+			YOD_STDLOG_ERROR("calloc failed");
+			return NULL;
+		}
+		if (pthread_setspecific(yod_rbtree_key__, cache) != 0) {
+			free(cache);
+
+			YOD_STDLOG_ERROR("pthread_setspecific failed");
+			return NULL;
+		}
+	}
+
+	__ENV_VOID
+
+	return cache;
+}
+/* }}} */
+
+
+/** {{{ static void _yod_rbtree_cache_init(void)
+*/
+static void _yod_rbtree_cache_init(void)
+{
+	pthread_key_create(&yod_rbtree_key__, _yod_rbtree_cache_free);
+}
+/* }}} */
+
+
+/** {{{ static void _yod_rbtree_cache_free(void *arg)
+*/
+static void _yod_rbtree_cache_free(void *arg)
+{
+	yod_rbtree_p *cache = (yod_rbtree_p *) arg;
+	yod_rbtree_v *node = NULL;
+
+	if (!cache) {
+		return;
+	}
+
+	/* a dying thread gives its nodes back to the shared pool */
+	pthread_mutex_lock(&yod_rbtree_lock__);
+	while ((node = cache->free) != NULL) {
+		cache->free = node->next;
+		node->next = yod_rbtree_pool__.free;
+		yod_rbtree_pool__.free = node;
+		++ yod_rbtree_pool__.count;
+	}
+	pthread_mutex_unlock(&yod_rbtree_lock__);
+
+	free(cache);
+}
+/* }}} */
+
+
+/** {{{ static void _yod_rbtree_rotl(yod_rbtree_r *tree, yod_rbtree_n *node)
+*/
+static void _yod_rbtree_rotl(yod_rbtree_r *tree, yod_rbtree_n *node)
+{
+	yod_rbtree_n *p = node->right;
+
+	node->right = p->left;
+	if (p->left) {
+		p->left->parent = node;
+	}
+	_yod_rbtree_swap(tree, node, p);
+	p->left = node;
+	node->parent = p;
+}
+/* }}} */
+
+
+/** {{{ static void _yod_rbtree_rotr(yod_rbtree_r *tree, yod_rbtree_n *node)
+*/
+static void _yod_rbtree_rotr(yod_rbtree_r *tree, yod_rbtree_n *node)
+{
+	yod_rbtree_n *p = node->left;
+
+	node->left = p->right;
+	if (p->right) {
+		p->right->parent = node;
+	}
+	_yod_rbtree_swap(tree, node, p);
+	p->right = node;
+	node->parent = p;
+}
+/* }}} */
+
+
+/** {{{ static void _yod_rbtree_swap(yod_rbtree_r *tree, yod_rbtree_n *node, yod_rbtree_n *repl)
+*/
+static void _yod_rbtree_swap(yod_rbtree_r *tree, yod_rbtree_n *node, yod_rbtree_n *repl)
+{
+	/* repl takes node's place under its parent */
+	if (!node->parent) {
+		tree->root = repl;
+	} else if (node == node->parent->left) {
+		node->parent->left = repl;
+	} else {
+		node->parent->right = repl;
+	}
+	if (repl) {
+		repl->parent = node->parent;
+	}
+}
+/* }}} */
+
+
 /** {{{ static void _yod_rbtree_print(yod_rbtree_v *node, int n)
 */
 static void _yod_rbtree_print(yod_rbtree_v *node, int n)
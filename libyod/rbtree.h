@@ -4,11 +4,60 @@
 #include "system.h"
 
 
+#define YOD_RBTREE_LOWER 										0
+#define YOD_RBTREE_UPPER 										1
+#define YOD_RBTREE_FLOOR 										2
+#define YOD_RBTREE_CEIL 										3
+
+#define YOD_RBTREE_SHARED 										0x01
+#define YOD_RBTREE_RANK 										0x02
+#define YOD_RBTREE_INTERVAL 									0x04
+
+
 /* yod_rbtree_t */
 typedef struct _yod_rbtree_t 									yod_rbtree_t;
 
+/* yod_rbtree_i */
+typedef struct _yod_rbtree_i
+{
+	yod_rbtree_t *tree;
+	void *node;
+	uint64_t key;
+	ulong stamp;
+} yod_rbtree_i;
+
+/* yod_rbtree_n, embedded in the caller's own objects */
+typedef struct _yod_rbtree_n
+{
+	uint64_t key;
+
+	struct _yod_rbtree_n *left;
+	struct _yod_rbtree_n *right;
+	struct _yod_rbtree_n *parent;
+
+	byte color;
+} yod_rbtree_n;
+
+/* yod_rbtree_r, the root of an intrusive tree, never locked */
+typedef struct _yod_rbtree_r
+{
+	yod_rbtree_n *root;
+	yod_rbtree_n *head;
+	ulong count;
+} yod_rbtree_r;
+
+/* yod_rbtree_fn */
+typedef int (*yod_rbtree_fn) (uint64_t key, void *value, void *arg __ENV_CPARM);
+
+/* yod_rbtree_ifn */
+typedef int (*yod_rbtree_ifn) (uint64_t lo, uint64_t hi, void *value, void *arg __ENV_CPARM);
+
 
 #define yod_rbtree_new(f) 										_yod_rbtree_new(f __ENV_CARGS)
+#define yod_rbtree_new_ex(f, o) 								_yod_rbtree_new_ex(f, o __ENV_CARGS)
+#define yod_rbtree_new_shared(f) 								_yod_rbtree_new_ex(f, YOD_RBTREE_SHARED __ENV_CARGS)
+#define yod_rbtree_new_rank(f) 									_yod_rbtree_new_ex(f, YOD_RBTREE_RANK __ENV_CARGS)
+#define yod_rbtree_new_interval(f) 								_yod_rbtree_new_ex(f, YOD_RBTREE_INTERVAL __ENV_CARGS)
 #define yod_rbtree_free(x) 										_yod_rbtree_free(x __ENV_CARGS)
 
 #define yod_rbtree_add(x, k, v, f) 								_yod_rbtree_add(x, k, v, f __ENV_CARGS)
@@ -22,8 +71,39 @@ typedef struct _yod_rbtree_t 									yod_rbtree_t;
 #define yod_rbtree_next(x, k) 									_yod_rbtree_next(x, k __ENV_CARGS)
 #define yod_rbtree_prev(x, k) 									_yod_rbtree_prev(x, k __ENV_CARGS)
 
+#define yod_rbtree_iter_head(x, t, k) 							_yod_rbtree_iter_head(x, t, k __ENV_CARGS)
+#define yod_rbtree_iter_tail(x, t, k) 							_yod_rbtree_iter_tail(x, t, k __ENV_CARGS)
+#define yod_rbtree_iter_next(t, k) 								_yod_rbtree_iter_next(t, k __ENV_CARGS)
+#define yod_rbtree_iter_prev(t, k) 								_yod_rbtree_iter_prev(t, k __ENV_CARGS)
+#define yod_rbtree_visit(x, f, a) 								_yod_rbtree_visit(x, f, a __ENV_CARGS)
+
+#define yod_rbtree_lower_bound(x, k, r) 						_yod_rbtree_bound(x, k, r, YOD_RBTREE_LOWER __ENV_CARGS)
+#define yod_rbtree_upper_bound(x, k, r) 						_yod_rbtree_bound(x, k, r, YOD_RBTREE_UPPER __ENV_CARGS)
+#define yod_rbtree_floor(x, k, r) 								_yod_rbtree_bound(x, k, r, YOD_RBTREE_FLOOR __ENV_CARGS)
+#define yod_rbtree_ceil(x, k, r) 								_yod_rbtree_bound(x, k, r, YOD_RBTREE_CEIL __ENV_CARGS)
+#define yod_rbtree_range(x, l, h, f, a) 						_yod_rbtree_range(x, l, h, f, a __ENV_CARGS)
+
+#define yod_rbtree_rank(x, k) 									_yod_rbtree_rank(x, k __ENV_CARGS)
+#define yod_rbtree_select(x, i, k) 								_yod_rbtree_select(x, i, k __ENV_CARGS)
+
+#define yod_rbtree_add_interval(x, l, h, v) 					_yod_rbtree_add_interval(x, l, h, v, 0 __ENV_CARGS)
+#define yod_rbtree_del_interval(x, l, h) 						_yod_rbtree_del_interval(x, l, h __ENV_CARGS)
+#define yod_rbtree_stab(x, p, f, a) 							_yod_rbtree_overlap(x, p, p, f, a __ENV_CARGS)
+#define yod_rbtree_overlap(x, l, h, f, a) 						_yod_rbtree_overlap(x, l, h, f, a __ENV_CARGS)
+
+#define YOD_RBTREE_R_INIT 										{NULL, NULL, 0}
+#define yod_rbtree_entry(n, t, m) 								((t *) ((char *) (n) - offsetof(t, m)))
+#define yod_rbtree_link(r, n) 									_yod_rbtree_link(r, n __ENV_CARGS)
+#define yod_rbtree_unlink(r, n) 								_yod_rbtree_unlink(r, n __ENV_CARGS)
+#define yod_rbtree_lookup(r, k) 								_yod_rbtree_lookup(r, k __ENV_CARGS)
+#define yod_rbtree_first(r) 									((r)->head)
+#define yod_rbtree_last(r) 										_yod_rbtree_last(r __ENV_CARGS)
+#define yod_rbtree_succ(n) 										_yod_rbtree_succ(n __ENV_CARGS)
+#define yod_rbtree_pred(n) 										_yod_rbtree_pred(n __ENV_CARGS)
+
 
 yod_rbtree_t *_yod_rbtree_new(void (*vfree) (void * __ENV_CPARM) __ENV_CPARM);
+yod_rbtree_t *_yod_rbtree_new_ex(void (*vfree) (void * __ENV_CPARM), int flags __ENV_CPARM);
 void _yod_rbtree_free(yod_rbtree_t *self __ENV_CPARM);
 
 int _yod_rbtree_add(yod_rbtree_t *self, uint64_t key, void *value, int force __ENV_CPARM);
@@ -36,6 +116,29 @@ void *_yod_rbtree_tail(yod_rbtree_t *self, uint64_t *key __ENV_CPARM);
 void *_yod_rbtree_next(yod_rbtree_t *self, uint64_t *key __ENV_CPARM);
 void *_yod_rbtree_prev(yod_rbtree_t *self, uint64_t *key __ENV_CPARM);
 
+void *_yod_rbtree_iter_head(yod_rbtree_t *self, yod_rbtree_i *iter, uint64_t *key __ENV_CPARM);
+void *_yod_rbtree_iter_tail(yod_rbtree_t *self, yod_rbtree_i *iter, uint64_t *key __ENV_CPARM);
+void *_yod_rbtree_iter_next(yod_rbtree_i *iter, uint64_t *key __ENV_CPARM);
+void *_yod_rbtree_iter_prev(yod_rbtree_i *iter, uint64_t *key __ENV_CPARM);
+int _yod_rbtree_visit(yod_rbtree_t *self, yod_rbtree_fn func, void *arg __ENV_CPARM);
+
+void *_yod_rbtree_bound(yod_rbtree_t *self, uint64_t key, uint64_t *rkey, int mode __ENV_CPARM);
+int _yod_rbtree_range(yod_rbtree_t *self, uint64_t lo, uint64_t hi, yod_rbtree_fn func, void *arg __ENV_CPARM);
+
+long _yod_rbtree_rank(yod_rbtree_t *self, uint64_t key __ENV_CPARM);
+void *_yod_rbtree_select(yod_rbtree_t *self, ulong index, uint64_t *key __ENV_CPARM);
+
+int _yod_rbtree_add_interval(yod_rbtree_t *self, uint64_t key, uint64_t high, void *value, int force __ENV_CPARM);
+int _yod_rbtree_del_interval(yod_rbtree_t *self, uint64_t lo, uint64_t hi __ENV_CPARM);
+int _yod_rbtree_overlap(yod_rbtree_t *self, uint64_t lo, uint64_t hi, yod_rbtree_ifn func, void *arg __ENV_CPARM);
+
+void _yod_rbtree_link(yod_rbtree_r *tree, yod_rbtree_n *node __ENV_CPARM);
+void _yod_rbtree_unlink(yod_rbtree_r *tree, yod_rbtree_n *node __ENV_CPARM);
+yod_rbtree_n *_yod_rbtree_lookup(yod_rbtree_r *tree, uint64_t key __ENV_CPARM);
+yod_rbtree_n *_yod_rbtree_last(yod_rbtree_r *tree __ENV_CPARM);
+yod_rbtree_n *_yod_rbtree_succ(yod_rbtree_n *node __ENV_CPARM);
+yod_rbtree_n *_yod_rbtree_pred(yod_rbtree_n *node __ENV_CPARM);
+
 void yod_rbtree_print(yod_rbtree_t *self);
 
 #endif
@@ -131,6 +131,27 @@ typedef struct {char *ptr; size_t len;} 						yod_string_t;
 #define __ENV_ERRNO 											YOD_SYSTEM_ENV_ERRNO
 
 
+/* atomic */
+#define YOD_SYSTEM_ATOMIC_LOAD(p) 								__atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define YOD_SYSTEM_ATOMIC_STORE(p, v) 							__atomic_store_n(p, v, __ATOMIC_RELEASE)
+#define YOD_SYSTEM_ATOMIC_SET(p, v) 							__atomic_store_n(p, v, __ATOMIC_SEQ_CST)
+#define YOD_SYSTEM_ATOMIC_ADD(p, v) 							__atomic_add_fetch(p, v, __ATOMIC_SEQ_CST)
+#define YOD_SYSTEM_ATOMIC_FENCE() 								__atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#define __ATM_LOAD(p) 											YOD_SYSTEM_ATOMIC_LOAD(p)
+#define __ATM_STORE(p, v) 										YOD_SYSTEM_ATOMIC_STORE(p, v)
+#define __ATM_SET(p, v) 										YOD_SYSTEM_ATOMIC_SET(p, v)
+#define __ATM_ADD(p, v) 										YOD_SYSTEM_ATOMIC_ADD(p, v)
+#define __ATM_FENCE() 											YOD_SYSTEM_ATOMIC_FENCE()
+
+/* prefetch */
+#if defined(__GNUC__)
+#define YOD_SYSTEM_PREFETCH(p) 									__builtin_prefetch(p, 0, 3)
+#else
+#define YOD_SYSTEM_PREFETCH(p) 									((void) (p))
+#endif
+
+
 #if (_YOD_SYSTEM_DEBUG)
 #if (_YOD_SYSTEM_IGNORE & 0xFF)
 #define malloc(z) 												_yod_system_malloc(z __ENV_CARGS)